@@ -0,0 +1,33 @@
+'''
+Builds the C++ engine (tlbcore) used by tlb.py:
+
+    python3 setup.py build_ext --inplace
+
+The engine shares the PRINCE index function with the gem5 TLB. It uses
+an installed pybind11 package if there is one and the (older) pybind11
+copy shipped with gem5 otherwise, which supports Python up to 3.9.
+'''
+
+import os
+
+from setuptools import setup, Extension
+
+here = os.path.dirname(os.path.abspath(__file__))
+gem5 = os.path.join(os.path.dirname(here), 'tlbsec_gem5')
+
+try:
+    import pybind11
+    pybind11_include = pybind11.get_include()
+except ImportError:
+    pybind11_include = os.path.join(gem5, 'ext', 'pybind11', 'include')
+
+tlbcore = Extension(
+    'tlbcore',
+    sources=['tlbcore.cc',
+             os.path.join(gem5, 'src', 'arch', 'riscv', 'prince.cc')],
+    include_dirs=[pybind11_include, os.path.join(gem5, 'src')],
+    extra_compile_args=['-std=c++14', '-O3', '-fvisibility=hidden'],
+    extra_link_args=['-pthread'],
+    language='c++')
+
+setup(name='tlbcore', version='1.0', ext_modules=[tlbcore])
@@ -18,6 +18,14 @@ from datetime import datetime
 import matplotlib.pyplot as plt
 import multiprocessing
 
+# Optional C++ engine with the PRINCE index of the gem5 TLB, build it with
+# `python3 setup.py build_ext --inplace`. The attack drivers below use it
+# if it is available and fall back to the Python model otherwise.
+try:
+    import tlbcore
+except ImportError:
+    tlbcore = None
+
 '''
 A CacheEntry stores the address and data used for the replacement policy. 
 '''
@@ -308,18 +316,21 @@ def boxplot_eviction():
     for replacement_policy in ["RPLRU", "LRU", "RAND"]:
         c = Cache(4, 4, replacement_policy=replacement_policy)
         lst = []
-        with progressbar.ProgressBar(max_value=max_val) as bar:
-            for x in range(max_val):
-                ctr = 0
-                target = uuid.uuid4().int & (1<<64)-1
-                c.insert(target)
-                victim = c.invld_entry
-
-                while(victim.address != target):
-                    victim = c.insert(uuid.uuid4().int & (1<<64)-1)
-                    ctr += 1
-                lst.append(ctr)
-                bar.update(x)
+        if tlbcore:
+            lst = tlbcore.eviction_trials(c.ways, c.idx_width, replacement_policy, max_val)
+        else:
+            with progressbar.ProgressBar(max_value=max_val) as bar:
+                for x in range(max_val):
+                    ctr = 0
+                    target = uuid.uuid4().int & (1<<64)-1
+                    c.insert(target)
+                    victim = c.invld_entry
+
+                    while(victim.address != target):
+                        victim = c.insert(uuid.uuid4().int & (1<<64)-1)
+                        ctr += 1
+                    lst.append(ctr)
+                    bar.update(x)
         print(f"Result: {sum(lst) / len(lst) }")
         print(f"Min: {min(lst)}")
         result.append(lst)
@@ -345,44 +356,48 @@ def prime_and_prune_once(configs, iterations = 10000):
 
     for name, c in configs.items():
         config_result = [{"success": 0, "fail": 0, "misses": 0}  for _ in range(c.ways*2**(c.idx_width))]
-        with progressbar.ProgressBar(max_value=c.ways*2**c.idx_width) as bar:
-            for set_size in range(c.ways*2**c.idx_width):
-                for _ in range(iterations):
-                    target = uuid.uuid4().int & (1<<64)-1
-                    attacker_adrs = []
-                    misses = 0
-                    for y in range(set_size):
-                        addr = uuid.uuid4().int & (1<<64)-1
-                        attacker_adrs.append(addr)
-                        c.insert(addr)
-                        misses += 1
+        if tlbcore:
+            r = tlbcore.prime_and_prune_once(c.ways, c.idx_width, c.replacement_policy, iterations)
+            config_result = [{"success": s, "fail": f, "misses": m} for s, f, m in zip(r["success"], r["fail"], r["misses"])]
+        else:
+            with progressbar.ProgressBar(max_value=c.ways*2**c.idx_width) as bar:
+                for set_size in range(c.ways*2**c.idx_width):
+                    for _ in range(iterations):
+                        target = uuid.uuid4().int & (1<<64)-1
+                        attacker_adrs = []
+                        misses = 0
+                        for y in range(set_size):
+                            addr = uuid.uuid4().int & (1<<64)-1
+                            attacker_adrs.append(addr)
+                            c.insert(addr)
+                            misses += 1
                     
-                    fail_cnt = 0
-                    while True:
-                        conflicts = access_and_count_misses(c, attacker_adrs)
-                        if len(conflicts) == 0:
-                            break
-                        misses += len(conflicts)
-                        fail_cnt += 1
-                        if fail_cnt > 3:
-                            if len(conflicts) > 10:
-                                attacker_adrs.remove(conflicts[0])
-                                attacker_adrs.remove(conflicts[1])
-                                attacker_adrs.remove(conflicts[2])
-                                attacker_adrs.remove(conflicts[3])
-                                attacker_adrs.remove(conflicts[4])
-                                attacker_adrs.remove(conflicts[5])
-                            #print(f"Failed Attack! Cannot Prune! {len(conflicts)},{set_size}")
-                            else:
-                                attacker_adrs.remove(conflicts[0])
-
-                    config_result[set_size]["misses"] += misses       
-                    if c.would_evict_attacker_address(attacker_adrs, target):
-                        config_result[set_size]["success"] += 1
-                    else:
-                        config_result[set_size]["fail"] += 1
-                bar.update(set_size)
-            #print(lst)
+                        fail_cnt = 0
+                        while True:
+                            conflicts = access_and_count_misses(c, attacker_adrs)
+                            if len(conflicts) == 0:
+                                break
+                            misses += len(conflicts)
+                            fail_cnt += 1
+                            if fail_cnt > 3:
+                                if len(conflicts) > 10:
+                                    attacker_adrs.remove(conflicts[0])
+                                    attacker_adrs.remove(conflicts[1])
+                                    attacker_adrs.remove(conflicts[2])
+                                    attacker_adrs.remove(conflicts[3])
+                                    attacker_adrs.remove(conflicts[4])
+                                    attacker_adrs.remove(conflicts[5])
+                                #print(f"Failed Attack! Cannot Prune! {len(conflicts)},{set_size}")
+                                else:
+                                    attacker_adrs.remove(conflicts[0])
+
+                        config_result[set_size]["misses"] += misses       
+                        if c.would_evict_attacker_address(attacker_adrs, target):
+                            config_result[set_size]["success"] += 1
+                        else:
+                            config_result[set_size]["fail"] += 1
+                    bar.update(set_size)
+                #print(lst)
         avgs = []
         misses = []
         for e in config_result:
@@ -558,8 +573,11 @@ lower_limit = 10
 for name, c in configs.items():
     res = [float("nan")]*lower_limit
     success_res = [0]*lower_limit
-    pool = multiprocessing.Pool(16)
-    misses, success_rate = list(zip(*pool.map(ppp_wrapper, range(lower_limit, c.ways * c.lines))))
+    if tlbcore:
+        misses, success_rate = list(zip(*[tlbcore.prime_prune_probe_profiling(c.ways, c.idx_width, c.replacement_policy, iterations=4000, set_size=set_size) for set_size in range(lower_limit, c.ways * c.lines)]))
+    else:
+        pool = multiprocessing.Pool(16)
+        misses, success_rate = list(zip(*pool.map(ppp_wrapper, range(lower_limit, c.ways * c.lines))))
     #print(misses)
     for l in misses:
         res.append(min(filter(lambda x: x != float("nan"), l), default=float("nan")))
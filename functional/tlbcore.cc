@@ -0,0 +1,630 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * C++ engine for the functional eviction-set analysis in tlb.py. It
+ * models the same randomized cache/TLB (RAND, LRU and RPLRU replacement)
+ * but derives the per-way indices with the PRINCE cipher of the gem5 TLB
+ * (tlbsec_gem5/src/arch/riscv/prince.hh) instead of SHA-1, and runs the
+ * attack drivers of tlb.py on a pool of host threads. Every thread owns a
+ * private cache, so independent trials never share state.
+ *
+ * Build with `python3 setup.py build_ext --inplace`.
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "arch/riscv/prince.hh"
+
+namespace py = pybind11;
+
+namespace
+{
+
+enum class Policy { Rand, Lru, Rplru };
+
+Policy
+parsePolicy(const std::string &name)
+{
+    if (name == "RAND")
+        return Policy::Rand;
+    if (name == "LRU")
+        return Policy::Lru;
+    if (name == "RPLRU")
+        return Policy::Rplru;
+    throw std::invalid_argument("Invalid replacement policy: " + name);
+}
+
+struct CacheEntry
+{
+    bool valid = false;
+    uint64_t address = 0;
+    // LRU: time of the last access, RPLRU: age (0 is most recent)
+    uint64_t replacementInfo = 0;
+
+    bool
+    operator==(const CacheEntry &other) const
+    {
+        return valid == other.valid && address == other.address &&
+            replacementInfo == other.replacementInfo;
+    }
+};
+
+class Cache
+{
+  public:
+    static const unsigned MaxWays = 64;
+
+    Cache(unsigned ways, unsigned idx_width, const std::string &policy,
+          uint64_t seed)
+        : _ways(ways), _idxWidth(idx_width),
+          _lines(numLines(ways, idx_width)), policyName(policy),
+          policy(parsePolicy(policy)), rng(seed), key(rng()), clock(0),
+          storage(_lines * ways)
+    {
+    }
+
+    unsigned ways() const { return _ways; }
+    unsigned idxWidth() const { return _idxWidth; }
+    uint64_t lines() const { return _lines; }
+    uint64_t entries() const { return _lines * _ways; }
+    const std::string &policyString() const { return policyName; }
+    uint64_t random() { return rng(); }
+
+    void
+    getIndex(uint64_t address, uint64_t *indices) const
+    {
+        RiscvISA::Prince::wayIndices(address, key, _ways, _idxWidth,
+                                     indices);
+    }
+
+    /**
+     * Access an address and insert it on a miss.
+     *
+     * @param victim Receives the replaced entry on a miss
+     * @return true on a hit
+     */
+    bool
+    insert(uint64_t address, CacheEntry *victim)
+    {
+        uint64_t indices[MaxWays];
+        getIndex(address, indices);
+
+        int hit_way = findHit(indices, address);
+        if (hit_way >= 0) {
+            touch(indices[hit_way], hit_way);
+            return true;
+        }
+
+        unsigned way = selectVictim(indices);
+        CacheEntry &entry = at(indices[way], way);
+        *victim = entry;
+        if (policy == Policy::Rplru)
+            updatePlru(indices[way], way);
+        entry.valid = true;
+        entry.address = address;
+        entry.replacementInfo = policy == Policy::Lru ? ++clock : 0;
+        return false;
+    }
+
+    /**
+     * Returns true if accessing address would evict one of the attacker
+     * addresses, without accessing it. This is not possible with a real
+     * cache/TLB.
+     */
+    template <typename Set>
+    bool
+    wouldEvict(const Set &attacker_addresses, uint64_t address)
+    {
+        uint64_t indices[MaxWays];
+        getIndex(address, indices);
+        if (findHit(indices, address) >= 0)
+            return false;
+        unsigned way = selectVictim(indices);
+        const CacheEntry &victim = at(indices[way], way);
+        return victim.valid &&
+            attacker_addresses.count(victim.address) != 0;
+    }
+
+    /**
+     * Returns true if the eviction set covers the index of the target in
+     * every way, each way with a different address. Addresses are
+     * matched greedily in order like in tlb.py.
+     */
+    bool
+    checkEvictionSet(uint64_t target, const std::vector<uint64_t> &set)
+    {
+        uint64_t victim[MaxWays];
+        getIndex(target, victim);
+        std::vector<bool> covered(_ways, false), used(set.size(), false);
+        std::vector<uint64_t> candidates(set.size() * _ways);
+        for (size_t n = 0; n < set.size(); n++)
+            getIndex(set[n], &candidates[n * _ways]);
+
+        for (unsigned found = 0; found < _ways; found++) {
+            bool match = false;
+            for (size_t n = 0; n < set.size() && !match; n++) {
+                if (used[n])
+                    continue;
+                for (unsigned i = 0; i < _ways; i++) {
+                    if (!covered[i] && victim[i] == candidates[n * _ways + i]) {
+                        covered[i] = used[n] = match = true;
+                        break;
+                    }
+                }
+            }
+            if (!match)
+                return false;
+        }
+        return true;
+    }
+
+  private:
+    static uint64_t
+    numLines(unsigned ways, unsigned idx_width)
+    {
+        if (ways == 0 || ways > MaxWays)
+            throw std::invalid_argument("ways must be 1 to 64");
+        if (idx_width > 24)
+            throw std::invalid_argument("idx_width must be at most 24");
+        return UINT64_C(1) << idx_width;
+    }
+
+    CacheEntry &at(uint64_t index, unsigned way)
+    {
+        return storage[index * _ways + way];
+    }
+
+    int
+    findHit(const uint64_t *indices, uint64_t address)
+    {
+        for (unsigned i = 0; i < _ways; i++) {
+            const CacheEntry &entry = at(indices[i], i);
+            if (entry.valid && entry.address == address)
+                return i;
+        }
+        return -1;
+    }
+
+    void
+    touch(uint64_t index, unsigned way)
+    {
+        if (policy == Policy::Lru)
+            at(index, way).replacementInfo = ++clock;
+        else if (policy == Policy::Rplru)
+            updatePlru(index, way);
+    }
+
+    unsigned
+    selectVictim(const uint64_t *indices)
+    {
+        switch (policy) {
+          case Policy::Rand:
+            return std::uniform_int_distribution<unsigned>(0, _ways - 1)(rng);
+          case Policy::Lru: {
+            // Oldest entry, the first one on ties
+            unsigned way = 0;
+            for (unsigned i = 1; i < _ways; i++) {
+                if (at(indices[i], i).replacementInfo <
+                    at(indices[way], way).replacementInfo)
+                    way = i;
+            }
+            return way;
+          }
+          case Policy::Rplru:
+          default: {
+            // A random one of the oldest entries
+            unsigned oldest[MaxWays];
+            unsigned num_oldest = 0;
+            uint64_t max_age = 0;
+            for (unsigned i = 0; i < _ways; i++) {
+                uint64_t age = at(indices[i], i).replacementInfo;
+                if (num_oldest == 0 || age > max_age) {
+                    max_age = age;
+                    num_oldest = 0;
+                }
+                if (age == max_age)
+                    oldest[num_oldest++] = i;
+            }
+            return oldest[std::uniform_int_distribution<unsigned>(
+                    0, num_oldest - 1)(rng)];
+          }
+        }
+    }
+
+    void
+    updatePlru(uint64_t index, unsigned accessed_way)
+    {
+        uint64_t lru_state = at(index, accessed_way).replacementInfo;
+        for (unsigned way = 0; way < _ways; way++) {
+            if (at(index, way).replacementInfo <= lru_state)
+                at(index, way).replacementInfo++;
+        }
+        at(index, accessed_way).replacementInfo = 0;
+    }
+
+    unsigned _ways;
+    unsigned _idxWidth;
+    uint64_t _lines;
+    std::string policyName;
+    Policy policy;
+    std::mt19937_64 rng;
+    uint64_t key;
+    uint64_t clock;
+    std::vector<CacheEntry> storage;
+};
+
+const unsigned Cache::MaxWays;
+
+uint64_t
+seedFrom(const py::object &seed)
+{
+    if (seed.is_none())
+        return (uint64_t(std::random_device()()) << 32) ^
+            std::random_device()();
+    return seed.cast<uint64_t>();
+}
+
+/**
+ * Run work(cache, item) for item in [0, num_items) on a pool of threads.
+ * Every thread owns a cache created from its own seed.
+ */
+void
+parallelFor(unsigned ways, unsigned idx_width, const std::string &policy,
+            uint64_t seed, unsigned threads, size_t num_items,
+            const std::function<void(Cache &, size_t)> &work)
+{
+    if (threads == 0)
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min<size_t>(threads, num_items));
+    // Throws for bad parameters before any thread is started
+    Cache check(ways, idx_width, policy, seed);
+
+    std::atomic<size_t> next_item(0);
+    auto worker = [&](unsigned id) {
+        Cache cache(ways, idx_width, policy,
+                    seed + id * UINT64_C(0x9e3779b97f4a7c15));
+        size_t item;
+        while ((item = next_item++) < num_items)
+            work(cache, item);
+    };
+
+    py::gil_scoped_release release;
+    std::vector<std::thread> pool;
+    for (unsigned id = 1; id < threads; id++)
+        pool.emplace_back(worker, id);
+    worker(0);
+    for (auto &t : pool)
+        t.join();
+}
+
+/** Returns the addresses that missed when accessing all of them. */
+std::vector<uint64_t>
+accessAndCountMisses(Cache &c, const std::vector<uint64_t> &addresses)
+{
+    std::vector<uint64_t> conflicts;
+    CacheEntry victim;
+    for (uint64_t addr : addresses) {
+        if (!c.insert(addr, &victim))
+            conflicts.push_back(addr);
+    }
+    return conflicts;
+}
+
+void
+removeFirst(std::vector<uint64_t> &addresses, uint64_t addr)
+{
+    auto it = std::find(addresses.begin(), addresses.end(), addr);
+    if (it != addresses.end())
+        addresses.erase(it);
+}
+
+/**
+ * Prune step: re-access the prime set until it fits in the cache. After
+ * more than three failed rounds, conflicting addresses are dropped to
+ * speed up the attack.
+ */
+void
+prune(Cache &c, std::vector<uint64_t> &attacker, uint64_t &misses)
+{
+    unsigned fail_cnt = 0;
+    while (true) {
+        std::vector<uint64_t> conflicts = accessAndCountMisses(c, attacker);
+        if (conflicts.empty())
+            break;
+        misses += conflicts.size();
+        fail_cnt++;
+        if (fail_cnt > 3) {
+            size_t num_remove = conflicts.size() > 10 ? 6 : 1;
+            for (size_t i = 0; i < num_remove; i++)
+                removeFirst(attacker, conflicts[i]);
+        }
+    }
+}
+
+/** Number of random accesses until a freshly inserted target is evicted. */
+std::vector<uint64_t>
+evictionTrials(unsigned ways, unsigned idx_width, const std::string &policy,
+               size_t trials, unsigned threads, const py::object &seed)
+{
+    std::vector<uint64_t> result(trials);
+    parallelFor(ways, idx_width, policy, seedFrom(seed), threads, trials,
+        [&](Cache &c, size_t trial) {
+            CacheEntry victim;
+            uint64_t target = c.random();
+            c.insert(target, &victim);
+            uint64_t ctr = 0;
+            victim = CacheEntry();
+            while (!(victim.valid && victim.address == target)) {
+                if (c.insert(c.random(), &victim))
+                    victim = CacheEntry();
+                ctr++;
+            }
+            result[trial] = ctr;
+        });
+    return result;
+}
+
+/**
+ * One prime+prune step per iteration for every initial prime set size,
+ * then check if the target would evict one of the pruned addresses.
+ */
+py::dict
+primeAndPruneOnce(unsigned ways, unsigned idx_width,
+                  const std::string &policy, size_t iterations,
+                  unsigned threads, const py::object &seed)
+{
+    const size_t entries = size_t(ways) << idx_width;
+    std::vector<uint64_t> success(entries), fail(entries), misses(entries);
+    parallelFor(ways, idx_width, policy, seedFrom(seed), threads, entries,
+        [&](Cache &c, size_t set_size) {
+            CacheEntry victim;
+            for (size_t it = 0; it < iterations; it++) {
+                uint64_t target = c.random();
+                std::vector<uint64_t> attacker;
+                for (size_t y = 0; y < set_size; y++) {
+                    attacker.push_back(c.random());
+                    c.insert(attacker.back(), &victim);
+                }
+                uint64_t miss_cnt = set_size;
+                prune(c, attacker, miss_cnt);
+                misses[set_size] += miss_cnt;
+
+                std::unordered_set<uint64_t> attacker_set(attacker.begin(),
+                                                          attacker.end());
+                if (c.wouldEvict(attacker_set, target))
+                    success[set_size]++;
+                else
+                    fail[set_size]++;
+            }
+        });
+
+    py::dict result;
+    result["success"] = success;
+    result["fail"] = fail;
+    result["misses"] = misses;
+    return result;
+}
+
+/**
+ * Prime+prune+probe profiling of one target. Returns the number of
+ * misses of every run that found a complete eviction set, and how many
+ * of those needed at most as many misses as the cache has entries.
+ */
+py::tuple
+primePruneProbeProfiling(unsigned ways, unsigned idx_width,
+                         const std::string &policy, size_t iterations,
+                         size_t set_size, unsigned threads,
+                         const py::object &seed)
+{
+    const uint64_t entries = uint64_t(ways) << idx_width;
+    const uint64_t max_misses = 2 * entries;
+    std::vector<int64_t> run_misses(iterations, -1);
+    const uint64_t base_seed = seedFrom(seed);
+    const uint64_t target = std::mt19937_64(~base_seed)();
+
+    parallelFor(ways, idx_width, policy, base_seed, threads,
+                iterations, [&](Cache &c, size_t iteration) {
+        CacheEntry victim;
+        std::vector<uint64_t> attacker;
+        std::vector<uint64_t> G; // Generalized eviction set
+        uint64_t misses = 0;
+        for (size_t i = 0; i < set_size; i++)
+            attacker.push_back(c.random());
+
+        auto evicts_target = [&](uint64_t addr) {
+            if (c.insert(addr, &victim))
+                return false;
+            misses++;
+            return victim.valid && victim.address == target;
+        };
+
+        while (true) {
+            while (attacker.size() < set_size)
+                attacker.push_back(c.random());
+
+            // Prime
+            for (uint64_t addr : attacker) {
+                if (!c.insert(addr, &victim))
+                    misses++;
+            }
+            prune(c, attacker, misses);
+
+            // Victim access
+            c.insert(target, &victim);
+            bool victim_removed = false;
+
+            // Probe
+            for (auto it = attacker.begin(); it != attacker.end(); ++it) {
+                if (!c.insert(*it, &victim)) {
+                    G.push_back(*it);
+                    victim_removed = victim.valid &&
+                        victim.address == target;
+                    attacker.erase(it);
+                    break;
+                }
+            }
+
+            if (misses > max_misses)
+                break;
+
+            // Evict the victim entry to start the next round, starting
+            // with the addresses known to conflict with it
+            for (uint64_t addr : G) {
+                if (evicts_target(addr)) {
+                    victim_removed = true;
+                    break;
+                }
+            }
+            for (size_t i = 0; i < attacker.size() && !victim_removed; i++)
+                victim_removed = evicts_target(attacker[i]);
+            while (!victim_removed) {
+                attacker.push_back(c.random());
+                if (evicts_target(attacker.back())) {
+                    victim_removed = true;
+                    break;
+                }
+                for (uint64_t addr : attacker) {
+                    if (evicts_target(addr)) {
+                        victim_removed = true;
+                        break;
+                    }
+                }
+            }
+
+            if (attacker.size() > set_size)
+                attacker.erase(attacker.begin(),
+                               attacker.end() - set_size);
+
+            if (c.checkEvictionSet(target, G)) {
+                run_misses[iteration] = misses;
+                break;
+            } else if (misses > max_misses) {
+                break;
+            }
+        }
+    });
+
+    std::vector<uint64_t> result;
+    size_t profiled = 0;
+    for (int64_t m : run_misses) {
+        if (m < 0)
+            continue;
+        result.push_back(m);
+        if (uint64_t(m) <= entries)
+            profiled++;
+    }
+    return py::make_tuple(result, profiled);
+}
+
+} // anonymous namespace
+
+PYBIND11_MODULE(tlbcore, m)
+{
+    m.doc() = "C++ engine for the functional randomized TLB model";
+
+    py::class_<CacheEntry>(m, "CacheEntry")
+        .def_readonly("valid", &CacheEntry::valid)
+        .def_readonly("address", &CacheEntry::address)
+        .def_readonly("replacement_info", &CacheEntry::replacementInfo)
+        .def("get_address", [](const CacheEntry &e) { return e.address; })
+        .def("get_replacement_info",
+             [](const CacheEntry &e) { return e.replacementInfo; })
+        .def("__eq__", &CacheEntry::operator==)
+        .def("__ne__", [](const CacheEntry &a, const CacheEntry &b) {
+            return !(a == b);
+        });
+
+    py::class_<Cache>(m, "Cache")
+        .def(py::init([](unsigned ways, unsigned idx_width,
+                         const std::string &policy, const py::object &seed) {
+                 return new Cache(ways, idx_width, policy, seedFrom(seed));
+             }),
+             py::arg("ways"), py::arg("idx_width"),
+             py::arg("replacement_policy") = "RAND",
+             py::arg("seed") = py::none())
+        .def_property_readonly("ways", &Cache::ways)
+        .def_property_readonly("idx_width", &Cache::idxWidth)
+        .def_property_readonly("lines", &Cache::lines)
+        .def_property_readonly("replacement_policy", &Cache::policyString)
+        .def_property_readonly("invld_entry",
+                               [](const Cache &) { return CacheEntry(); })
+        .def("get_index", [](const Cache &c, uint64_t address) {
+            std::vector<uint64_t> indices(c.ways());
+            c.getIndex(address, indices.data());
+            return indices;
+        })
+        .def("insert", [](Cache &c, uint64_t address) -> py::object {
+            CacheEntry victim;
+            if (c.insert(address, &victim))
+                return py::none();
+            return py::cast(victim);
+        }, "Access an address. Returns None on a hit, otherwise the "
+           "replaced entry.")
+        .def("would_evict_attacker_address",
+             [](Cache &c, const std::vector<uint64_t> &attacker_addresses,
+                uint64_t address) {
+            std::unordered_set<uint64_t> set(attacker_addresses.begin(),
+                                             attacker_addresses.end());
+            return c.wouldEvict(set, address);
+        })
+        .def("check_eviction_set", &Cache::checkEvictionSet);
+
+    m.def("eviction_trials", &evictionTrials,
+          "Accesses to random addresses until a target is evicted, per "
+          "trial (Figure 5).",
+          py::arg("ways"), py::arg("idx_width"),
+          py::arg("replacement_policy"), py::arg("trials"),
+          py::arg("threads") = 0, py::arg("seed") = py::none());
+    m.def("prime_and_prune_once", &primeAndPruneOnce,
+          "Success/fail counts and misses of one prime+prune step per "
+          "initial prime set size (Figure 7).",
+          py::arg("ways"), py::arg("idx_width"),
+          py::arg("replacement_policy"), py::arg("iterations"),
+          py::arg("threads") = 0, py::arg("seed") = py::none());
+    m.def("prime_prune_probe_profiling", &primePruneProbeProfiling,
+          "Misses of the prime+prune+probe profiling runs and the number "
+          "of runs with at most as many misses as entries (Figure 8).",
+          py::arg("ways"), py::arg("idx_width"),
+          py::arg("replacement_policy"), py::arg("iterations") = 150,
+          py::arg("set_size") = 50, py::arg("threads") = 0,
+          py::arg("seed") = py::none());
+}
@@ -186,6 +186,11 @@ def config_cache(options, system):
                         ExternalCache("cpu%d.dcache" % i))
 
         system.cpu[i].createInterruptController()
+        if getattr(options, "parallel_cpus", False):
+            # The crossings go on the mem_side ports of the private caches
+            if options.external_memory_system:
+                fatal("Parallel CPUs can't use an external memory system.")
+            system.cpu[i].addEventqCrossings()
         if options.l2cache:
             system.cpu[i].connectAllPorts(system.tol2bus, system.membus)
         elif options.external_memory_system:
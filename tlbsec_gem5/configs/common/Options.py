@@ -354,6 +354,30 @@ def addCommonOptions(parser):
     parser.add_option("-F", "--fast-forward", action="store", type="string",
         default=None,
         help="Number of instructions to fast forward before switching")
+    parser.add_option("--smarts", action="store_true", default=False,
+        help="""Periodic sampling (SMARTS): alternate functional warming on
+                the atomic CPU with short detailed measurements on
+                --cpu-type and report CPI and TLB MPKI with confidence
+                intervals. TLB contents are carried over on every switch.""")
+    parser.add_option("--smarts-interval", action="store", type="int",
+        default=1000000,
+        help="Instructions per sampling unit, including the warmup and the "
+             "measurement window (default: %default)")
+    parser.add_option("--smarts-warmup", action="store", type="int",
+        default=2000,
+        help="Detailed warmup instructions before each measurement "
+             "(default: %default)")
+    parser.add_option("--smarts-window", action="store", type="int",
+        default=1000,
+        help="Measured instructions per sample (default: %default)")
+    parser.add_option("--smarts-samples", action="store", type="int",
+        default=0,
+        help="Number of samples to take, 0 samples until the workload "
+             "exits (default: %default)")
+    parser.add_option("--smarts-confidence", action="store", type="float",
+        default=0.997,
+        help="Confidence level of the reported intervals "
+             "(default: %default)")
     parser.add_option("-S", "--simpoint", action="store_true", default=False,
         help="""Use workload simpoints as an instruction offset for
                 --checkpoint-restore or --take-checkpoint.""")
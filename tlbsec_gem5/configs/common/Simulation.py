@@ -37,6 +37,7 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+import math
 import sys
 from os import getcwd
 from os.path import join as joinpath
@@ -76,7 +77,7 @@ def setCPUClass(options):
         if options.restore_with_cpu != options.cpu_type:
             CPUClass = TmpClass
             TmpClass, test_mem_mode = getCPUClass(options.restore_with_cpu)
-    elif options.fast_forward:
+    elif options.fast_forward or options.smarts:
         CPUClass = TmpClass
         TmpClass = AtomicSimpleCPU
         test_mem_mode = 'atomic'
@@ -424,7 +425,125 @@ def repeatSwitch(testsys, repeat_switch_cpu_list, maxtick, switch_freq):
             exit_event = m5.simulate(maxtick - m5.curTick())
             return exit_event
 
-def run(options, root, testsys, cpu_class):
+def _tlbCounters(cpus):
+    """Sum of the (accesses, misses) counters of all TLBs that export
+    them, e.g. the RISC-V TLBs."""
+    accesses = misses = 0
+    for cpu in cpus:
+        for tlb in (cpu.mmu.itb, cpu.mmu.dtb):
+            if hasattr(tlb, "totalAccesses"):
+                accesses += tlb.totalAccesses()
+                misses += tlb.totalMisses()
+    return accesses, misses
+
+def _normalQuantile(p):
+    """Inverse of the standard normal CDF, by bisection on math.erf."""
+    lo, hi = -10.0, 10.0
+    for _ in range(100):
+        mid = (lo + hi) / 2
+        if 0.5 * (1 + math.erf(mid / math.sqrt(2))) < p:
+            lo = mid
+        else:
+            hi = mid
+    return (lo + hi) / 2
+
+def _sampleSummary(name, values, z, rel_err=0.03):
+    """Mean, standard deviation, confidence half-width and the number of
+    samples needed for a +-rel_err relative error of a list of per-sample
+    measurements."""
+    n = len(values)
+    mean = sum(values) / n
+    var = sum((v - mean) ** 2 for v in values) / (n - 1) if n > 1 else 0.0
+    std = math.sqrt(var)
+    half = z * std / math.sqrt(n)
+    needed = 0
+    if mean > 0:
+        needed = int(math.ceil((z * std / mean / rel_err) ** 2))
+    return ("%-10s mean %.6f stddev %.6f +- %.6f (%.2f%%), "
+            "samples for +-%d%%: %d" %
+            (name, mean, std, half, 100.0 * half / mean if mean else 0.0,
+             int(rel_err * 100), needed))
+
+def smartsSampling(options, testsys, switch_cpu_list, maxtick):
+    """SMARTS-style systematic sampling.
+
+    Every sampling unit of --smarts-interval instructions starts with
+    functional warming on the atomic CPU. The caches and TLBs stay warm
+    across the switch to the detailed CPU, which then runs a short warmup
+    to fill its pipeline state before a measurement window in which CPI
+    and TLB misses are recorded.
+    """
+    interval = options.smarts_interval
+    warmup = options.smarts_warmup
+    window = options.smarts_window
+    if window <= 0 or interval <= warmup + window:
+        fatal("--smarts-interval must be larger than --smarts-warmup "
+              "plus a non-empty --smarts-window")
+
+    period = m5.ticks.fromSeconds(convert.anyToLatency(options.cpu_clock))
+    np = len(switch_cpu_list)
+    fast_cpus = [old for old, new in switch_cpu_list]
+    detailed_cpus = [new for old, new in switch_cpu_list]
+    back_list = [(new, old) for old, new in switch_cpu_list]
+
+    cpi = []
+    tlb_mpki = []
+    exit_event = None
+    while not options.smarts_samples or len(cpi) < options.smarts_samples:
+        fast_cpus[0].scheduleInstStop(0, interval - warmup - window,
+                                      "smarts phase done")
+        exit_event = m5.simulate(maxtick - m5.curTick())
+        if exit_event.getCause() != "smarts phase done":
+            break
+
+        m5.switchCpus(testsys, switch_cpu_list)
+
+        detailed_cpus[0].scheduleInstStop(0, warmup, "smarts phase done")
+        exit_event = m5.simulate(maxtick - m5.curTick())
+        if exit_event.getCause() != "smarts phase done":
+            break
+
+        start_tick = m5.curTick()
+        start_insts = sum(cpu.totalInsts() for cpu in detailed_cpus)
+        start_acc, start_miss = _tlbCounters(detailed_cpus)
+        detailed_cpus[0].scheduleInstStop(0, window, "smarts phase done")
+        exit_event = m5.simulate(maxtick - m5.curTick())
+        if exit_event.getCause() != "smarts phase done":
+            break
+
+        insts = sum(cpu.totalInsts() for cpu in detailed_cpus) - start_insts
+        acc, miss = _tlbCounters(detailed_cpus)
+        cycles = (m5.curTick() - start_tick) / period
+        if insts > 0:
+            cpi.append(cycles * np / insts)
+            tlb_mpki.append(1000.0 * (miss - start_miss) / insts)
+
+        m5.switchCpus(testsys, back_list)
+
+    z = _normalQuantile(0.5 + options.smarts_confidence / 2)
+    lines = ["SMARTS: %d samples, interval %d, warmup %d, window %d, "
+             "confidence %.3f" % (len(cpi), interval, warmup, window,
+                                  options.smarts_confidence)]
+    if cpi:
+        lines.append(_sampleSummary("CPI", cpi, z))
+        lines.append(_sampleSummary("TLB MPKI", tlb_mpki, z))
+    print("\n".join(lines))
+
+    with open(joinpath(m5.options.outdir, "smarts.txt"), "w") as f:
+        f.write("\n".join(lines) + "\n")
+        f.write("# sample cpi tlb_mpki\n")
+        for i, (c, m) in enumerate(zip(cpi, tlb_mpki)):
+            f.write("%d %.6f %.6f\n" % (i, c, m))
+
+    return exit_event
+
+def run(options, root, testsys, cpu_class, configure_cpus=None):
+    """
+    Simulate testsys. configure_cpus(cpus, name), if given, is called on
+    the list of CPUs of every set of switch CPUs created here, e.g. to
+    give their MMUs the configuration of testsys.cpu, before they are
+    added to testsys as name.
+    """
     if options.checkpoint_dir:
         cptdir = options.checkpoint_dir
     elif m5.options.outdir:
@@ -444,6 +563,13 @@ def run(options, root, testsys, cpu_class):
     if options.repeat_switch and options.take_checkpoints:
         fatal("Can't specify both --repeat-switch and --take-checkpoints")
 
+    if options.smarts and (options.fast_forward or options.standard_switch
+                           or options.repeat_switch
+                           or options.take_checkpoints):
+        fatal("--smarts does its own CPU switching and can't be combined "
+              "with --fast-forward, --standard-switch, --repeat-switch or "
+              "--take-checkpoints")
+
     # Setup global stat filtering.
     stat_root_simobjs = []
     for stat_root_str in options.stats_root:
@@ -494,6 +620,8 @@ def run(options, root, testsys, cpu_class):
         if options.elastic_trace_en:
             CpuConfig.config_etrace(cpu_class, switch_cpus, options)
 
+        if configure_cpus:
+            configure_cpus(switch_cpus, "switch_cpus")
         testsys.switch_cpus = switch_cpus
         switch_cpu_list = [(testsys.cpu[i], switch_cpus[i]) for i in range(np)]
 
@@ -522,6 +650,8 @@ def run(options, root, testsys, cpu_class):
             if options.checker:
                 repeat_switch_cpus[i].addCheckerCpu()
 
+        if configure_cpus:
+            configure_cpus(repeat_switch_cpus, "repeat_switch_cpus")
         testsys.repeat_switch_cpus = repeat_switch_cpus
 
         if cpu_class:
@@ -576,6 +706,9 @@ def run(options, root, testsys, cpu_class):
                 switch_cpus[i].addCheckerCpu()
                 switch_cpus_1[i].addCheckerCpu()
 
+        if configure_cpus:
+            configure_cpus(switch_cpus, "switch_cpus")
+            configure_cpus(switch_cpus_1, "switch_cpus_1")
         testsys.switch_cpus = switch_cpus
         testsys.switch_cpus_1 = switch_cpus_1
         switch_cpu_list = [
@@ -656,7 +789,7 @@ def run(options, root, testsys, cpu_class):
         fatal("Bad maxtick (%d) specified: " \
               "Checkpoint starts starts from tick: %d", maxtick, cpt_starttick)
 
-    if options.standard_switch or cpu_class:
+    if (options.standard_switch or cpu_class) and not options.smarts:
         if options.standard_switch:
             print("Switch at instruction count:%s" %
                     str(testsys.cpu[0].max_insts_any_thread))
@@ -723,6 +856,9 @@ def run(options, root, testsys, cpu_class):
         if options.repeat_switch and maxtick > options.repeat_switch:
             exit_event = repeatSwitch(testsys, repeat_switch_cpu_list,
                                       maxtick, options.repeat_switch)
+        elif options.smarts:
+            exit_event = smartsSampling(options, testsys, switch_cpu_list,
+                                        maxtick)
         else:
             exit_event = benchCheckpoints(options, maxtick, cptdir)
 
@@ -38,7 +38,10 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+import json
 import optparse
+import os
+import re
 import sys
 from os import path
 
@@ -100,10 +103,245 @@ def generateDtb(system):
     fdt.writeDtsFile(path.join(m5.options.outdir, 'device.dts'))
     fdt.writeDtbFile(path.join(m5.options.outdir, 'device.dtb'))
 
+# Settings of one forked run, see runForkMatrix()
+fork_run_keys = {
+    "name": str,
+    "script": str,
+    "ways": int,
+    "sets": int,
+    "max_evict": int,
+    "randomized": bool,
+}
+
+def loadForkMatrix(filename):
+    with open(filename) as f:
+        runs = json.load(f)
+    if not isinstance(runs, list) or not runs:
+        fatal("%s: Expected a non-empty list of runs" % filename)
+
+    names = set()
+    for i, run in enumerate(runs):
+        for key, value in run.items():
+            if key not in fork_run_keys:
+                fatal("%s: Unknown setting '%s' in run %d" %
+                      (filename, key, i))
+            if not isinstance(value, fork_run_keys[key]):
+                fatal("%s: Setting '%s' of run %d must be a %s" %
+                      (filename, key, i, fork_run_keys[key].__name__))
+        run.setdefault("name", "run%d" % i)
+        if "script" not in run:
+            fatal("%s: Run '%s' has no script" % (filename, run["name"]))
+        if run["name"] in names or "/" in run["name"]:
+            fatal("%s: Run names must be unique directory names ('%s')" %
+                  (filename, run["name"]))
+        names.add(run["name"])
+    return runs
+
+def writeForkBootScript(options, filename):
+    """
+    The parent runs the --script commands (e.g. to start a background
+    load) and stops at the first m5 exit. Every child then gets its own
+    script from the second m5 readfile.
+    """
+    with open(filename, "w") as f:
+        f.write("#!/bin/sh\n")
+        if options.script is not None:
+            with open(options.script) as pre:
+                f.write(pre.read().rstrip("\n") + "\n")
+        f.write("m5 exit\n")
+        f.write("m5 readfile > /tmp/fork_run.sh\n")
+        f.write("sh /tmp/fork_run.sh\n")
+        f.write("m5 exit\n")
+
+def applyForkRun(system, run):
+    for cpu in system.cpu:
+        for tlb in (cpu.mmu.itb, cpu.mmu.dtb):
+            cache = tlb.tlb_cache
+            cache.reconfigure(int(run.get("ways", cache.ways)),
+                              int(run.get("sets", cache.sets)),
+                              int(run.get("max_evict", cache.max_evict)),
+                              bool(run.get("randomized", cache.randomized)))
+            # The resized cache starts out empty; drop the copies of its
+            # old entries without counting a flush of the TLB itself.
+            tlb.flushMicroTlb()
+            tlb.flushHostPages()
+    system.setReadfile(run["script"])
+
+def runForkMatrix(options, root, system, runs):
+    """
+    Boot once up to the first m5 exit of the boot script, then fork one
+    simulator per run. Each child reconfigures the TLBs, runs the script
+    of its run and writes its output to <outdir>/<name>/. At most
+    --fork-jobs children run at the same time.
+    """
+    m5.instantiate()
+    exit_event = m5.simulate()
+    if exit_event.getCause() != "m5_exit instruction encountered":
+        fatal("Boot ended before the fork point: %s" % exit_event.getCause())
+    print("Reached fork point @ tick %i" % m5.curTick())
+
+    jobs = options.fork_jobs or os.cpu_count() or 1
+    running = {}
+    status = {}
+
+    def reap():
+        pid, code = os.wait()
+        if os.WIFEXITED(code):
+            code = os.WEXITSTATUS(code)
+        else:
+            code = -os.WTERMSIG(code)
+        name = running.pop(pid)
+        status[name] = code
+        print("Run %s finished with status %d" % (name, code))
+
+    for run in runs:
+        while len(running) >= jobs:
+            reap()
+
+        pid = m5.fork("%(parent)s/" + run["name"])
+        if pid == 0:
+            applyForkRun(system, run)
+            m5.stats.reset()
+            exit_event = m5.simulate(options.rel_max_tick or
+                                     m5.MaxTick - m5.curTick())
+            print("Run %s exiting @ tick %i because %s" %
+                  (run["name"], m5.curTick(), exit_event.getCause()))
+            sys.exit(exit_event.getCode())
+        running[pid] = run["name"]
+
+    while running:
+        reap()
+
+    failed = [run["name"] for run in runs if status[run["name"]] != 0]
+    if failed:
+        fatal("Runs failed: %s" % ", ".join(failed))
+
 # ----------------------------- Add Options ---------------------------- #
 parser = optparse.OptionParser()
 Options.addCommonOptions(parser)
 Options.addFSOptions(parser)
+parser.add_option("--itlb-micro-entries", type="int", default=0,
+                  help="Number of micro-TLB entries in front of the ITB "
+                       "(0 disables the micro-TLB)")
+parser.add_option("--dtlb-ports", type="int", default=0,
+                  help="DTB lookups per CPU cycle in timing mode "
+                       "(0: unlimited)")
+parser.add_option("--dtlb-banks", type="int", default=0,
+                  help="Number of banks the DTB sets are interleaved "
+                       "across, lookups conflicting on a bank wait a "
+                       "cycle (0: not banked)")
+parser.add_option("--dtlb-mshrs", type="int", default=0,
+                  help="MSHRs of the DTB in timing mode: misses to the "
+                       "same page merge, this many walks run in parallel "
+                       "(0: one walk at a time)")
+parser.add_option("--tlb-coalesce", type="int", default=1,
+                  help="Contiguous 4KiB pages one ITB/DTB entry may map "
+                       "(power of two up to 16, 1 disables coalescing)")
+parser.add_option("--tlb-domains", type="int", default=1,
+                  help="Number of domains the ASIDs of the ITB/DTB are "
+                       "grouped into for isolation stats")
+parser.add_option("--tlb-partition", type="string", default="",
+                  help="Comma-separated ways reserved for each domain, "
+                       "e.g. 2,2; fills only evict within their domain")
+parser.add_option("--tlb-asid-domain", action="append", default=[],
+                  metavar="ASID:DOMAIN",
+                  help="Put an ASID into a domain (repeatable), other "
+                       "ASIDs are in domain 0")
+parser.add_option("--tlb-victim-entries", type="int", default=0,
+                  help="Entries of the victim buffer of the ITB/DTB that "
+                       "catches evicted translations (0: none)")
+parser.add_option("--tlb-victim-latency", type="int", default=0,
+                  help="Extra cycles of a victim buffer hit (0: probed in "
+                       "parallel with the TLB)")
+parser.add_option("--tlb-victim-randomized", action="store_true",
+                  help="Drop the buffered entries of an ASID from the "
+                       "victim buffer when it is rerandomized")
+parser.add_option("--tlb-index", type="string", default="",
+                  help="Index function of the ITB/DTB: princeN, qarmaN, "
+                       "xor or identity (default: the built-in PRINCE)")
+parser.add_option("--tlb-index-latency", type="int", default=None,
+                  help="Cycles --tlb-index adds to every timing lookup "
+                       "(default: the latency of the index function)")
+parser.add_option("--tlb-neighbor-fill", action="store_true",
+                  help="Let the ITB/DTB walkers read whole lines of leaf "
+                       "PTEs and install the neighbouring translations")
+parser.add_option("--pte-buffer", type="int", default=0,
+                  help="Stage neighbouring translations in a PTE buffer of "
+                       "this many entries instead of the TLB (requires "
+                       "--tlb-neighbor-fill)")
+parser.add_option("--tlb-trace", action="store_true",
+                  help="Record every ITB/DTB translation of each CPU to "
+                       "tlb_trace.cpu<N>.trc.gz in the output directory "
+                       "(switch_cpus<N> etc. for the CPUs switched to)")
+parser.add_option("--tlb-mrc", action="store_true",
+                  help="Profile page-level stack distances of each ITB/DTB "
+                       "and write their miss-ratio curves to "
+                       "tlb_mrc.cpu<N>.<itb|dtb>.txt in the output directory")
+parser.add_option("--telemetry-interval", type="string", default=None,
+                  help="Sample the TLB access, miss, rerandomization and "
+                       "walk time counters at this simulated time "
+                       "interval, e.g. 100us")
+parser.add_option("--telemetry-insts", type="int", default=0,
+                  help="Sample the TLB counters every N instructions "
+                       "retired by all CPUs")
+parser.add_option("--telemetry-file", type="string",
+                  default="telemetry.bin",
+                  help="Telemetry output file, an HDF5 table if the name "
+                       "ends in .h5 (default: %default). Read it with "
+                       "util/telemetry.py")
+parser.add_option("--host-profile", action="store_true",
+                  help="Attribute host time to the objects owning the "
+                       "events and to TLB lookups, written to "
+                       "hostprof.txt and hostprof.folded (for "
+                       "flamegraph.pl) in the output directory")
+parser.add_option("--host-profile-no-scopes", action="store_true",
+                  help="With --host-profile, only time events")
+parser.add_option("--block-cache", action="store_true",
+                  help="Let the atomic CPUs, e.g. those of --fast-forward, "
+                       "execute from a cache of decoded basic blocks")
+parser.add_option("--data-backdoor", action="store_true",
+                  help="Let the atomic CPUs load (and, with one CPU, "
+                       "store) through memory backdoors, bypassing the "
+                       "memory system but not the TLBs; needs a system "
+                       "without caches")
+parser.add_option("--walk-backdoor", action="store_true",
+                  help="Let the page table walkers read PTEs of atomic "
+                       "and functional walks through memory backdoors; "
+                       "has no effect on walkers behind caches")
+parser.add_option("--tlb-coherence", action="store_true",
+                  help="Count sfence.vma instructions, the TLB entries they "
+                       "drop and the latency of IPI-based shootdowns "
+                       "(system.tlb_coherence statistics)")
+parser.add_option("--tlb-broadcast", action="store_true",
+                  help="With --tlb-coherence, also apply every kernel "
+                       "sfence.vma to the TLBs of all other CPUs, modelling "
+                       "a hardware broadcast invalidation")
+parser.add_option("--parallel-cpus", action="store_true",
+                  help="Simulate every CPU with its MMU, TLBs and L1 and "
+                       "walker caches in its own event queue (host "
+                       "thread), the L2 and the rest of the system in "
+                       "event queue 0")
+parser.add_option("--sim-quantum", type="string", default="1ns",
+                  help="Synchronization quantum of --parallel-cpus, "
+                       "i.e. the maximum skew between the event queues. "
+                       "L1 misses, interrupts and TLB broadcasts take one "
+                       "quantum to cross between event queues, so keep it "
+                       "within the latency of a hop to the L2 "
+                       "(default: %default)")
+parser.add_option("--disk-mmap", action="store_true",
+                  help="Map the disk image read-only and keep the written "
+                       "sectors in a memory overlay instead of reading "
+                       "the image through a copy-on-write sector table")
+parser.add_option("--fork-matrix", type="string", default=None,
+                  help="JSON list of runs, each with a 'script' for m5 "
+                       "readfile and optionally a 'name' and TLB 'ways', "
+                       "'sets', 'max_evict' and 'randomized'. Linux is "
+                       "booted once (running --script first) and one "
+                       "simulator is forked per run, writing its output "
+                       "to <outdir>/<name>")
+parser.add_option("--fork-jobs", type="int", default=0,
+                  help="Number of forked runs simulated at the same time "
+                       "(default: number of host cores)")
 
 # NOTE: Ruby in FS Linux has not been tested yet
 if '--ruby' in sys.argv:
@@ -116,6 +354,23 @@ if args:
     print("Error: script doesn't take any positional arguments")
     sys.exit(1)
 
+if options.parallel_cpus and (options.fast_forward or
+        options.standard_switch or options.repeat_switch or options.smarts or
+        options.fork_matrix):
+    fatal("--parallel-cpus can't be combined with CPU switching or "
+          "--fork-matrix")
+
+fork_runs = None
+if options.fork_matrix:
+    fork_runs = loadForkMatrix(options.fork_matrix)
+    if options.checkpoint_restore is not None or options.fast_forward or \
+            options.standard_switch or options.repeat_switch or \
+            options.smarts:
+        fatal("--fork-matrix can't be combined with checkpoint restore or "
+              "CPU switching")
+    # Forking is only possible without open sockets
+    m5.disableAllListeners()
+
 # CPU and Memory
 (CPUClass, mem_mode, FutureClass) = Simulation.setCPUClass(options)
 MemClass = Simulation.setMemClass(options)
@@ -147,8 +402,11 @@ system.platform.rtc = RiscvRTC(frequency=Frequency("100MHz"))
 system.platform.clint.int_pin = system.platform.rtc.int_pin
 
 # VirtIOMMIO
-image = CowDiskImage(child=RawDiskImage(read_only=True), read_only=False)
-image.child.image_file = mdesc.disks()[0]
+if options.disk_mmap:
+    image = MmapCowDiskImage(base_file=mdesc.disks()[0], read_only=False)
+else:
+    image = CowDiskImage(child=RawDiskImage(read_only=True), read_only=False)
+    image.child.image_file = mdesc.disks()[0]
 system.platform.disk = MmioVirtIO(
     vio=VirtIOBlock(image=image),
     interrupt_id=0x8,
@@ -188,7 +446,10 @@ system.cpu_clk_domain = SrcClockDomain(clock = options.cpu_clock,
 system.workload.object_file = options.kernel
 
 # NOTE: Not yet tested
-if options.script is not None:
+if fork_runs is not None:
+    system.readfile = path.join(m5.options.outdir, "fork_boot.rcS")
+    writeForkBootScript(options, system.readfile)
+elif options.script is not None:
     system.readfile = options.script
 
 system.init_param = options.init_param
@@ -236,11 +497,117 @@ uncacheable_range = [
     *system.platform._off_chip_ranges()
 ]
 
-# PMA checker can be defined at system-level (system.pma_checker)
-# or MMU-level (system.cpu[0].mmu.pma_checker). It will be resolved
-# by RiscvTLB's Parent.any proxy
-for cpu in system.cpu:
-    cpu.mmu.pma_checker = PMAChecker(uncacheable=uncacheable_range)
+def makeTLBIndex(name, latency):
+    """The index function SimObject for an IndexFunction name"""
+    match = re.match(r"^(?:(prince|qarma)(\d*)|(xor|identity))$", name)
+    if not match:
+        fatal("Unknown TLB index function %s" % name)
+    keyed, rounds, plain = match.groups()
+    index = {"prince": RiscvPrinceIndex, "qarma": RiscvQarmaIndex,
+             "xor": RiscvXorIndex,
+             "identity": RiscvIdentityIndex}[keyed or plain]()
+    if rounds:
+        index.rounds = int(rounds)
+    if latency is not None:
+        index.latency = latency
+    return index
+
+def configureMMUs(cpus):
+    """Apply the PMA checker and the TLB options to the MMUs of cpus"""
+    # PMA checker can be defined at system-level (system.pma_checker)
+    # or MMU-level (system.cpu[0].mmu.pma_checker). It will be resolved
+    # by RiscvTLB's Parent.any proxy
+    for cpu in cpus:
+        cpu.mmu.pma_checker = PMAChecker(uncacheable=uncacheable_range)
+        cpu.mmu.itb.micro_tlb_size = options.itlb_micro_entries
+        cpu.mmu.dtb.lookup_ports = options.dtlb_ports
+        cpu.mmu.dtb.lookup_banks = options.dtlb_banks
+        cpu.mmu.dtb.mshrs = options.dtlb_mshrs
+        for tlb in [cpu.mmu.itb, cpu.mmu.dtb]:
+            tlb.tlb_cache.coalesce_pages = options.tlb_coalesce
+            tlb.tlb_cache.victim_entries = options.tlb_victim_entries
+            tlb.tlb_cache.victim_randomized = \
+                bool(options.tlb_victim_randomized)
+            tlb.victim_latency = options.tlb_victim_latency
+            tlb.tlb_cache.domains = options.tlb_domains
+            if options.tlb_partition:
+                tlb.tlb_cache.partition_ways = \
+                    [int(w) for w in options.tlb_partition.split(",")]
+            asid_domains = {}
+            for pair in options.tlb_asid_domain:
+                asid, domain = pair.split(":")
+                asid_domains[int(asid, 0)] = int(domain)
+            if asid_domains:
+                tlb.tlb_cache.asid_domains = [asid_domains.get(a, 0)
+                    for a in range(max(asid_domains) + 1)]
+            tlb.walker.neighbor_fill = options.tlb_neighbor_fill
+            tlb.walker.pte_buffer_entries = options.pte_buffer
+            tlb.walker.backdoor = bool(options.walk_backdoor)
+            if options.tlb_index:
+                tlb.tlb_cache.index = makeTLBIndex(options.tlb_index,
+                                                   options.tlb_index_latency)
+
+# ------------------------- Translation Tracing ------------------------ #
+
+def configureTracing(cpus, name):
+    """Trace and profile the TLBs of cpus, which are added as name"""
+    if options.tlb_trace:
+        for i, cpu in enumerate(cpus):
+            cpu.tlb_trace = TLBTraceProbe(manager=[cpu.mmu.itb, cpu.mmu.dtb],
+                trace_file="tlb_trace.%s%d.trc.gz" % (name, i))
+
+    if options.tlb_mrc:
+        for i, cpu in enumerate(cpus):
+            for tlb_name in ["itb", "dtb"]:
+                tlb = getattr(cpu.mmu, tlb_name)
+                tlb.stack_dist = TLBStackDistProbe(manager=tlb,
+                    mrc_file="tlb_mrc.%s%d.%s.txt" % (name, i, tlb_name))
+
+if options.telemetry_insts and options.parallel_cpus:
+    fatal("--telemetry-insts can't count instructions across event queues, "
+          "use --telemetry-interval with --parallel-cpus")
+
+if options.telemetry_interval or options.telemetry_insts:
+    # Instructions are only counted within one event queue
+    system.telemetry = Telemetry(file=options.telemetry_file,
+                                 interval_insts=options.telemetry_insts,
+                                 cpus=[] if options.parallel_cpus
+                                      else system.cpu)
+    if options.telemetry_interval:
+        system.telemetry.interval = options.telemetry_interval
+
+if options.host_profile:
+    system.host_profiler = HostProfiler(
+        scopes=not options.host_profile_no_scopes)
+
+# ---------------------------- TLB Shootdowns -------------------------- #
+
+if options.tlb_broadcast and not options.tlb_coherence:
+    fatal("--tlb-broadcast requires --tlb-coherence")
+
+if options.tlb_coherence:
+    system.tlb_coherence = RiscvTLBCoherence(clint=system.platform.clint,
+                                             broadcast=options.tlb_broadcast)
+
+def configureCPUs(cpus, name):
+    """
+    Apply the TLB, tracing, telemetry and shootdown options to cpus,
+    which are added to the system as name. Also called on the CPUs that
+    Simulation.run() switches to, so that every CPU gets the same TLBs.
+    """
+    configureMMUs(cpus)
+    configureTracing(cpus, name)
+    for cpu in cpus:
+        if options.telemetry_interval or options.telemetry_insts:
+            cpu.mmu.itb.telemetry = system.telemetry
+            cpu.mmu.dtb.telemetry = system.telemetry
+        if isinstance(cpu, AtomicSimpleCPU):
+            cpu.block_cache = bool(options.block_cache)
+            cpu.data_backdoor = bool(options.data_backdoor)
+        if options.tlb_coherence:
+            cpu.mmu.coherence = system.tlb_coherence
+
+configureCPUs(system.cpu, "cpu")
 
 # --------------------------- DTB Generation --------------------------- #
 
@@ -270,5 +637,22 @@ MemConfig.config_mem(options, system)
 
 root = Root(full_system=True, system=system)
 
-Simulation.setWorkCountOptions(system, options)
-Simulation.run(options, root, system, FutureClass)
+# ------------------------- Parallel Simulation ------------------------ #
+
+# Everything below a CPU (MMU, TLBs, walkers, L1 and walker caches)
+# inherits its event queue. The EventqCrossings added by CacheConfig
+# connect the caches to the L2 bus or the membus, which stay in queue 0
+# with the rest of the memory system, and interrupts are posted across
+# queues by IntrControl.
+if options.parallel_cpus and np > 1:
+    for i, cpu in enumerate(system.cpu):
+        cpu.eventq_index = i + 1
+    root.sim_quantum = m5.ticks.fromSeconds(
+        m5.util.convert.anyToLatency(options.sim_quantum))
+
+if fork_runs is not None:
+    runForkMatrix(options, root, system, fork_runs)
+else:
+    Simulation.setWorkCountOptions(system, options)
+    Simulation.run(options, root, system, FutureClass,
+                   configure_cpus=configureCPUs)
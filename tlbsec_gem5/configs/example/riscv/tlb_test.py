@@ -0,0 +1,155 @@
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+
+# This script stresses and benchmarks a RISC-V MMU without a CPU or guest:
+# a TLBTester builds Sv39 page tables in memory, translates a synthetic
+# stream of virtual addresses through the ITB/DTB and their walkers, and
+# checks each physical address against the mappings it built.
+
+parser = optparse.OptionParser()
+
+parser.add_option("-a", "--atomic", action="store_true",
+                  help="Use atomic (non-timing) mode")
+parser.add_option("-n", "--translations", type="int", default=1000000,
+                  help="Translations to check before exiting")
+parser.add_option("--pattern", type="choice", default="Uniform",
+                  choices=["Uniform", "Zipf", "Strided"],
+                  help="Virtual address pattern")
+parser.add_option("--footprint", default="64MiB",
+                  help="Size of the mapped virtual range")
+parser.add_option("--stride", default="4KiB",
+                  help="Stride of the Strided pattern")
+parser.add_option("--zipf-exponent", type="float", default=1.0,
+                  help="Exponent of the Zipf pattern")
+parser.add_option("--asids", type="int", default=1,
+                  help="Address spaces to spread the accesses over")
+parser.add_option("--huge-percent", type="int", default=0,
+                  help="Percentage of 2MiB regions mapped by 2MiB pages")
+parser.add_option("--shuffle-frames", action="store_true",
+                  help="Map the pages of a region to shuffled frames")
+parser.add_option("--sfence-interval", type="int", default=0,
+                  help="Translations between injected sfence.vma")
+parser.add_option("--outstanding", type="int", default=4,
+                  help="Translations in flight (per cycle in atomic mode)")
+parser.add_option("--tlb-ways", type="int", default=4,
+                  help="Associativity of the TLBs")
+parser.add_option("--tlb-sets", type="int", default=16,
+                  help="Sets of the TLBs")
+parser.add_option("--sa-tlb", action="store_true",
+                  help="Use set-associative instead of randomized TLBs")
+parser.add_option("--tlb-coalesce", type="int", default=1,
+                  help="Contiguous 4KiB pages one TLB entry may map")
+parser.add_option("--tlb-neighbor-fill", action="store_true",
+                  help="Install the PTEs next to walked ones")
+parser.add_option("--pte-buffer", type="int", default=0,
+                  help="Entries of the walker PTE buffer")
+parser.add_option("--mshrs", type="int", default=0,
+                  help="MSHRs of the TLBs in timing mode")
+parser.add_option("--lookup-ports", type="int", default=0,
+                  help="Timing lookups per cycle of the TLBs")
+parser.add_option("--switch-after", type="int", default=0,
+                  help="Translations in atomic mode before a second MMU "
+                       "takes over in timing mode, which checks that the "
+                       "TLB contents survive a CPU switch")
+
+(options, args) = parser.parse_args()
+
+if args:
+    print("Error: script doesn't take any positional arguments")
+    sys.exit(1)
+
+system = System(mem_ranges = [AddrRange('0x80000000', size = '256MiB')])
+system.voltage_domain = VoltageDomain()
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain = system.voltage_domain)
+system.mem_mode = 'atomic' if options.atomic or options.switch_after \
+    else 'timing'
+
+system.membus = SystemXBar()
+system.system_port = system.membus.cpu_side_ports
+system.physmem = SimpleMemory(range = system.mem_ranges[0])
+system.physmem.port = system.membus.mem_side_ports
+
+tester = TLBTester(pattern = options.pattern,
+                   footprint = options.footprint,
+                   stride = options.stride,
+                   zipf_exponent = options.zipf_exponent,
+                   asids = options.asids,
+                   huge_percent = options.huge_percent,
+                   contiguous = not options.shuffle_frames,
+                   sfence_interval = options.sfence_interval,
+                   max_outstanding = options.outstanding,
+                   max_translations = options.translations,
+                   page_table_base = system.mem_ranges[0].start)
+mmus = [tester.mmu]
+if options.switch_after:
+    tester.switch_mmu = RiscvMMU()
+    tester.switch_after = options.switch_after
+    mmus.append(tester.switch_mmu)
+for tlb in [t for mmu in mmus for t in [mmu.itb, mmu.dtb]]:
+    tlb.tlb_cache.ways = options.tlb_ways
+    tlb.tlb_cache.sets = options.tlb_sets
+    tlb.tlb_cache.randomized = not options.sa_tlb
+    tlb.tlb_cache.coalesce_pages = options.tlb_coalesce
+    tlb.mshrs = options.mshrs
+    tlb.lookup_ports = options.lookup_ports
+    tlb.walker.neighbor_fill = options.tlb_neighbor_fill
+    tlb.walker.pte_buffer_entries = options.pte_buffer
+tester.connectWalkerPorts(system.membus.cpu_side_ports)
+system.tester = tester
+
+# The MMU only translates in full-system mode
+root = Root(full_system = True, system = system)
+
+m5.instantiate()
+
+exit_event = m5.simulate()
+
+if options.switch_after and \
+        exit_event.getCause() == "switching the MMU of the TLB tester":
+    # Switch like m5.switchCpus() from an atomic to a timing CPU
+    m5.drain()
+    system.setMemoryMode(m5.objects.params.timing)
+    tester.switchMmu()
+    exit_event = m5.simulate()
+
+print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
+
+# Each translation looks up the TLB once, however often a timing lookup is
+# merged, blocked or redone
+if exit_event.getCause() == "maximum number of TLB translations reached":
+    accesses = sum(t.totalAccesses() for mmu in mmus
+                   for t in [mmu.itb, mmu.dtb])
+    if accesses != options.translations:
+        print("Error: the TLBs counted %d accesses for %d translations" %
+              (accesses, options.translations))
+        sys.exit(1)
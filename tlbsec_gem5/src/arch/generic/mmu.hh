@@ -68,6 +68,14 @@ class BaseMMU : public SimObject
         itb->flushAll();
     }
 
+    /** The CPU is switched out, see BaseTLB::switchOut(). */
+    void
+    switchOut()
+    {
+        dtb->switchOut();
+        itb->switchOut();
+    }
+
     void
     demapPage(Addr vaddr, uint64_t asn)
     {
@@ -103,6 +111,27 @@ class BaseMMU : public SimObject
         return getTlb(mode)->finalizePhysical(req, tc, mode);
     }
 
+    uint8_t *
+    translateHost(const RequestPtr &req, ThreadContext *tc,
+                  BaseTLB::Mode mode)
+    {
+        return getTlb(mode)->translateHost(req, tc, mode);
+    }
+
+    void
+    setHostPage(const RequestPtr &req, ThreadContext *tc,
+                BaseTLB::Mode mode, uint8_t *host_page)
+    {
+        getTlb(mode)->setHostPage(req, tc, mode, host_page);
+    }
+
+    void
+    flushHostPages()
+    {
+        dtb->flushHostPages();
+        itb->flushHostPages();
+    }
+
     virtual void takeOverFrom(BaseMMU *old_mmu);
 
   public:
@@ -115,11 +115,49 @@ class BaseTLB : public SimObject
     virtual Fault finalizePhysical(
             const RequestPtr &req, ThreadContext *tc, Mode mode) const = 0;
 
+    /**
+     * Translate an access to a page backed by host memory, see
+     * setHostPage(). A hit replaces translateAtomic() and the memory
+     * access: the TLB updates its state and statistics as for a hit and
+     * sets the physical address of the request, but nothing is
+     * checked again.
+     *
+     * @return Host pointer to the first byte of the access, or nullptr
+     *         if the access has to be translated and sent as a packet.
+     */
+    virtual uint8_t *
+    translateHost(const RequestPtr &req, ThreadContext *tc, Mode mode)
+    {
+        return nullptr;
+    }
+
+    /**
+     * Record that the page of req, just translated by translateAtomic()
+     * for an access in the given mode, is held by host memory at
+     * host_page. TLBs without host pages ignore it.
+     */
+    virtual void
+    setHostPage(const RequestPtr &req, ThreadContext *tc, Mode mode,
+                uint8_t *host_page)
+    {
+    }
+
+    /** Forget all pages recorded by setHostPage(). */
+    virtual void flushHostPages() {}
+
     /**
      * Remove all entries from the TLB
      */
     virtual void flushAll() = 0;
 
+    /**
+     * Called when the CPU is switched out. The TLB is flushed, so that
+     * it holds no stale translations if the CPU is switched in again.
+     * TLBs that hand their entries to the TLB taking over from them may
+     * keep them instead, as takeOverFrom() replaces them on switch in.
+     */
+    virtual void switchOut() { flushAll(); }
+
     /**
      * Take over from an old tlb context
      */
@@ -36,11 +36,25 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 from m5.params import *
+from m5.proxy import *
+from m5.SimObject import SimObject
 
 from m5.objects.BaseMMU import BaseMMU
 from m5.objects.RiscvTLB import RiscvTLB
 from m5.objects.PMAChecker import PMAChecker
 
+class RiscvTLBCoherence(SimObject):
+    type = 'RiscvTLBCoherence'
+    cxx_class = 'RiscvISA::TLBCoherence'
+    cxx_header = 'arch/riscv/tlb_coherence.hh'
+    system = Param.System(Parent.any, "System the harts belong to")
+    clint = Param.Clint(NULL, "CLINT whose msip writes carry the "
+                        "shootdown IPIs")
+    broadcast = Param.Bool(False, "Apply every S-mode sfence.vma to the "
+                           "TLBs of all harts")
+    broadcast_latency = Param.Latency('20ns', "Interconnect time of one "
+                                      "broadcast invalidation")
+
 class RiscvMMU(BaseMMU):
     type = 'RiscvMMU'
     cxx_class = 'RiscvISA::MMU'
@@ -48,6 +62,8 @@ class RiscvMMU(BaseMMU):
     itb = RiscvTLB()
     dtb = RiscvTLB()
     pma_checker = Param.PMAChecker(PMAChecker(), "PMA Checker")
+    coherence = Param.RiscvTLBCoherence(NULL, "Shootdown accounting shared "
+                                        "by the MMUs of all harts")
 
     @classmethod
     def walkerPorts(cls):
@@ -34,6 +34,7 @@ from m5.proxy import *
 from m5.objects.BaseTLB import BaseTLB
 from m5.objects.ClockedObject import ClockedObject
 from m5.SimObject import SimObject
+from m5.util.pybind import PyBindMethod
 
 class RiscvPagetableWalker(ClockedObject):
     type = 'RiscvPagetableWalker'
@@ -43,21 +44,124 @@ class RiscvPagetableWalker(ClockedObject):
     system = Param.System(Parent.any, "system object")
     num_squash_per_cycle = Param.Unsigned(4,
             "Number of outstanding walks that can be squashed per cycle")
+    neighbor_fill = Param.Bool(False, "Read the whole cache line of "
+            "4KiB leaf PTEs and also install the valid leaf PTEs next to "
+            "the walked one")
+    pte_buffer_entries = Param.Unsigned(0, "Stage neighbouring PTEs in "
+            "a FIFO buffer of this many entries that is checked on TLB "
+            "misses instead of installing them in the TLB (0: no buffer)")
+    backdoor = Param.Bool(False, "Read the PTEs of atomic and functional "
+            "walks through memory backdoors where memory grants them, i.e. "
+            "with no cache between the walker and memory")
     # Grab the pma_checker from the MMU
     pma_checker = Param.PMAChecker(Parent.any, "PMA Checker")
 
+class RiscvTLBIndex(SimObject):
+    type = 'RiscvTLBIndex'
+    abstract = True
+    cxx_class = 'RiscvISA::TLBIndex'
+    cxx_header = 'arch/riscv/tlb_index.hh'
+    latency = Param.Cycles(0, "Cycles to compute the set indices, added "
+            "to every timing lookup of the TLB")
+
+class RiscvPrinceIndex(RiscvTLBIndex):
+    type = 'RiscvPrinceIndex'
+    cxx_class = 'RiscvISA::PrinceTLBIndex'
+    cxx_header = 'arch/riscv/tlb_index.hh'
+    rounds = Param.Unsigned(3, "3 for the reduced PRINCE the TLB always "
+            "used, or an even number of core rounds from 2 to 12 (12 is "
+            "full PRINCE)")
+    latency = 1
+
+class RiscvQarmaIndex(RiscvTLBIndex):
+    type = 'RiscvQarmaIndex'
+    cxx_class = 'RiscvISA::QarmaTLBIndex'
+    cxx_header = 'arch/riscv/tlb_index.hh'
+    rounds = Param.Unsigned(5, "QARMA-64 rounds on each side of the "
+            "reflector (1 to 8)")
+    latency = 2
+
+class RiscvXorIndex(RiscvTLBIndex):
+    type = 'RiscvXorIndex'
+    cxx_class = 'RiscvISA::XorTLBIndex'
+    cxx_header = 'arch/riscv/tlb_index.hh'
+
+class RiscvIdentityIndex(RiscvTLBIndex):
+    type = 'RiscvIdentityIndex'
+    cxx_class = 'RiscvISA::IdentityTLBIndex'
+    cxx_header = 'arch/riscv/tlb_index.hh'
+
 class RiscVTLBCache(SimObject):
     type = 'RiscVTLBCache'
     cxx_class = 'RiscvISA::RiscVTLBCache'
     cxx_header = 'arch/riscv/tlb_cache.hh'
+    ways = Param.Unsigned(4, "Associativity of the TLB")
+    sets = Param.Unsigned(16, "Number of sets (power of two)")
+    max_evict = Param.UInt32(64, "Evictions per ASID before its random id "
+            "is changed (rerandomization), 0 disables rerandomization")
+    randomized = Param.Bool(True, "Use PRINCE-randomized per-way set "
+            "indices, otherwise index the TLB set associatively")
+    index = Param.RiscvTLBIndex(NULL, "Index function (and its latency) "
+            "used instead of the one randomized selects; rerandomization "
+            "still requires randomized")
+    coalesce_pages = Param.Unsigned(1, "Contiguous 4KiB pages one entry "
+            "can map (power of two up to 16), 1 disables coalescing")
+    domains = Param.Unsigned(1, "Number of security/QoS domains the ASIDs "
+            "are grouped into (up to 16)")
+    asid_domains = VectorParam.Unsigned([], "Domain of ASID i, ASIDs "
+            "beyond the list are in domain 0")
+    partition_ways = VectorParam.Unsigned([], "Ways reserved for each "
+            "domain, in way order and adding up to ways; fills then only "
+            "evict entries within their domain's partition. Empty lets "
+            "all domains share all ways")
+    victim_entries = Param.Unsigned(0, "Entries (up to 16) of a fully "
+            "associative buffer of evicted entries searched on misses, "
+            "0 disables it")
+    victim_randomized = Param.Bool(False, "Make the victim buffer part of "
+            "the randomized domain: a buffered entry stops hitting once "
+            "its ASID is rerandomized")
+
+    cxx_exports = [
+        PyBindMethod("reconfigure"),
+        PyBindMethod("setAsidDomain"),
+    ]
 
 class RiscvTLB(BaseTLB):
     type = 'RiscvTLB'
     cxx_class = 'RiscvISA::TLB'
     cxx_header = 'arch/riscv/tlb.hh'
     size = Param.Int(64, "TLB size")
+    micro_tlb_size = Param.Unsigned(0, "Number of entries (up to 8) of the "
+            "fully associative micro-TLB checked before the main TLB on "
+            "instruction fetches, 0 disables it")
+    victim_latency = Param.Cycles(0, "Extra cycles a timing translation "
+            "takes when it hits in the victim buffer of tlb_cache, 0 "
+            "models probing the buffer in parallel with the main array")
+    host_pages = Param.Unsigned(64, "Entries of the direct-mapped cache of "
+            "data pages backed by host memory, used by atomic CPUs with "
+            "data_backdoor set (0 disables it)")
+    asid_stats_slots = Param.Unsigned(16, "Number of ASIDs that get their "
+            "own per-ASID stats, later ASIDs are accounted as 'other'")
     walker = Param.RiscvPagetableWalker(\
             RiscvPagetableWalker(), "page table walker")
     # Grab the pma_checker from the MMU
     pma_checker = Param.PMAChecker(Parent.any, "PMA Checker")
     tlb_cache = Param.RiscVTLBCache(RiscVTLBCache(), "Cache")
+    lookup_ports = Param.Unsigned(0, "Timing lookups per CPU cycle, "
+            "0 is unlimited")
+    lookup_banks = Param.Unsigned(0, "Number of banks (up to 64) the sets "
+            "are interleaved across; a lookup stalls if a bank one of its "
+            "ways reads is busy. 0 disables banking")
+    mshrs = Param.Unsigned(0, "Miss status holding registers of timing "
+            "translations: misses to a page being walked are merged, up to "
+            "this many walks proceed in parallel and lookups block while "
+            "all are taken. 0 walks one miss at a time and queues the rest")
+    telemetry = Param.Telemetry(NULL, "Time series the TLB registers its "
+            "access, miss, rerandomization and walk time counters with")
+
+    cxx_exports = [
+        PyBindMethod("totalAccesses"),
+        PyBindMethod("totalMisses"),
+        PyBindMethod("flushMicroTlb"),
+        PyBindMethod("flushHostPages"),
+    ]
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arch/riscv/index_function.hh"
+
+#include <cstdlib>
+
+#include "arch/riscv/prince.hh"
+#include "arch/riscv/qarma.hh"
+#include "base/logging.hh"
+
+namespace RiscvISA
+{
+
+void
+IndexFunction::wayIndices(uint64_t va, unsigned index_bits, uint64_t key,
+                          unsigned ways, unsigned set_bits,
+                          uint64_t *set_arr) const
+{
+    // Keyed permutations see the whole address, like the TLB always did
+    const uint64_t set_mask = (UINT64_C(1) << set_bits) - 1;
+    uint64_t randomization = permute(va, key);
+    unsigned used = 0;
+    uint64_t block = 0;
+    for (unsigned i = 0; i < ways; i++) {
+        if (used + set_bits > 64) {
+            block++;
+            randomization = permute(va,
+                    key ^ (block * UINT64_C(0x9e3779b97f4a7c15)));
+            used = 0;
+        }
+        set_arr[i] = (randomization >> used) & set_mask;
+        used += set_bits;
+    }
+}
+
+std::unique_ptr<IndexFunction>
+IndexFunction::create(const std::string &name)
+{
+    auto rounds = [&name](size_t prefix, unsigned def) {
+        if (name.size() == prefix)
+            return def;
+        char *end;
+        const unsigned long n = strtoul(name.c_str() + prefix, &end, 10);
+        return *end ? 0U : unsigned(n);
+    };
+
+    if (name.compare(0, 6, "prince") == 0) {
+        const unsigned n = rounds(6, 3);
+        if (n == 3 || (n >= 2 && n <= 12 && n % 2 == 0))
+            return std::unique_ptr<IndexFunction>(new PrinceIndex(n));
+    } else if (name.compare(0, 5, "qarma") == 0) {
+        const unsigned n = rounds(5, 5);
+        if (n >= 1 && n <= Qarma::MaxRounds)
+            return std::unique_ptr<IndexFunction>(new QarmaIndex(n));
+    } else if (name == "xor") {
+        return std::unique_ptr<IndexFunction>(new XorIndex);
+    } else if (name == "identity") {
+        return std::unique_ptr<IndexFunction>(new IdentityIndex);
+    }
+    return nullptr;
+}
+
+PrinceIndex::PrinceIndex(unsigned rounds) : rounds(rounds)
+{
+    fatal_if(rounds != 3 && (rounds < 2 || rounds > 12 || rounds % 2),
+             "PRINCE indexing needs 3 or an even number of 2 to 12 "
+             "rounds, not %d.\n", rounds);
+}
+
+std::string
+PrinceIndex::name() const
+{
+    return "prince" + std::to_string(rounds);
+}
+
+uint64_t
+PrinceIndex::permute(uint64_t va, uint64_t key) const
+{
+    if (rounds == 3)
+        return Prince::encrypt(va, key);
+    return Prince::encrypt(va, key, key, rounds);
+}
+
+QarmaIndex::QarmaIndex(unsigned rounds) : rounds(rounds)
+{
+    fatal_if(rounds == 0 || rounds > Qarma::MaxRounds,
+             "QARMA indexing needs 1 to %d rounds, not %d.\n",
+             Qarma::MaxRounds, rounds);
+}
+
+std::string
+QarmaIndex::name() const
+{
+    return "qarma" + std::to_string(rounds);
+}
+
+uint64_t
+QarmaIndex::permute(uint64_t va, uint64_t key) const
+{
+    return Qarma::encrypt(va, 0, key, key, rounds);
+}
+
+void
+XorIndex::wayIndices(uint64_t va, unsigned index_bits, uint64_t key,
+                     unsigned ways, unsigned set_bits,
+                     uint64_t *set_arr) const
+{
+    const uint64_t set_mask = (UINT64_C(1) << set_bits) - 1;
+    const uint64_t page = va >> index_bits;
+    for (unsigned i = 0; i < ways; i++) {
+        uint64_t folded = permute(page, key);
+        folded = i ? (folded << i) | (folded >> (64 - i)) : folded;
+        uint64_t index = 0;
+        for (; folded && set_bits; folded >>= set_bits)
+            index ^= folded & set_mask;
+        set_arr[i] = index;
+    }
+}
+
+uint64_t
+XorIndex::permute(uint64_t va, uint64_t key) const
+{
+    return va ^ key;
+}
+
+void
+IdentityIndex::wayIndices(uint64_t va, unsigned index_bits, uint64_t key,
+                          unsigned ways, unsigned set_bits,
+                          uint64_t *set_arr) const
+{
+    const uint64_t set_mask = (UINT64_C(1) << set_bits) - 1;
+    for (unsigned i = 0; i < ways; i++)
+        set_arr[i] = (va >> index_bits) & set_mask;
+}
+
+uint64_t
+IdentityIndex::permute(uint64_t va, uint64_t key) const
+{
+    return va;
+}
+
+} // namespace RiscvISA
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Functions mapping a page to a set in every way of the TLB. They have
+ * no simulator dependencies so that tlbsim and tlbattack can compare
+ * them outside of gem5; tlb_index.hh wraps them as SimObjects.
+ */
+
+#ifndef __ARCH_RISCV_INDEX_FUNCTION_HH__
+#define __ARCH_RISCV_INDEX_FUNCTION_HH__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace RiscvISA
+{
+
+class IndexFunction
+{
+  public:
+    virtual ~IndexFunction() {}
+
+    /** Short name for reports, e.g. prince12. */
+    virtual std::string name() const = 0;
+
+    /**
+     * Compute the set index of va in each way. Every way takes the next
+     * set_bits bits of keyed permutations of va, as in
+     * Prince::wayIndices().
+     *
+     * @param va Base address of the entry
+     * @param index_bits log2 of the bytes the entry maps
+     * @param key Key, including any per-process tweak
+     */
+    virtual void wayIndices(uint64_t va, unsigned index_bits, uint64_t key,
+                            unsigned ways, unsigned set_bits,
+                            uint64_t *set_arr) const;
+
+    /**
+     * Parse a name as returned by name(): "prince" (the reduced PRINCE
+     * of the TLB), "princeN", "qarma" (QARMA-64 with 5 rounds),
+     * "qarmaN", "xor" or "identity". Returns nullptr for anything else.
+     */
+    static std::unique_ptr<IndexFunction> create(const std::string &name);
+
+  protected:
+    /** Keyed permutation of va the set indices are sliced from. */
+    virtual uint64_t permute(uint64_t va, uint64_t key) const = 0;
+};
+
+/**
+ * PRINCE with a configurable number of rounds. Three rounds is the
+ * reduced variant the TLB always used, even numbers from 2 to 12 run the
+ * PRINCE core reduced to that many rounds.
+ */
+class PrinceIndex : public IndexFunction
+{
+  private:
+    const unsigned rounds;
+
+  public:
+    PrinceIndex(unsigned rounds);
+    std::string name() const override;
+
+  protected:
+    uint64_t permute(uint64_t va, uint64_t key) const override;
+};
+
+/** QARMA-64 with 1 to 8 rounds on each side of the reflector. */
+class QarmaIndex : public IndexFunction
+{
+  private:
+    const unsigned rounds;
+
+  public:
+    QarmaIndex(unsigned rounds);
+    std::string name() const override;
+
+  protected:
+    uint64_t permute(uint64_t va, uint64_t key) const override;
+};
+
+/**
+ * XOR-folds the page number, rotated by a different amount in every way,
+ * with the key. Pages that collide in one way rarely collide in the
+ * others, but eviction sets do not depend on the key.
+ */
+class XorIndex : public IndexFunction
+{
+  public:
+    std::string name() const override { return "xor"; }
+    void wayIndices(uint64_t va, unsigned index_bits, uint64_t key,
+                    unsigned ways, unsigned set_bits,
+                    uint64_t *set_arr) const override;
+
+  protected:
+    uint64_t permute(uint64_t va, uint64_t key) const override;
+};
+
+/** Low page number bits in every way, i.e. a set associative TLB. */
+class IdentityIndex : public IndexFunction
+{
+  public:
+    std::string name() const override { return "identity"; }
+    void wayIndices(uint64_t va, unsigned index_bits, uint64_t key,
+                    unsigned ways, unsigned set_bits,
+                    uint64_t *set_arr) const override;
+
+  protected:
+    uint64_t permute(uint64_t va, uint64_t key) const override;
+};
+
+} // namespace RiscvISA
+
+#endif // __ARCH_RISCV_INDEX_FUNCTION_HH__
@@ -35,6 +35,7 @@
 #include <sstream>
 
 #include "arch/riscv/interrupts.hh"
+#include "arch/riscv/mmu.hh"
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/registers.hh"
 #include "base/bitfield.hh"
@@ -355,6 +356,14 @@ ISA::setMiscReg(int misc_reg, RegVal val)
                     new_val.mode != AddrXlateMode::SV39)
                     new_val.mode = cur_val.mode;
                 setMiscRegNoEffect(misc_reg, new_val);
+                static_cast<MMU *>(tc->getMMUPtr())->flushMicroTlb();
+            }
+            break;
+          case MISCREG_PRV:
+            {
+                if (readMiscRegNoEffect(misc_reg) != val)
+                    static_cast<MMU *>(tc->getMMUPtr())->flushMicroTlb();
+                setMiscRegNoEffect(misc_reg, val);
             }
             break;
           case MISCREG_TSELECT:
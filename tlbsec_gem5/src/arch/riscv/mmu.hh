@@ -42,6 +42,7 @@
 #include "arch/riscv/isa.hh"
 #include "arch/riscv/pma_checker.hh"
 #include "arch/riscv/tlb.hh"
+#include "arch/riscv/tlb_coherence.hh"
 
 #include "params/RiscvMMU.hh"
 
@@ -51,9 +52,10 @@ class MMU : public BaseMMU
 {
   public:
     PMAChecker *pma;
+    TLBCoherence *coherence;
 
     MMU(const RiscvMMUParams &p)
-      : BaseMMU(p), pma(p.pma_checker)
+      : BaseMMU(p), pma(p.pma_checker), coherence(p.coherence)
     {}
 
     PrivilegeMode
@@ -62,6 +64,33 @@ class MMU : public BaseMMU
         return static_cast<TLB*>(dtb)->getMemPriv(tc, mode);
     }
 
+    void
+    flushMicroTlb()
+    {
+        static_cast<TLB*>(itb)->flushMicroTlb();
+        static_cast<TLB*>(dtb)->flushMicroTlb();
+    }
+
+    /**
+     * Invalidate the matching entries of both TLBs and return how many
+     * were dropped.
+     */
+    unsigned
+    demap(Addr vaddr, uint64_t asid)
+    {
+        return static_cast<TLB*>(itb)->demap(vaddr, asid) +
+               static_cast<TLB*>(dtb)->demap(vaddr, asid);
+    }
+
+    /** Execute an sfence.vma issued by tc at privilege pm. */
+    void
+    sfenceVma(ThreadContext *tc, Addr vaddr, uint64_t asid, PrivilegeMode pm)
+    {
+        unsigned dropped = demap(vaddr, asid);
+        if (coherence)
+            coherence->fence(tc, pm, vaddr, asid, dropped);
+    }
+
     Walker *
     getDataWalker()
     {
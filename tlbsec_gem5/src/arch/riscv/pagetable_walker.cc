@@ -50,6 +50,7 @@
 
 #include "arch/riscv/pagetable_walker.hh"
 
+#include <algorithm>
 #include <memory>
 
 #include "arch/riscv/faults.hh"
@@ -62,19 +63,22 @@
 #include "debug/PageTableWalker.hh"
 #include "mem/packet_access.hh"
 #include "mem/request.hh"
+#include "sim/byteswap.hh"
 
 namespace RiscvISA {
 
 Fault
 Walker::start(ThreadContext * _tc, BaseTLB::Translation *_translation,
-              const RequestPtr &_req, BaseTLB::Mode _mode)
+              const RequestPtr &_req, BaseTLB::Mode _mode,
+              Tick lookup_tick)
 {
-    // TODO: in timing mode, instead of blocking when there are other
-    // outstanding requests, see if this request can be coalesced with
-    // another one (i.e. either coalesce or start walk)
+    // In timing mode, up to maxWalks walks proceed in parallel and the
+    // rest wait for one of them to end. Misses to a page that is already
+    // being walked are merged by the MSHRs of the TLB, if it has any.
     WalkerState * newState = new WalkerState(this, _translation, _req);
+    newState->lookupTick = lookup_tick;
     newState->initState(_tc, _mode, sys->isTimingMode());
-    if (currStates.size()) {
+    if (currStates.size() >= maxWalks) {
         assert(newState->isTiming());
         DPRINTF(PageTableWalker, "Walks in progress: %d\n", currStates.size());
         currStates.push_back(newState);
@@ -121,6 +125,8 @@ Walker::recvTimingResp(PacketPtr pkt)
                 break;
             }
         }
+        portWaiters.erase(std::remove(portWaiters.begin(), portWaiters.end(),
+                                      senderWalk), portWaiters.end());
         delete senderWalk;
         // Since we block requests when another is outstanding, we
         // need to check if there is a waiting request to be serviced
@@ -141,15 +147,26 @@ Walker::WalkerPort::recvReqRetry()
 void
 Walker::recvReqRetry()
 {
-    std::list<WalkerState *>::iterator iter;
-    for (iter = currStates.begin(); iter != currStates.end(); iter++) {
-        WalkerState * walkerState = *(iter);
-        if (walkerState->isRetrying()) {
-            walkerState->retry();
-        }
+    // Resume the waiting walks one at a time, in the order they had to
+    // wait, until the port refuses a packet again
+    portBlocked = false;
+    while (!portBlocked && !portWaiters.empty()) {
+        WalkerState *walkerState = portWaiters.front();
+        portWaiters.pop_front();
+        walkerState->retry();
     }
 }
 
+void
+Walker::waitForPort(WalkerState *state, bool refused)
+{
+    portBlocked = true;
+    if (refused)
+        portWaiters.push_front(state);
+    else
+        portWaiters.push_back(state);
+}
+
 bool Walker::sendTiming(WalkerState* sendingState, PacketPtr pkt)
 {
     WalkerSenderState* walker_state = new WalkerSenderState(sendingState);
@@ -195,37 +212,43 @@ void
 Walker::startWalkWrapper()
 {
     unsigned num_squashed = 0;
-    WalkerState *currState = currStates.front();
-    while ((num_squashed < numSquashable) && currState &&
-        currState->translation->squashed()) {
-        currStates.pop_front();
-        num_squashed++;
-
-        DPRINTF(PageTableWalker, "Squashing table walk for address %#x\n",
-            currState->req->getVaddr());
-
-        // finish the translation which will delete the translation object
-        currState->translation->finish(
-            std::make_shared<UnimpFault>("Squashed Inst"),
-            currState->req, currState->tc, currState->mode);
-
-        // delete the current request if there are no inflight packets.
-        // if there is something in flight, delete when the packets are
-        // received and inflight is zero.
-        if (currState->numInflight() == 0) {
-            delete currState;
-        } else {
-            currState->squash();
+    unsigned active = 0;
+    auto iter = currStates.begin();
+    while (iter != currStates.end() && active < maxWalks) {
+        WalkerState *currState = *iter;
+        if (currState->wasStarted()) {
+            active++;
+            iter++;
+            continue;
+        }
+        if (num_squashed < numSquashable &&
+            currState->translation->squashed()) {
+            iter = currStates.erase(iter);
+            num_squashed++;
+
+            DPRINTF(PageTableWalker, "Squashing table walk for address %#x\n",
+                currState->req->getVaddr());
+
+            // finish the translation which will delete the translation
+            // object
+            currState->translation->finish(
+                std::make_shared<UnimpFault>("Squashed Inst"),
+                currState->req, currState->tc, currState->mode);
+
+            // delete the current request if there are no inflight packets.
+            // if there is something in flight, delete when the packets are
+            // received and inflight is zero.
+            if (currState->numInflight() == 0) {
+                delete currState;
+            } else {
+                currState->squash();
+            }
+            continue;
         }
-
-        // check the next translation request, if it exists
-        if (currStates.size())
-            currState = currStates.front();
-        else
-            currState = NULL;
-    }
-    if (currState && !currState->wasStarted())
         currState->startWalk();
+        active++;
+        iter++;
+    }
 }
 
 Fault
@@ -242,7 +265,7 @@ Walker::WalkerState::startWalk()
         sendPackets();
     } else {
         do {
-            walker->port.sendAtomic(read);
+            walker->sendAtomicRead(read);
             PacketPtr write = NULL;
             fault = stepWalk(write);
             assert(fault == NoFault || read == NULL);
@@ -266,7 +289,8 @@ Walker::WalkerState::startFunctional(Addr &addr, unsigned &logBytes)
     setupWalk(addr);
 
     do {
-        walker->port.sendFunctional(read);
+        if (!walker->readBackdoor(read))
+            walker->port.sendFunctional(read);
         // On a functional access (page table lookup), writes should
         // not happen so this pointer is ignored after stepWalk
         PacketPtr write = NULL;
@@ -287,7 +311,7 @@ Walker::WalkerState::stepWalk(PacketPtr &write)
     assert(state != Ready && state != Waiting);
     Fault fault = NoFault;
     write = NULL;
-    PTESv39 pte = read->getLE<uint64_t>();
+    PTESv39 pte = readPte();
     Addr nextRead = 0;
     bool doWrite = false;
     bool doTLBInsert = false;
@@ -373,19 +397,36 @@ Walker::WalkerState::stepWalk(PacketPtr &write)
         // value back to memory.
         if (!functional && doWrite) {
             DPRINTF(PageTableWalker, "Writing level%d PTE to %#x: %#x\n",
-                level, oldRead->getAddr(), pte);
-            write = oldRead;
+                level, pteAddr, pte);
+            if (oldRead->getSize() == sizeof(pte)) {
+                write = oldRead;
+                write->cmd = MemCmd::WriteReq;
+                read = NULL;
+            } else {
+                // Only write back the PTE of a line read
+                RequestPtr request = std::make_shared<Request>(
+                    pteAddr, sizeof(pte), flags, walker->requestorId);
+                write = new Packet(request, MemCmd::WriteReq);
+                write->allocate();
+            }
             write->setLE<uint64_t>(pte);
-            write->cmd = MemCmd::WriteReq;
-            read = NULL;
         } else {
             write = NULL;
         }
 
         if (doTLBInsert) {
-            if (!functional)
+            const bool coalesce = walker->tlb->coalescePages() > 1;
+            if (!functional && level == 0 &&
+                (coalesce || walker->neighborFill)) {
+                const std::vector<uint64_t> line = readLine(oldRead, flags);
+                const uint16_t coalesced =
+                    coalesce ? coalesceMask(line, pte) : 0;
+                walker->tlb->insert(entry.vaddr, entry, coalesced);
+                if (walker->neighborFill)
+                    fillNeighbors(line, coalesced);
+            } else if (!functional) {
                 walker->tlb->insert(entry.vaddr, entry);
-            else {
+            } else {
                 DPRINTF(PageTableWalker, "Translated %#x -> %#x\n",
                         entry.vaddr, entry.paddr << PageShift |
                         (entry.vaddr & mask(entry.logBytes)));
@@ -395,8 +436,15 @@ Walker::WalkerState::stepWalk(PacketPtr &write)
     }
     else {
         //If we didn't return, we're setting up another read.
+        pteAddr = nextRead;
+        unsigned size = sizeof(pte);
+        if (level == 0 && walker->neighborFill) {
+            // Level 0 PTEs are leaves, fetch their whole line
+            size = walker->sys->cacheLineSize();
+            nextRead &= ~Addr(size - 1);
+        }
         RequestPtr request = std::make_shared<Request>(
-            nextRead, oldRead->getSize(), flags, walker->requestorId);
+            nextRead, size, flags, walker->requestorId);
         read = new Packet(request, MemCmd::ReadReq);
         read->allocate();
 
@@ -433,6 +481,7 @@ Walker::WalkerState::setupWalk(Addr vaddr)
     entry.vaddr = vaddr;
     entry.asid = satp.asid;
 
+    pteAddr = topAddr;
     Request::Flags flags = Request::PHYSICAL;
     RequestPtr request = std::make_shared<Request>(
         topAddr, sizeof(PTESv39), flags, walker->requestorId);
@@ -477,6 +526,12 @@ Walker::WalkerState::recvPacket(PacketPtr pkt)
     if (inflight == 0 && read == NULL && writes.size() == 0) {
         state = Ready;
         nextState = Waiting;
+        if (lookupTick != MaxTick) {
+            walker->tlb->probeAccess(
+                req->getVaddr() & ((static_cast<Addr>(1) << VADDR_BITS) - 1),
+                satp.asid, mode, timingFault == NoFault ? entry.logBytes : 0,
+                false, lookupTick);
+        }
         if (timingFault == NoFault) {
             /*
              * Finish the translation. Now that we know the right entry is
@@ -502,6 +557,220 @@ Walker::WalkerState::recvPacket(PacketPtr pkt)
     return false;
 }
 
+PTESv39
+Walker::WalkerState::readPte() const
+{
+    if (read->getSize() == sizeof(PTESv39))
+        return read->getLE<uint64_t>();
+    const uint64_t *ptes = read->getConstPtr<uint64_t>();
+    return letoh(ptes[(pteAddr - read->getAddr()) / sizeof(PTESv39)]);
+}
+
+int
+Walker::WalkerState::lineSlot() const
+{
+    return (pteAddr & (walker->sys->cacheLineSize() - 1)) / sizeof(PTESv39);
+}
+
+std::vector<uint64_t>
+Walker::WalkerState::readLine(PacketPtr pkt, Request::Flags flags)
+{
+    const unsigned line_bytes = walker->sys->cacheLineSize();
+    std::vector<uint64_t> line(line_bytes / sizeof(uint64_t));
+
+    if (pkt->isRead() && pkt->getSize() == line_bytes) {
+        pkt->writeData(reinterpret_cast<uint8_t *>(line.data()));
+    } else {
+        // The walker only read the PTE, but the rest of its cache line
+        // arrived with it, so look it up without timing the access.
+        RequestPtr request = std::make_shared<Request>(
+            pteAddr & ~Addr(line_bytes - 1), line_bytes, flags,
+            walker->requestorId);
+        Packet pkt(request, MemCmd::ReadReq);
+        pkt.dataStatic(line.data());
+        if (!walker->readBackdoor(&pkt))
+            walker->port.sendFunctional(&pkt);
+    }
+
+    for (auto &pte : line)
+        pte = letoh(pte);
+    return line;
+}
+
+uint16_t
+Walker::WalkerState::coalesceMask(const std::vector<uint64_t> &line,
+                                  PTESv39 pte)
+{
+    const unsigned pages = walker->tlb->coalescePages();
+    const int page = (entry.vaddr >> PageShift) & (pages - 1);
+    const int slot = lineSlot();
+    uint16_t coalesced = 1 << page;
+    for (int j = 0; j < (int)pages; j++) {
+        const int s = slot + j - page;
+        if (j == page || s < 0 || s >= (int)line.size())
+            continue;
+        // Equal V/R/W/X/U/G/A/D bits: the neighbour is a valid leaf with
+        // the same permissions that has already been accessed (and
+        // written if pte was).
+        PTESv39 other = line[s];
+        if (bits(other, 7, 0) == bits(pte, 7, 0) &&
+            other.ppn == pte.ppn + j - page) {
+            coalesced |= 1 << j;
+        }
+    }
+
+    DPRINTF(PageTableWalker, "Coalescing mask for %#x: %#x\n",
+            entry.vaddr, coalesced);
+    return coalesced;
+}
+
+void
+Walker::WalkerState::fillNeighbors(const std::vector<uint64_t> &line,
+                                   uint16_t coalesced)
+{
+    const unsigned pages = walker->tlb->coalescePages();
+    const int slot = lineSlot();
+    for (int s = 0; s < (int)line.size(); s++) {
+        PTESv39 pte = line[s];
+        // Only valid leaves whose accessed bit is already set may be
+        // cached without walking them.
+        if (s == slot || !pte.v || !(pte.r || pte.x) || (!pte.r && pte.w) ||
+            !pte.a) {
+            continue;
+        }
+
+        TlbEntry neighbor = entry;
+        neighbor.vaddr = entry.vaddr + (s - slot) * (int64_t)PageBytes;
+        neighbor.paddr = pte.ppn;
+        neighbor.logBytes = PageShift;
+        neighbor.pte = pte;
+        // Writes to clean pages walk again to set the dirty bit
+        if (!pte.d)
+            neighbor.pte.w = 0;
+
+        const Addr vpn = neighbor.vaddr >> PageShift;
+        if ((vpn / pages) == (entry.vaddr >> PageShift) / pages &&
+            bits(coalesced, vpn & (pages - 1))) {
+            continue;
+        }
+
+        DPRINTF(PageTableWalker, "Neighbouring PTE %#x -> %#x\n",
+                neighbor.vaddr, neighbor.paddr << PageShift);
+        walker->stats.neighborPtes++;
+        if (walker->pteBufferEntries)
+            walker->bufferPte(neighbor);
+        else
+            walker->tlb->insertPrefetch(neighbor);
+    }
+}
+
+void
+Walker::bufferPte(const TlbEntry &entry)
+{
+    for (auto &buffered : pteBuffer) {
+        if (buffered.vaddr == entry.vaddr && buffered.asid == entry.asid) {
+            buffered = entry;
+            return;
+        }
+    }
+    if (pteBuffer.size() == pteBufferEntries) {
+        pteBuffer.pop_front();
+        stats.pteBufferUnused++;
+    }
+    pteBuffer.push_back(entry);
+    stats.pteBufferFills++;
+}
+
+bool
+Walker::takeBufferedPte(Addr vaddr, uint16_t asid, TlbEntry &entry)
+{
+    vaddr &= ~mask(PageShift);
+    for (auto it = pteBuffer.begin(); it != pteBuffer.end(); it++) {
+        if (it->vaddr == vaddr && it->asid == asid) {
+            entry = *it;
+            pteBuffer.erase(it);
+            stats.pteBufferHits++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+Walker::demapPteBuffer(Addr vaddr, uint16_t asid)
+{
+    vaddr &= ~mask(PageShift);
+    for (auto it = pteBuffer.begin(); it != pteBuffer.end();) {
+        if ((vaddr == 0 || it->vaddr == vaddr) &&
+            (asid == 0 || it->asid == asid)) {
+            it = pteBuffer.erase(it);
+            stats.pteBufferUnused++;
+        } else {
+            it++;
+        }
+    }
+}
+
+Walker::WalkerStats::WalkerStats(Stats::Group *parent)
+  : Stats::Group(parent),
+    ADD_STAT(neighborPtes, UNIT_COUNT,
+             "Valid leaf PTEs read along with a walked 4KiB PTE"),
+    ADD_STAT(pteBufferFills, UNIT_COUNT,
+             "Neighbouring PTEs staged in the PTE buffer"),
+    ADD_STAT(pteBufferHits, UNIT_COUNT,
+             "TLB misses served from the PTE buffer without a walk"),
+    ADD_STAT(pteBufferUnused, UNIT_COUNT,
+             "Buffered PTEs replaced or demapped without a hit"),
+    ADD_STAT(backdoorReads, UNIT_COUNT,
+             "PTE reads served from a memory backdoor")
+{
+}
+
+bool
+Walker::readBackdoor(PacketPtr pkt)
+{
+    // Timing CPUs may have left dirty lines in caches the backdoor skips
+    if (backdoors.empty() || !sys->isAtomicMode())
+        return false;
+
+    auto it = backdoors.contains(pkt->getAddrRange());
+    if (it == backdoors.end() || !it->second->readable())
+        return false;
+
+    const MemBackdoor &bd = *it->second;
+    pkt->setData(bd.ptr() + (pkt->getAddr() - bd.range().start()));
+    pkt->makeResponse();
+    stats.backdoorReads++;
+    return true;
+}
+
+Tick
+Walker::sendAtomicRead(PacketPtr pkt)
+{
+    if (!useBackdoor)
+        return port.sendAtomic(pkt);
+    if (readBackdoor(pkt))
+        return 0;
+
+    // Memory only hands out a backdoor if no cache is in the way
+    MemBackdoorPtr bd = nullptr;
+    Tick latency = port.sendAtomicBackdoor(pkt, bd);
+    if (bd && backdoors.insert(bd->range(), bd) != backdoors.end()) {
+        auto callback = [this](const MemBackdoor &backdoor) {
+                for (auto it = backdoors.begin(); it != backdoors.end();
+                        it++) {
+                    if (it->second == &backdoor) {
+                        backdoors.erase(it);
+                        return;
+                    }
+                }
+                panic("Got invalidation for unknown memory backdoor.");
+            };
+        bd->addInvalidationCallback(callback);
+    }
+    return latency;
+}
+
 void
 Walker::WalkerState::sendPackets()
 {
@@ -509,6 +778,15 @@ Walker::WalkerState::sendPackets()
     if (retrying)
         return;
 
+    // Walks share the port, so wait behind another walk the port refused
+    if (walker->portBlocked) {
+        if (read || writes.size()) {
+            retrying = true;
+            walker->waitForPort(this, false);
+        }
+        return;
+    }
+
     //Reads always have priority
     if (read) {
         PacketPtr pkt = read;
@@ -516,6 +794,7 @@ Walker::WalkerState::sendPackets()
         inflight++;
         if (!walker->sendTiming(this, pkt)) {
             retrying = true;
+            walker->waitForPort(this, true);
             read = pkt;
             inflight--;
             return;
@@ -528,6 +807,7 @@ Walker::WalkerState::sendPackets()
         inflight++;
         if (!walker->sendTiming(this, write)) {
             retrying = true;
+            walker->waitForPort(this, true);
             writes.push_back(write);
             inflight--;
             return;
@@ -39,12 +39,16 @@
 #ifndef __ARCH_RISCV_TABLE_WALKER_HH__
 #define __ARCH_RISCV_TABLE_WALKER_HH__
 
+#include <deque>
 #include <vector>
 
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/pma_checker.hh"
 #include "arch/riscv/tlb.hh"
+#include "base/addr_range_map.hh"
+#include "base/statistics.hh"
 #include "base/types.hh"
+#include "mem/backdoor.hh"
 #include "mem/packet.hh"
 #include "params/RiscvPagetableWalker.hh"
 #include "sim/clocked_object.hh"
@@ -96,6 +100,8 @@ namespace RiscvISA
             int level;
             unsigned inflight;
             TlbEntry entry;
+            // Address of the PTE read, which may cover its whole line
+            Addr pteAddr;
             PacketPtr read;
             std::vector<PacketPtr> writes;
             Fault timingFault;
@@ -109,6 +115,9 @@ namespace RiscvISA
             bool retrying;
             bool started;
             bool squashed;
+            // When the TLB lookup that missed and caused this walk
+            // happened (MaxTick: the walk is not reported to the TLB)
+            Tick lookupTick;
           public:
             WalkerState(Walker * _walker, BaseTLB::Translation *_translation,
                         const RequestPtr &_req, bool _isFunctional = false) :
@@ -116,7 +125,8 @@ namespace RiscvISA
                 nextState(Ready), level(0), inflight(0),
                 translation(_translation),
                 functional(_isFunctional), timing(false),
-                retrying(false), started(false), squashed(false)
+                retrying(false), started(false), squashed(false),
+                lookupTick(curTick())
             {
             }
             void initState(ThreadContext * _tc, BaseTLB::Mode _mode,
@@ -135,6 +145,28 @@ namespace RiscvISA
           private:
             void setupWalk(Addr vaddr);
             Fault stepWalk(PacketPtr &write);
+            PTESv39 readPte() const;
+            /**
+             * The PTEs in the cache line of the leaf PTE, from pkt if it
+             * read the line and a functional read if not.
+             */
+            std::vector<uint64_t> readLine(PacketPtr pkt,
+                                           Request::Flags flags);
+            /** Index of the walked PTE within its cache line. */
+            int lineSlot() const;
+            /**
+             * Pages of the TLB coalescing group of the walked 4KiB page
+             * whose PTEs in line continue the mapping of pte with the
+             * same flags.
+             */
+            uint16_t coalesceMask(const std::vector<uint64_t> &line,
+                                  PTESv39 pte);
+            /**
+             * Install (or buffer) the valid, accessed leaf PTEs in line
+             * other than the walked one and the coalesced pages.
+             */
+            void fillNeighbors(const std::vector<uint64_t> &line,
+                               uint16_t coalesced);
             void sendPackets();
             void endWalk();
             Fault pageFault(bool present);
@@ -155,9 +187,11 @@ namespace RiscvISA
         };
 
       public:
-        // Kick off the state machine.
+        // Kick off the state machine. A timing walk reports the miss
+        // looked up at lookup_tick to the TLB when it ends.
         Fault start(ThreadContext * _tc, BaseTLB::Translation *translation,
-                const RequestPtr &req, BaseTLB::Mode mode);
+                const RequestPtr &req, BaseTLB::Mode mode,
+                Tick lookup_tick = MaxTick);
         Fault startFunctional(ThreadContext * _tc, Addr &addr,
                 unsigned &logBytes, BaseTLB::Mode mode);
         Port &getPort(const std::string &if_name,
@@ -173,6 +207,49 @@ namespace RiscvISA
         // The number of outstanding walks that can be squashed per cycle.
         unsigned numSquashable;
 
+        // The number of timing walks that may be in progress at once,
+        // later walks wait in currStates until one of them ends.
+        unsigned maxWalks;
+
+        // The port refused a packet and no walk may send until it asks
+        // for a retry. The walks with packets to send wait in order.
+        bool portBlocked;
+        std::deque<WalkerState *> portWaiters;
+
+        // Read whole lines of leaf PTEs and fill the TLB from neighbours
+        const bool neighborFill;
+        // Neighbouring translations staged for later TLB misses (FIFO)
+        const unsigned pteBufferEntries;
+        std::deque<TlbEntry> pteBuffer;
+
+        // Read PTEs of atomic and functional walks through the backdoors
+        // memory hands out to atomic walks
+        const bool useBackdoor;
+        AddrRangeMap<MemBackdoorPtr, 1> backdoors;
+
+        struct WalkerStats : public Stats::Group
+        {
+            WalkerStats(Stats::Group *parent);
+
+            Stats::Scalar neighborPtes;
+            Stats::Scalar pteBufferFills;
+            Stats::Scalar pteBufferHits;
+            Stats::Scalar pteBufferUnused;
+            Stats::Scalar backdoorReads;
+        } stats;
+
+        void bufferPte(const TlbEntry &entry);
+
+        /**
+         * Satisfy the PTE read pkt from a memory backdoor instead of
+         * sending it, if one covers it and the system is in atomic mode.
+         * A/D bit updates are always sent as packets so that other
+         * requestors observe them.
+         */
+        bool readBackdoor(PacketPtr pkt);
+        /** Send an atomic PTE read, asking memory for a backdoor. */
+        Tick sendAtomicRead(PacketPtr pkt);
+
         // Wrapper for checking for squashes before starting a translation.
         void startWalkWrapper();
 
@@ -185,6 +262,12 @@ namespace RiscvISA
         bool recvTimingResp(PacketPtr pkt);
         void recvReqRetry();
         bool sendTiming(WalkerState * sendingState, PacketPtr pkt);
+        /**
+         * Block the port until the next retry and queue state to resume
+         * then. A walk the port refused resumes before those that only
+         * found it blocked.
+         */
+        void waitForPort(WalkerState *state, bool refused);
 
       public:
 
@@ -193,6 +276,17 @@ namespace RiscvISA
             tlb = _tlb;
         }
 
+        /** Let up to n timing walks proceed in parallel (the TLB MSHRs). */
+        void setMaxWalks(unsigned n) { maxWalks = n; }
+
+        /**
+         * Move the buffered translation of the 4KiB page of vaddr to
+         * entry, if the PTE buffer holds one.
+         */
+        bool takeBufferedPte(Addr vaddr, uint16_t asid, TlbEntry &entry);
+        /** Drop buffered translations like TLB::demap() drops entries. */
+        void demapPteBuffer(Addr vaddr, uint16_t asid);
+
         using Params = RiscvPagetableWalkerParams;
 
         Walker(const Params &params) :
@@ -200,9 +294,16 @@ namespace RiscvISA
             funcState(this, NULL, NULL, true), tlb(NULL), sys(params.system),
             pma(params.pma_checker),
             requestorId(sys->getRequestorId(this)),
-            numSquashable(params.num_squash_per_cycle),
+            numSquashable(params.num_squash_per_cycle), maxWalks(1),
+            portBlocked(false),
+            neighborFill(params.neighbor_fill),
+            pteBufferEntries(params.pte_buffer_entries),
+            useBackdoor(params.backdoor), stats(this),
             startWalkWrapperEvent([this]{ startWalkWrapper(); }, name())
         {
+            fatal_if(pteBufferEntries && !neighborFill,
+                     "%s: The PTE buffer is only filled with neighbor_fill.\n",
+                     name());
         }
     };
 }
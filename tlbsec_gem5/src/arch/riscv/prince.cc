@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arch/riscv/prince.hh"
+
+namespace RiscvISA
+{
+
+const uint64_t Prince::rowMask;
+
+const uint32_t Prince::m0[16] = {
+    0x0111, 0x2220, 0x4404, 0x8088,
+    0x1011, 0x0222, 0x4440, 0x8808,
+    0x1101, 0x2022, 0x0444, 0x8880,
+    0x1110, 0x2202, 0x4044, 0x0888
+};
+
+const uint32_t Prince::m1[16] = {
+    0x1110, 0x2202, 0x4044, 0x0888,
+    0x0111, 0x2220, 0x4404, 0x8088,
+    0x1011, 0x0222, 0x4440, 0x8808,
+    0x1101, 0x2022, 0x0444, 0x8880
+};
+
+const uint64_t Prince::rc[12] = {
+    0x0000000000000000, 0x13198a2e03707344,
+    0xa4093822299f31d0, 0x082efa98ec4e6c89,
+    0x452821e638d01377, 0xbe5466cf34e90c6c,
+    0x7ef84f78fd955cb1, 0x85840851f1ac43aa,
+    0xc882d32f25323c54, 0x64a51195e0e3610d,
+    0xd3b5a399ca0c2399, 0xc0ac29b7c97c50dd
+};
+
+Prince::Tables::Tables()
+{
+    for (unsigned b = 0; b < 256; b++) {
+        sbox[b] = Prince::sbox(b) | (Prince::sbox(b >> 4) << 4);
+        sboxInv[b] = Prince::sboxInv(b) | (Prince::sboxInv(b >> 4) << 4);
+        // The M' matrices are linear over GF(2), so the product of a
+        // 16 bit column is the XOR of the products of its two bytes.
+        for (unsigned half = 0; half < 2; half++) {
+            m0[half][b] = gf2Mul16(b << (8 * half), Prince::m0);
+            m1[half][b] = gf2Mul16(b << (8 * half), Prince::m1);
+        }
+    }
+}
+
+const Prince::Tables Prince::tables;
+
+} // namespace RiscvISA
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * The PRINCE block cipher used to compute the randomized per-way set
+ * indices of the TLB. It has no simulator dependencies so that standalone
+ * tools (tlbsim, the functional eviction-set engine) index exactly like
+ * the simulated TLB.
+ */
+
+#ifndef __ARCH_RISCV_PRINCE_HH__
+#define __ARCH_RISCV_PRINCE_HH__
+
+#include <cstdint>
+
+namespace RiscvISA
+{
+
+class Prince
+{
+  private:
+    static const uint32_t m0[16];
+    static const uint32_t m1[16];
+    // Round constants RC0 to RC11, RC(i) ^ RC(11 - i) is alpha
+    static const uint64_t rc[12];
+    static const uint64_t rowMask = UINT64_C(0xF000F000F000F000);
+
+    // Byte-wide lookup tables for the S-layers and the M'-layer, built
+    // once from the nibble S-boxes and the M' matrices so a block is
+    // transformed with eight loads per layer.
+    struct Tables
+    {
+        uint8_t sbox[256];
+        uint8_t sboxInv[256];
+        uint16_t m0[2][256];
+        uint16_t m1[2][256];
+        Tables();
+    };
+    static const Tables tables;
+
+    static uint8_t
+    sbox(uint8_t index)
+    {
+        static const uint8_t sbox[] = {
+            0xB, 0xF, 0x3, 0x2, 0xA, 0xC, 0x9, 0x1,
+            0x6, 0x7, 0x8, 0x0, 0xE, 0x5, 0xD, 0x4
+        };
+        return sbox[index & 0xF];
+    }
+
+    static uint8_t
+    sboxInv(uint8_t index)
+    {
+        static const uint8_t sbox_inv[] = {
+            0xB, 0x7, 0x3, 0x2, 0xF, 0xD, 0x8, 0x9,
+            0xA, 0x6, 0x4, 0x0, 0x5, 0xE, 0xC, 0x1
+        };
+        return sbox_inv[index & 0xF];
+    }
+
+    static uint64_t
+    gf2Mul16(uint64_t in, const uint32_t mat[16])
+    {
+        uint64_t out = 0;
+        for (unsigned i = 0; i < 16; i++) {
+            if ((in >> i) & 1)
+                out ^= mat[i];
+        }
+        return out;
+    }
+
+    static uint64_t
+    mPrimeLayer(uint64_t in)
+    {
+        const Tables &t = tables;
+        const uint64_t out_0 = t.m0[0][in & 0xFF] ^
+                               t.m0[1][(in >> 8) & 0xFF];
+        const uint64_t out_1 = t.m1[0][(in >> 16) & 0xFF] ^
+                               t.m1[1][(in >> 24) & 0xFF];
+        const uint64_t out_2 = t.m1[0][(in >> 32) & 0xFF] ^
+                               t.m1[1][(in >> 40) & 0xFF];
+        const uint64_t out_3 = t.m0[0][(in >> 48) & 0xFF] ^
+                               t.m0[1][(in >> 56) & 0xFF];
+        return (out_3 << 48) | (out_2 << 32) | (out_1 << 16) | out_0;
+    }
+
+    static uint64_t
+    shiftRows(uint64_t in, bool inverse)
+    {
+        uint64_t out = 0;
+        for (unsigned i = 0; i < 4; ++i) {
+            const uint64_t row = in & (rowMask >> (4 * i));
+            const unsigned shift = inverse ? i * 16 : 64 - i * 16;
+            out |= (row >> shift) | (row << (64 - shift));
+        }
+        return out;
+    }
+
+    static uint64_t
+    sLayer(uint64_t in, const uint8_t table[256])
+    {
+        uint64_t out = 0;
+        for (unsigned i = 0; i < 64; i += 8)
+            out |= uint64_t(table[(in >> i) & 0xFF]) << i;
+        return out;
+    }
+
+    static uint64_t
+    mLayer(uint64_t in)
+    {
+        return shiftRows(mPrimeLayer(in), false);
+    }
+
+    static uint64_t
+    mInvLayer(uint64_t in)
+    {
+        return mPrimeLayer(shiftRows(in, true));
+    }
+
+  public:
+    /** Encrypt a 64 bit block with the reduced-round PRINCE variant. */
+    static uint64_t
+    encrypt(uint64_t input, uint64_t key)
+    {
+        uint64_t output = input;
+        // PRINCE Round 1
+        output ^= key;
+        output ^= 0x13198a2e03707344; // RC1
+        output = sLayer(mLayer(output), tables.sboxInv);
+
+        // PRINCE Round 2
+        output ^= key;
+        output ^= 0xa4093822299f31d0; // RC2
+        output = sLayer(mLayer(output), tables.sbox);
+
+        output ^= key;
+
+        // PRINCE Round 3
+        return mPrimeLayer(sLayer(output, tables.sbox));
+    }
+
+    /**
+     * Encrypt a 64 bit block with the PRINCE core reduced to rounds
+     * rounds (an even number from 2 to 12; 12 is standard PRINCE). The
+     * core keeps the same number of rounds on both sides of the middle
+     * layer, so decryption is still encryption with k1 ^ alpha.
+     *
+     * @param k0 Whitening key
+     * @param k1 Core key
+     */
+    static uint64_t
+    encrypt(uint64_t input, uint64_t k0, uint64_t k1, unsigned rounds)
+    {
+        const Tables &t = tables;
+        const unsigned half = rounds / 2 - 1;
+        const uint64_t k0_prime = ((k0 >> 1) | (k0 << 63)) ^ (k0 >> 63);
+
+        uint64_t state = input ^ k0 ^ k1 ^ rc[0];
+        for (unsigned i = 1; i <= half; i++)
+            state = mLayer(sLayer(state, t.sbox)) ^ rc[i] ^ k1;
+        state = sLayer(mPrimeLayer(sLayer(state, t.sbox)), t.sboxInv);
+        for (unsigned i = 11 - half; i <= 10; i++)
+            state = sLayer(mInvLayer(state ^ rc[i] ^ k1), t.sboxInv);
+        return state ^ rc[11] ^ k1 ^ k0_prime;
+    }
+
+    /**
+     * Compute the set index of an address in each way. Every way takes
+     * the next set_bits bits of the cipher output; when a block runs out
+     * of bits it is encrypted again with a tweaked key.
+     *
+     * @param va Address (or page number) to index
+     * @param key Cipher key, including any per-process tweak
+     * @param ways Number of ways to compute an index for
+     * @param set_bits log2 of the number of sets
+     * @param set_arr Output, one index per way
+     */
+    static void
+    wayIndices(uint64_t va, uint64_t key, unsigned ways, unsigned set_bits,
+               uint64_t *set_arr)
+    {
+        const uint64_t set_mask = (UINT64_C(1) << set_bits) - 1;
+        uint64_t randomization = encrypt(va, key);
+        unsigned used = 0;
+        uint64_t block = 0;
+        for (unsigned i = 0; i < ways; i++) {
+            if (used + set_bits > 64) {
+                block++;
+                randomization = encrypt(va,
+                        key ^ (block * UINT64_C(0x9e3779b97f4a7c15)));
+                used = 0;
+            }
+            set_arr[i] = (randomization >> used) & set_mask;
+            used += set_bits;
+        }
+    }
+};
+
+} // namespace RiscvISA
+
+#endif // __ARCH_RISCV_PRINCE_HH__
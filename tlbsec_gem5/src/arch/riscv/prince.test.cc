@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "arch/riscv/prince.hh"
+
+using namespace RiscvISA;
+
+/*
+ * The test vectors of the PRINCE paper (Borghoff et al., ASIACRYPT 2012,
+ * Appendix A): plaintext, k0, k1 and ciphertext of the 12 round cipher.
+ */
+TEST(PrinceTest, PaperVectors)
+{
+    struct Vector
+    {
+        uint64_t plaintext;
+        uint64_t k0;
+        uint64_t k1;
+        uint64_t ciphertext;
+    };
+    const Vector vectors[] = {
+        {UINT64_C(0x0000000000000000), UINT64_C(0x0000000000000000),
+         UINT64_C(0x0000000000000000), UINT64_C(0x818665aa0d02dfda)},
+        {UINT64_C(0xffffffffffffffff), UINT64_C(0x0000000000000000),
+         UINT64_C(0x0000000000000000), UINT64_C(0x604ae6ca03c20ada)},
+        {UINT64_C(0x0000000000000000), UINT64_C(0xffffffffffffffff),
+         UINT64_C(0x0000000000000000), UINT64_C(0x9fb51935fc3df524)},
+        {UINT64_C(0x0000000000000000), UINT64_C(0x0000000000000000),
+         UINT64_C(0xffffffffffffffff), UINT64_C(0x78a54cbe737bb7ef)},
+        {UINT64_C(0x0123456789abcdef), UINT64_C(0x0000000000000000),
+         UINT64_C(0xfedcba9876543210), UINT64_C(0xae25ad3ca8fa9ccf)},
+    };
+
+    for (const Vector &v : vectors) {
+        EXPECT_EQ(v.ciphertext, Prince::encrypt(v.plaintext, v.k0, v.k1, 12))
+            << std::hex << "plaintext " << v.plaintext;
+    }
+}
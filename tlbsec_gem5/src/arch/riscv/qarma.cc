@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arch/riscv/qarma.hh"
+
+namespace RiscvISA
+{
+
+const uint64_t Qarma::alpha;
+const unsigned Qarma::MaxRounds;
+
+const uint8_t Qarma::tau[16] = {
+    0, 11, 6, 13, 10, 1, 12, 7, 5, 14, 3, 8, 15, 4, 9, 2
+};
+
+const uint8_t Qarma::tauInv[16] = {
+    0, 5, 15, 10, 13, 8, 2, 7, 11, 14, 4, 1, 6, 3, 9, 12
+};
+
+const uint8_t Qarma::h[16] = {
+    6, 5, 14, 15, 0, 1, 2, 3, 7, 12, 13, 4, 8, 9, 10, 11
+};
+
+const uint8_t Qarma::hInv[16] = {
+    4, 5, 6, 7, 11, 1, 0, 8, 12, 13, 14, 15, 9, 10, 2, 3
+};
+
+const uint8_t Qarma::sigma[16] = {
+    10, 13, 14, 6, 15, 7, 3, 5, 9, 8, 0, 12, 11, 1, 2, 4
+};
+
+const uint64_t Qarma::c[8] = {
+    0x0000000000000000, 0x13198A2E03707344,
+    0xA4093822299F31D0, 0x082EFA98EC4E6C89,
+    0x452821E638D01377, 0xBE5466CF34E90C6C,
+    0x3F84D5B5B5470917, 0x9216D5D98979FB1B
+};
+
+// Cells of the tweak that go through the LFSR omega
+static const unsigned lfsrCells[] = {0, 1, 3, 4, 8, 11, 13};
+
+uint64_t
+Qarma::mixColumns(uint64_t x)
+{
+    // circ(0, rho, rho^2, rho), rho rotating a cell left by one bit
+    static const unsigned rot[4] = {0, 1, 2, 1};
+    uint64_t out = 0;
+    for (unsigned row = 0; row < 4; row++) {
+        for (unsigned col = 0; col < 4; col++) {
+            unsigned v = 0;
+            for (unsigned j = 0; j < 4; j++) {
+                const unsigned r = rot[(j + 4 - row) % 4];
+                const unsigned in = cell(x, 4 * j + col);
+                if (r)
+                    v ^= ((in << r) | (in >> (4 - r))) & 0xF;
+            }
+            out |= uint64_t(v) << (60 - 4 * (4 * row + col));
+        }
+    }
+    return out;
+}
+
+uint64_t
+Qarma::updateTweak(uint64_t t)
+{
+    t = permute(t, h);
+    for (unsigned i : lfsrCells) {
+        // (b3, b2, b1, b0) -> (b0 ^ b1, b3, b2, b1)
+        const unsigned b = cell(t, i);
+        const unsigned v = (((b ^ (b >> 1)) & 1) << 3) | (b >> 1);
+        t ^= uint64_t(b ^ v) << (60 - 4 * i);
+    }
+    return t;
+}
+
+uint64_t
+Qarma::updateTweakInv(uint64_t t)
+{
+    for (unsigned i : lfsrCells) {
+        const unsigned b = cell(t, i);
+        const unsigned v = ((b << 1) & 0xF) | (((b >> 3) ^ b) & 1);
+        t ^= uint64_t(b ^ v) << (60 - 4 * i);
+    }
+    return permute(t, hInv);
+}
+
+Qarma::Tables::Tables()
+{
+    uint8_t inv[16];
+    for (unsigned i = 0; i < 16; i++)
+        inv[sigma[i]] = i;
+
+    for (unsigned b = 0; b < 256; b++) {
+        sbox[b] = sigma[b & 0xF] | (sigma[b >> 4] << 4);
+        sboxInv[b] = inv[b & 0xF] | (inv[b >> 4] << 4);
+        for (unsigned byte = 0; byte < 8; byte++) {
+            const uint64_t x = uint64_t(b) << (8 * byte);
+            forward[byte][b] = mixColumns(permute(x, tau));
+            backward[byte][b] = permute(mixColumns(x), tauInv);
+            reflect[byte][b] = permute(mixColumns(permute(x, tau)), tauInv);
+            tweakForward[byte][b] = updateTweak(x);
+            tweakBackward[byte][b] = updateTweakInv(x);
+        }
+    }
+}
+
+const Qarma::Tables Qarma::tables;
+
+} // namespace RiscvISA
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * The QARMA-64 tweakable block cipher, an alternative to PRINCE for
+ * computing the randomized per-way set indices of the TLB. Like
+ * prince.hh it has no simulator dependencies.
+ */
+
+#ifndef __ARCH_RISCV_QARMA_HH__
+#define __ARCH_RISCV_QARMA_HH__
+
+#include <cstdint>
+
+namespace RiscvISA
+{
+
+class Qarma
+{
+  private:
+    // Cell (nibble) permutations; cell 0 is the most significant nibble
+    static const uint8_t tau[16];
+    static const uint8_t tauInv[16];
+    static const uint8_t h[16];
+    static const uint8_t hInv[16];
+    // The sigma_1 S-box
+    static const uint8_t sigma[16];
+    static const uint64_t c[8];
+    static const uint64_t alpha = UINT64_C(0xC0AC29B7C97C50DD);
+
+    /**
+     * Byte-wide lookup tables. The S-box is applied to two cells per
+     * load, and every linear layer (the cell permutations, MixColumns
+     * and the tweak update) is the XOR of the images of the eight bytes
+     * of its input.
+     */
+    struct Tables
+    {
+        uint8_t sbox[256];
+        uint8_t sboxInv[256];
+        uint64_t forward[8][256];   // MixColumns(tau(x))
+        uint64_t backward[8][256];  // tauInv(MixColumns(x))
+        uint64_t reflect[8][256];   // tauInv(MixColumns(tau(x)))
+        uint64_t tweakForward[8][256];
+        uint64_t tweakBackward[8][256];
+        Tables();
+    };
+    static const Tables tables;
+
+    static unsigned
+    cell(uint64_t x, unsigned i)
+    {
+        return (x >> (60 - 4 * i)) & 0xF;
+    }
+
+    static uint64_t
+    permute(uint64_t x, const uint8_t perm[16])
+    {
+        uint64_t out = 0;
+        for (unsigned i = 0; i < 16; i++)
+            out |= uint64_t(cell(x, perm[i])) << (60 - 4 * i);
+        return out;
+    }
+
+    // Reference implementations the tables are built from
+    static uint64_t mixColumns(uint64_t x);
+    static uint64_t updateTweak(uint64_t t);
+    static uint64_t updateTweakInv(uint64_t t);
+
+    static uint64_t
+    linear(const uint64_t table[8][256], uint64_t x)
+    {
+        uint64_t out = 0;
+        for (unsigned i = 0; i < 8; i++)
+            out ^= table[i][(x >> (8 * i)) & 0xFF];
+        return out;
+    }
+
+    static uint64_t
+    sLayer(uint64_t in, const uint8_t table[256])
+    {
+        uint64_t out = 0;
+        for (unsigned i = 0; i < 64; i += 8)
+            out |= uint64_t(table[(in >> i) & 0xFF]) << i;
+        return out;
+    }
+
+  public:
+    /** Largest number of rounds on either side of the reflector. */
+    static const unsigned MaxRounds = 8;
+
+    /**
+     * Encrypt a 64 bit block with QARMA-64 using rounds forward and
+     * rounds backward rounds around the reflector (5 to 7 are the
+     * proposed variants, fewer trade security for latency).
+     *
+     * @param w0 Whitening key
+     * @param k0 Core key
+     */
+    static uint64_t
+    encrypt(uint64_t input, uint64_t tweak, uint64_t w0, uint64_t k0,
+            unsigned rounds)
+    {
+        const Tables &t = tables;
+        const uint64_t w1 = ((w0 >> 1) | (w0 << 63)) ^ (w0 >> 63);
+
+        uint64_t state = input ^ w0;
+        for (unsigned i = 0; i < rounds; i++) {
+            state ^= k0 ^ tweak ^ c[i];
+            if (i != 0)
+                state = linear(t.forward, state);
+            state = sLayer(state, t.sbox);
+            tweak = linear(t.tweakForward, tweak);
+        }
+
+        state = sLayer(linear(t.forward, state ^ w1 ^ tweak), t.sbox);
+        state = linear(t.reflect, state) ^ permute(k0, tauInv);
+        state = linear(t.backward, sLayer(state, t.sboxInv)) ^ w0 ^ tweak;
+
+        for (unsigned i = rounds; i-- > 0;) {
+            tweak = linear(t.tweakBackward, tweak);
+            state = sLayer(state, t.sboxInv);
+            if (i != 0)
+                state = linear(t.backward, state);
+            state ^= k0 ^ tweak ^ c[i] ^ alpha;
+        }
+        return state ^ w1;
+    }
+};
+
+} // namespace RiscvISA
+
+#endif // __ARCH_RISCV_QARMA_HH__
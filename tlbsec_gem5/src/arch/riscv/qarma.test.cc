@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "arch/riscv/qarma.hh"
+
+using namespace RiscvISA;
+
+/*
+ * The QARMA-64 test vectors with the sigma_1 S-box (Avanzi, ToSC 2017,
+ * Appendix C) for the three proposed numbers of rounds.
+ */
+TEST(QarmaTest, PaperVectors)
+{
+    const uint64_t plaintext = UINT64_C(0xfb623599da6e8127);
+    const uint64_t tweak = UINT64_C(0x477d469dec0b8762);
+    const uint64_t w0 = UINT64_C(0x84be85ce9804e94b);
+    const uint64_t k0 = UINT64_C(0xec2802d4e0a488e9);
+
+    EXPECT_EQ(UINT64_C(0x544b0ab95bda7c3a),
+              Qarma::encrypt(plaintext, tweak, w0, k0, 5));
+    EXPECT_EQ(UINT64_C(0xa512dd1e4e3ec582),
+              Qarma::encrypt(plaintext, tweak, w0, k0, 6));
+    EXPECT_EQ(UINT64_C(0xedf67ff370a483f2),
+              Qarma::encrypt(plaintext, tweak, w0, k0, 7));
+}
+
+/* The tweak has to change the whole block, like the key. */
+TEST(QarmaTest, TweakChangesOutput)
+{
+    const uint64_t w0 = UINT64_C(0x84be85ce9804e94b);
+    const uint64_t k0 = UINT64_C(0xec2802d4e0a488e9);
+
+    for (unsigned rounds = 1; rounds <= Qarma::MaxRounds; rounds++) {
+        for (unsigned bit = 0; bit < 64; bit++) {
+            const uint64_t tweak = UINT64_C(1) << bit;
+            EXPECT_NE(Qarma::encrypt(0, 0, w0, k0, rounds),
+                      Qarma::encrypt(0, tweak, w0, k0, rounds))
+                << rounds << " rounds, tweak bit " << bit;
+        }
+    }
+}
@@ -41,16 +41,20 @@
 #include "arch/riscv/pma_checker.hh"
 #include "arch/riscv/pra_constants.hh"
 #include "arch/riscv/utility.hh"
+#include "base/bitfield.hh"
 #include "base/inifile.hh"
 #include "base/str.hh"
 #include "base/trace.hh"
+#include "cpu/base.hh"
 #include "cpu/thread_context.hh"
 #include "debug/TLB.hh"
 #include "debug/TLBVerbose.hh"
 #include "mem/page_table.hh"
 #include "params/RiscvTLB.hh"
+#include "sim/faults.hh"
 #include "sim/full_system.hh"
 #include "sim/process.hh"
+#include "sim/telemetry.hh"
 #include "sim/system.hh"
 
 using namespace RiscvISA;
@@ -66,10 +70,72 @@ buildKey(Addr vpn, uint16_t asid)
     return (static_cast<Addr>(asid) << 48) | vpn;
 }
 
+// Index into the per-page-size stats (4 KiB, 2 MiB, 1 GiB)
+static unsigned
+pageSizeIndex(unsigned logBytes)
+{
+    return (logBytes - PageShift) / LEVEL_BITS;
+}
+
+/**
+ * Passed to the walker in place of the translation that took an MSHR,
+ * so that the TLB learns when the walk of the MSHR ends.
+ */
+class TLB::MshrTranslation : public BaseTLB::Translation
+{
+  public:
+    MshrTranslation(TLB *_tlb, Translation *_translation,
+                    std::list<Mshr>::iterator _mshr)
+      : tlb(_tlb), translation(_translation), mshr(_mshr)
+    {}
+
+    // The TLB marks the translation itself as delayed
+    void markDelayed() override {}
+
+    void
+    finish(const Fault &fault, const RequestPtr &req, ThreadContext *tc,
+           Mode mode) override
+    {
+        // Free the MSHR first, the CPU may look up again right away
+        tlb->endWalk(mshr);
+        translation->finish(fault, req, tc, mode);
+        delete this;
+    }
+
+    bool squashed() const override { return translation->squashed(); }
+
+  private:
+    TLB *tlb;
+    Translation *translation;
+    std::list<Mshr>::iterator mshr;
+};
+
 TLB::TLB(const Params &p) :
     BaseTLB(p), size(p.size), tlb(size),
-    lruSeq(0), stats(this), pma(p.pma_checker), tlbCache(p.tlb_cache)
+    lruSeq(0), asidStatSlots(p.asid_stats_slots), nextAsidStatSlot(0),
+    asidStatSlot(1 << 16, p.asid_stats_slots), microTlb(p.micro_tlb_size),
+    hostPages(p.host_pages, HostPage{MaxAddr, 0, 0, false, 0, nullptr}),
+    lookupPorts(p.lookup_ports), numBanks(p.lookup_banks),
+    victimLatency(p.victim_latency), victimHit(false),
+    indexLatency(p.tlb_cache->indexLatency()),
+    numMshrs(p.mshrs), blockedSince(MaxTick), releasedLookups(0),
+    timingLookup(nullptr),
+    retryLookupsEvent([this]{ retryLookups(); },
+                      name() + ".retryLookups"),
+    stats(this, p.asid_stats_slots, p.lookup_banks,
+          p.tlb_cache->numDomains(), p.mshrs),
+    pma(p.pma_checker),
+    tlbCache(p.tlb_cache), lookupProfile(p.tlb_cache->name(), "lookup"),
+    insertProfile(p.tlb_cache->name(), "insert")
 {
+    fatal_if(p.micro_tlb_size > 8,
+             "The micro-TLB supports at most 8 entries, %d requested.\n",
+             p.micro_tlb_size);
+    fatal_if(numBanks > 64, "The TLB supports at most 64 banks, %d "
+             "requested.\n", numBanks);
+    for (auto &m : microTlb)
+        m.valid = false;
+
     for (size_t x = 0; x < size; x++) {
         tlb[x].trieHandle = NULL;
         freeList.push_back(&tlb[x]);
@@ -77,6 +143,25 @@ TLB::TLB(const Params &p) :
 
     walker = p.walker;
     walker->setTLB(this);
+    // Every MSHR walks its page as soon as it is taken
+    if (numMshrs)
+        walker->setMaxWalks(numMshrs);
+
+    stats.reach.functor([this] { return tlbCache->reach(); });
+
+    if (p.telemetry) {
+        const auto &c = telemetryCounters;
+        p.telemetry->addCounter(name() + ".accesses",
+                                [&c] { return c.accesses; });
+        p.telemetry->addCounter(name() + ".misses",
+                                [&c] { return c.misses; });
+        p.telemetry->addCounter(name() + ".rerandomizations",
+                                [this] {
+                                    return tlbCache->getRerandRequestCount();
+                                });
+        p.telemetry->addCounter(name() + ".walkTicks",
+                                [&c] { return c.walkTicks; });
+    }
 }
 
 Walker *
@@ -85,6 +170,131 @@ TLB::getWalker()
     return walker;
 }
 
+void
+TLB::switchOut()
+{
+    // The entries are kept for the TLB that takes over from this one.
+    // This TLB only runs again after taking over the entries of another
+    // one, so flushing here would just hand over an empty TLB and count
+    // a rerandomization of every ASID.
+    flushHostPages();
+    walker->demapPteBuffer(0, 0);
+}
+
+void
+TLB::takeOverFrom(BaseTLB *old)
+{
+    TLB *otlb = dynamic_cast<TLB *>(old);
+    panic_if(!otlb, "Cannot take over from a non-RISC-V TLB.\n");
+
+    // Keep the translations and the randomization state, so that a CPU
+    // that is switched in (e.g. after functional warming) continues with
+    // the same TLB contents instead of a cold TLB.
+    tlbCache->takeOverFrom(*otlb->tlbCache);
+    lruSeq = otlb->lruSeq;
+    std::copy(std::begin(otlb->asid_counter), std::end(otlb->asid_counter),
+              std::begin(asid_counter));
+    stats.usedASIDs = otlb->stats.usedASIDs.value();
+
+    // ASIDs seen before keep their per-ASID stat slots
+    fatal_if(otlb->asidStatSlots != asidStatSlots,
+             "%s: Cannot take over from %s, it has %d per-ASID stat slots "
+             "instead of %d.\n", name(), otlb->name(), otlb->asidStatSlots,
+             asidStatSlots);
+    nextAsidStatSlot = otlb->nextAsidStatSlot;
+    asidStatSlot = otlb->asidStatSlot;
+    for (unsigned asid = 0; asid < asidStatSlot.size(); asid++) {
+        if (asidStatSlot[asid] < asidStatSlots)
+            nameAsidStatSlot(asid);
+    }
+
+    if (microTlb.size() == otlb->microTlb.size())
+        microTlb = otlb->microTlb;
+    else
+        flushMicroTlb();
+
+    // The pages may have changed while this TLB was switched out
+    flushHostPages();
+}
+
+Counter
+TLB::totalAccesses() const
+{
+    return stats.readAccesses.value() + stats.writeAccesses.value();
+}
+
+Counter
+TLB::totalMisses() const
+{
+    return stats.readMisses.value() + stats.writeMisses.value();
+}
+
+void
+TLB::regProbePoints()
+{
+    ppAccess.reset(new ProbePoints::TlbAccess(getProbeManager(),
+                                              "TlbAccess"));
+    ppDemap.reset(new ProbePoints::TlbDemap(getProbeManager(),
+                                            "TlbDemap"));
+}
+
+void
+TLB::preDumpStats()
+{
+    BaseTLB::preDumpStats();
+    for (unsigned domain = 0; domain < tlbCache->numDomains(); domain++)
+        stats.domainOccupancy[domain] = tlbCache->occupancy(domain);
+    updateBlockedCycles();
+}
+
+void
+TLB::resetStats()
+{
+    BaseTLB::resetStats();
+    // Lookups blocked before the reset only count from now on
+    if (blockedSince != MaxTick)
+        blockedSince = curTick();
+}
+
+void
+TLB::probeAccess(Addr vaddr, uint16_t asid, Mode mode, unsigned log_bytes,
+                 bool hit, Tick lookup_tick)
+{
+    if (!hit) {
+        telemetryCounters.walkTicks += curTick() - lookup_tick;
+        // Every counted miss is reported here once, with the size of the
+        // page its walk found unless it faulted
+        if (log_bytes)
+            stats.pageSizeMisses[pageSizeIndex(log_bytes)]++;
+    }
+
+    if (!ppAccess || !ppAccess->hasListeners())
+        return;
+
+    ProbePoints::TlbAccessInfo info;
+    info.tick = lookup_tick;
+    info.vaddr = vaddr;
+    info.asid = asid;
+    info.mode = mode;
+    info.logBytes = log_bytes;
+    info.hit = hit;
+    info.walkLatency = curTick() - lookup_tick;
+    ppAccess->notify(info);
+}
+
+void
+TLB::probeDemap(Addr vaddr, uint16_t asid)
+{
+    if (!ppDemap || !ppDemap->hasListeners())
+        return;
+
+    ProbePoints::TlbDemapInfo info;
+    info.tick = curTick();
+    info.vaddr = vaddr;
+    info.asid = asid;
+    ppDemap->notify(info);
+}
+
 void
 TLB::evictLRU()
 {
@@ -108,49 +318,233 @@ TLB::lookup(Addr vpn, uint16_t asid, Mode mode, bool hidden)
     if(asid_counter[asid] == 0) {
         asid_counter[asid]++;
         stats.usedASIDs++;
+        registerAsid(asid);
     }
-    stats.rerandRequests = tlbCache->getRerandRequestCount();
 
     //TlbEntry *entry = trie.lookup(buildKey(vpn, asid));
-    TlbEntry* entry = tlbCache->lookup(vpn,asid);
+    RiscVTLBCache::HitInfo hit_info;
+    TlbEntry* entry;
+    {
+        HostProfiler::Scope profile(lookupProfile);
+        entry = tlbCache->lookup(vpn, asid, &hit_info);
+    }
+    victimHit = hit_info.victim;
+    // Swapping a victim back into the array evicts like a fill
+    if (victimHit)
+        countInsert(entry->asid, hit_info.swap);
+    stats.rerandRequests = tlbCache->getRerandRequestCount();
 
     if (!hidden) {
         //if (entry)
         //    entry->lruSeq = nextSeq();
+        countLookup(vpn, asid, mode, entry, hit_info);
+    }
 
+    return entry;
+}
+
+void
+TLB::countLookup(Addr vpn, uint16_t asid, Mode mode, const TlbEntry *entry,
+                 const RiscVTLBCache::HitInfo &hit_info)
+{
+    if (mode == Write)
+        stats.writeAccesses++;
+    else
+        stats.readAccesses++;
+    stats.asidAccesses[asidStatSlot[asid]]++;
+    telemetryCounters.accesses++;
+
+    if (!entry) {
+        telemetryCounters.misses++;
         if (mode == Write)
-            stats.writeAccesses++;
+            stats.writeMisses++;
         else
-            stats.readAccesses++;
+            stats.readMisses++;
+        stats.asidMisses[asidStatSlot[asid]]++;
+    }
+    else {
+        if (mode == Write)
+            stats.writeHits++;
+        else
+            stats.readHits++;
+        stats.pageSizeHits[pageSizeIndex(entry->logBytes)]++;
+        if (hit_info.coalesced)
+            stats.coalescedHits++;
+        if (hit_info.prefetched)
+            stats.prefetchHits++;
+        if (hit_info.victim)
+            stats.victimHits++;
+    }
 
-        if (!entry) {
-            if (mode == Write)
-                stats.writeMisses++;
-            else
-                stats.readMisses++;
+    DPRINTF(TLBVerbose, "lookup(vpn=%#x, asid=%#x): %s ppn %#x\n",
+            vpn, asid, entry ? "hit" : "miss", entry ? entry->paddr : 0);
+}
+
+TlbEntry *
+TLB::lookupMicroTlb(Addr vaddr, uint16_t asid)
+{
+    for (auto &m : microTlb) {
+        if (m.valid && m.entry.asid == asid &&
+            (vaddr & ~mask(m.entry.logBytes)) == m.entry.vaddr) {
+            m.entry.lruSeq = nextSeq();
+            return &m.entry;
         }
-        else {
-            if (mode == Write)
-                stats.writeHits++;
-            else
-                stats.readHits++;
+    }
+    return nullptr;
+}
+
+void
+TLB::insertMicroTlb(const TlbEntry &entry)
+{
+    MicroTlbEntry *victim = &microTlb[0];
+    for (auto &m : microTlb) {
+        if (!m.valid) {
+            victim = &m;
+            break;
         }
+        if (m.entry.lruSeq < victim->entry.lruSeq)
+            victim = &m;
+    }
+
+    DPRINTF(TLBVerbose, "micro-TLB insert(vpn=%#x, asid=%#x): ppn %#x\n",
+            entry.vaddr, entry.asid, entry.paddr);
+    victim->valid = true;
+    victim->entry = entry;
+    victim->entry.lruSeq = nextSeq();
+}
+
+void
+TLB::registerAsid(uint16_t asid)
+{
+    if (nextAsidStatSlot >= asidStatSlots)
+        return;
+
+    asidStatSlot[asid] = nextAsidStatSlot++;
+    nameAsidStatSlot(asid);
+}
+
+void
+TLB::nameAsidStatSlot(uint16_t asid)
+{
+    const unsigned slot = asidStatSlot[asid];
+    std::string name = csprintf("asid%d", asid);
+    stats.asidAccesses.subname(slot, name);
+    stats.asidMisses.subname(slot, name);
+    stats.asidRerandRequests.subname(slot, name);
+    stats.asidCrossEvictions.subname(slot, name);
+    stats.asidMissRate.subname(slot, name);
+}
+
+void
+TLB::flushMicroTlb()
+{
+    if (microTlb.empty())
+        return;
+
+    stats.microTlbFlushes++;
+    for (auto &m : microTlb)
+        m.valid = false;
+}
+
+uint8_t
+TLB::hostContext(ThreadContext *tc, Mode mode, PrivilegeMode &pmode)
+{
+    STATUS status = tc->readMiscReg(MISCREG_STATUS);
+    pmode = (PrivilegeMode)tc->readMiscReg(MISCREG_PRV);
+    if (mode != Mode::Execute && status.mprv == 1)
+        pmode = (PrivilegeMode)(RegVal)status.mpp;
+    return pmode | status.sum << 2 | status.mxr << 3;
+}
+
+uint8_t *
+TLB::translateHost(const RequestPtr &req, ThreadContext *tc, Mode mode)
+{
+    if (hostPages.empty() || !FullSystem)
+        return nullptr;
 
-        DPRINTF(TLBVerbose, "lookup(vpn=%#x, asid=%#x): %s ppn %#x\n",
-                vpn, asid, entry ? "hit" : "miss", entry ? entry->paddr : 0);
+    Addr vaddr = req->getVaddr();
+    Addr vpn = vaddr >> PageShift;
+    HostPage &hp = hostPages[vpn % hostPages.size()];
+    if (hp.vpn != vpn || (mode == Write && !hp.writable))
+        return nullptr;
+
+    SATP satp = tc->readMiscReg(MISCREG_SATP);
+    PrivilegeMode pmode;
+    if (hp.satp != satp || hp.context != hostContext(tc, mode, pmode))
+        return nullptr;
+
+    if (pmode != PrivilegeMode::PRV_M && satp.mode != AddrXlateMode::BARE) {
+        // Keep the TLB warm: the page still has to hit in the TLB cache,
+        // and a miss is left to translateAtomic(), which walks.
+        vaddr &= mask(VADDR_BITS);
+        RiscVTLBCache::HitInfo hit_info;
+        TlbEntry *e;
+        {
+            HostProfiler::Scope profile(lookupProfile);
+            e = tlbCache->lookup(vaddr, satp.asid, &hit_info);
+        }
+        if (hit_info.victim)
+            countInsert(e->asid, hit_info.swap);
+        if (!e || (e->paddr << PageShift | (vaddr & mask(e->logBytes))) >>
+                PageShift != hp.ppn) {
+            return nullptr;
+        }
+        stats.rerandRequests = tlbCache->getRerandRequestCount();
+        countLookup(vaddr, satp.asid, mode, e, hit_info);
+        probeAccess(vaddr, satp.asid, mode, e->logBytes, true, curTick());
     }
 
-    return entry;
+    stats.hostPageHits++;
+    Addr offset = req->getVaddr() & mask(PageShift);
+    req->setPaddr(hp.ppn << PageShift | offset);
+    return hp.host + offset;
+}
+
+void
+TLB::setHostPage(const RequestPtr &req, ThreadContext *tc, Mode mode,
+                 uint8_t *host_page)
+{
+    if (hostPages.empty() || !FullSystem || mode == Execute)
+        return;
+
+    Addr vpn = req->getVaddr() >> PageShift;
+    Addr ppn = req->getPaddr() >> PageShift;
+    SATP satp = tc->readMiscReg(MISCREG_SATP);
+    PrivilegeMode pmode;
+    uint8_t context = hostContext(tc, mode, pmode);
+
+    HostPage &hp = hostPages[vpn % hostPages.size()];
+    bool same = hp.vpn == vpn && hp.satp == satp && hp.context == context &&
+        hp.ppn == ppn && hp.host == host_page;
+    if (same && (hp.writable || mode != Write))
+        return;
+
+    stats.hostPageFills++;
+    hp = HostPage{vpn, satp, context, (same && hp.writable) || mode == Write,
+                  ppn, host_page};
+}
+
+void
+TLB::flushHostPages()
+{
+    for (auto &hp : hostPages)
+        hp.vpn = MaxAddr;
 }
 
 TlbEntry *
-TLB::insert(Addr vpn, const TlbEntry &entry)
+TLB::insert(Addr vpn, const TlbEntry &entry, uint16_t coalesced)
 {
-    DPRINTF(TLB, "insert(vpn=%#x, asid=%#x): ppn=%#x pte=%#x size=%#x\n",
-        vpn, entry.asid, entry.paddr, entry.pte, entry.size());
+    DPRINTF(TLB, "insert(vpn=%#x, asid=%#x): ppn=%#x pte=%#x size=%#x "
+        "coalesced=%#x\n", vpn, entry.asid, entry.paddr, entry.pte,
+        entry.size(), coalesced);
+
+    // Lookups of coalesced pages return a copy of the page, so an
+    // update has to go through the TLB cache to reach the group.
+    const bool grouped = coalescePages() > 1 && entry.logBytes == PageShift;
 
     // If somebody beat us to it, just use that existing entry.
-    TlbEntry *newEntry = lookup(vpn, entry.asid, Mode::Read, true);
+    TlbEntry *newEntry =
+        grouped ? nullptr : lookup(vpn, entry.asid, Mode::Read, true);
     if (newEntry) {
         // update PTE flags (maybe we set the dirty/writable flag)
         newEntry->pte = entry.pte;
@@ -161,7 +555,23 @@ TLB::insert(Addr vpn, const TlbEntry &entry)
     TlbEntry insertEntry = entry;
     //insertEntry.lruSeq = nextSeq();
     insertEntry.vaddr = vpn;
-    return tlbCache->insert(vpn, insertEntry); 
+
+    if (grouped) {
+        const unsigned page = (vpn >> PageShift) & (coalescePages() - 1);
+        const unsigned neighbors = popCount(coalesced & ~(1U << page));
+        if (neighbors) {
+            stats.coalescedFills++;
+            stats.coalescedPages += neighbors;
+        }
+    }
+
+    RiscVTLBCache::InsertResult res;
+    {
+        HostProfiler::Scope profile(insertProfile);
+        newEntry = tlbCache->insert(vpn, insertEntry, &res, coalesced);
+    }
+    countInsert(entry.asid, res);
+    return newEntry;
     /*
     if (freeList.empty())
         evictLRU();
@@ -179,18 +589,64 @@ TLB::insert(Addr vpn, const TlbEntry &entry)
     */
 }
 
+void
+TLB::insertPrefetch(const TlbEntry &entry)
+{
+    if (tlbCache->holds(entry.vaddr, entry.asid))
+        return;
+
+    DPRINTF(TLB, "prefetch(vpn=%#x, asid=%#x): ppn=%#x pte=%#x\n",
+        entry.vaddr, entry.asid, entry.paddr, entry.pte);
+
+    RiscVTLBCache::InsertResult res;
+    tlbCache->insert(entry.vaddr, entry, &res, 0, true);
+    stats.prefetchFills++;
+    if (res.evicted)
+        stats.prefetchVictims++;
+    countInsert(entry.asid, res);
+}
+
+void
+TLB::countInsert(uint16_t asid, const RiscVTLBCache::InsertResult &res)
+{
+    if (res.rerandomized)
+        stats.asidRerandRequests[asidStatSlot[asid]]++;
+    if (res.evicted && res.evictedAsid != asid)
+        stats.asidCrossEvictions[asidStatSlot[asid]]++;
+    if (res.evicted) {
+        const unsigned domain = tlbCache->domainOf(asid);
+        stats.domainEvictions[domain]++;
+        if (tlbCache->domainOf(res.evictedAsid) != domain)
+            stats.domainCrossEvictions[domain]++;
+    }
+    stats.prefetchUnused += res.evictedUnused;
+    if (res.victimFilled)
+        stats.victimFills++;
+}
+
 void
 TLB::demapPage(Addr vpn, uint64_t asid)
+{
+    demap(vpn, asid);
+}
+
+unsigned
+TLB::demap(Addr vpn, uint64_t asid)
 {
     stats.demapRequests++;
+    flushMicroTlb();
+    flushHostPages();
     asid &= 0xFFFF;
+    walker->demapPteBuffer(vpn, asid);
+    probeDemap(vpn, asid);
 
+    unsigned dropped = 0;
     if (vpn == 0 && asid == 0)
-        tlbCache->flushAll();
+        dropped = tlbCache->flushAll();
     else {
         DPRINTF(TLB, "flush(vpn=%#x, asid=%#x)\n", vpn, asid);
         if (vpn != 0 && asid != 0) {
-            tlbCache->demapPage(vpn,asid);
+            dropped = tlbCache->demapPage(vpn,asid);
             /*
             TlbEntry *newEntry = lookup(vpn, asid, Mode::Read, true);
             if (newEntry)
@@ -198,7 +654,7 @@ TLB::demapPage(Addr vpn, uint64_t asid)
             */
         }
         else {
-            tlbCache->demapPageComplex(vpn,asid);
+            dropped = tlbCache->demapPageComplex(vpn,asid);
             //DPRINTF(TLB, "UNHANDLED CASE IN TLB DEMAP\n");
             //assert(false);
             /*
@@ -213,12 +669,17 @@ TLB::demapPage(Addr vpn, uint64_t asid)
             */
         }
     }
+    return dropped;
 }
 
 void
 TLB::flushAll()
 {
     stats.flushRequests++;
+    flushMicroTlb();
+    flushHostPages();
+    walker->demapPteBuffer(0, 0);
+    probeDemap(0, 0);
     tlbCache->flushAll();
     /*
     DPRINTF(TLB, "flushAll()\n");
@@ -292,7 +753,8 @@ TLB::createPagefault(Addr vaddr, Mode mode)
 Addr
 TLB::translateWithTLB(Addr vaddr, uint16_t asid, Mode mode)
 {
-    TlbEntry *e = lookup(vaddr, asid, mode, false);
+    // The walk filled the entry for a lookup that was counted as a miss
+    TlbEntry *e = lookup(vaddr, asid, mode, true);
     assert(e != nullptr);
     return e->paddr << PageShift | (vaddr & mask(e->logBytes));
 }
@@ -306,17 +768,54 @@ TLB::doTranslate(const RequestPtr &req, ThreadContext *tc,
     Addr vaddr = req->getVaddr() & ((static_cast<Addr>(1) << VADDR_BITS) - 1);
     SATP satp = tc->readMiscReg(MISCREG_SATP);
 
-    TlbEntry *e = lookup(vaddr, satp.asid, mode, false);
+    // Instruction fetches check the micro-TLB first and only fall back to
+    // the (randomized) main TLB on a micro-TLB miss.
+    bool use_micro_tlb = mode == Execute && !microTlb.empty();
+    TlbEntry *e = nullptr;
+    if (use_micro_tlb) {
+        e = lookupMicroTlb(vaddr, satp.asid);
+        if (e)
+            stats.microTlbHits++;
+        else
+            stats.microTlbMisses++;
+    }
+
+    // A redone timing lookup was counted (and a hit reported) when it
+    // was first done
+    const bool redone = timingLookup && timingLookup->counted;
+    Tick miss_tick = redone ? timingLookup->missTick : MaxTick;
     if (!e) {
-        Fault fault = walker->start(tc, translation, req, mode);
-        if (translation != nullptr || fault != NoFault) {
-            // This gets ignored in atomic mode.
-            delayed = true;
-            return fault;
+        e = lookup(vaddr, satp.asid, mode, redone);
+        if (!e && !redone)
+            miss_tick = curTick();
+        TlbEntry buffered;
+        if (!e && walker->takeBufferedPte(vaddr, satp.asid, buffered)) {
+            // The walker staged this translation on an earlier walk, so
+            // the miss is served without accessing the page table.
+            e = insert(buffered.vaddr, buffered);
+        } else if (!e) {
+            Fault fault = startWalk(req, tc, translation, mode, vaddr,
+                                    satp.asid, miss_tick);
+            if (translation != nullptr || fault != NoFault) {
+                // This gets ignored in atomic mode.
+                delayed = true;
+                // Timing walks are reported by the walker when they end
+                if (translation == nullptr)
+                    probeAccess(vaddr, satp.asid, mode, 0, false, miss_tick);
+                return fault;
+            }
+            e = lookup(vaddr, satp.asid, mode, true);
+            assert(e != nullptr);
         }
-        e = lookup(vaddr, satp.asid, mode, false);
-        assert(e != nullptr);
+        if (use_micro_tlb)
+            insertMicroTlb(*e);
     }
+    // Replays of merged misses hit on the entry their MSHR walked, but
+    // are reported as the misses they were counted as
+    if (miss_tick != MaxTick)
+        probeAccess(vaddr, satp.asid, mode, e->logBytes, false, miss_tick);
+    else if (!redone)
+        probeAccess(vaddr, satp.asid, mode, e->logBytes, true, curTick());
 
     STATUS status = tc->readMiscReg(MISCREG_STATUS);
     PrivilegeMode pmode = getMemPriv(tc, mode);
@@ -326,7 +825,8 @@ TLB::doTranslate(const RequestPtr &req, ThreadContext *tc,
         // again to update the dirty flag.
         if (mode == TLB::Write && !e->pte.w) {
             DPRINTF(TLB, "Dirty bit not set, repeating PT walk\n");
-            fault = walker->start(tc, translation, req, mode);
+            fault = startWalk(req, tc, translation, mode, vaddr,
+                              satp.asid, MaxTick);
             if (translation != nullptr || fault != NoFault) {
                 delayed = true;
                 return fault;
@@ -425,17 +925,267 @@ TLB::translateAtomic(const RequestPtr &req, ThreadContext *tc, Mode mode)
     return translate(req, tc, nullptr, mode, delayed);
 }
 
+bool
+TLB::usesTlb(const RequestPtr &req, ThreadContext *tc, Mode mode)
+{
+    if (!FullSystem || (req->getFlags() & Request::PHYSICAL))
+        return false;
+    SATP satp = tc->readMiscReg(MISCREG_SATP);
+    return getMemPriv(tc, mode) != PrivilegeMode::PRV_M &&
+        satp.mode != AddrXlateMode::BARE;
+}
+
+Tick
+TLB::reserveLookup(const RequestPtr &req, ThreadContext *tc)
+{
+    // The walker is clocked like the CPU the TLB belongs to, and unlike
+    // the CPU it is also there when a tester drives the TLB.
+    const Tick now = walker->clockEdge();
+    const Tick period = walker->clockPeriod();
+    portSchedule.erase(portSchedule.begin(), portSchedule.lower_bound(now));
+
+    uint64_t banks = 0;
+    if (numBanks) {
+        SATP satp = tc->readMiscReg(MISCREG_SATP);
+        Addr vaddr = req->getVaddr() & mask(VADDR_BITS);
+        banks = tlbCache->lookupBanks(vaddr, satp.asid, numBanks);
+        stats.banksPerLookup.sample(popCount(banks));
+    }
+    stats.portLookups++;
+
+    Tick when = now;
+    bool port_conflict = false;
+    bool bank_conflict = false;
+    while (true) {
+        CycleUsage &use = portSchedule[when];
+        const bool ports_full = lookupPorts && use.ports >= lookupPorts;
+        const bool banks_busy = (use.banks & banks) != 0;
+        if (!ports_full && !banks_busy) {
+            use.ports++;
+            use.banks |= banks;
+            break;
+        }
+        port_conflict |= ports_full;
+        bank_conflict |= banks_busy && !ports_full;
+        when += period;
+    }
+
+    if (port_conflict)
+        stats.portConflicts++;
+    else if (bank_conflict)
+        stats.bankConflicts++;
+    stats.portStallCycles += (when - now) / period;
+    return when;
+}
+
 void
 TLB::translateTiming(const RequestPtr &req, ThreadContext *tc,
                      Translation *translation, Mode mode)
 {
-    bool delayed;
     assert(translation);
-    Fault fault = translate(req, tc, translation, mode, delayed);
-    if (!delayed)
+
+    const TimingLookup lookup = {req, tc, translation, mode,
+                                 false, false, false, MaxTick};
+    if (mshrsBlocked() && usesTlb(req, tc, mode)) {
+        // All MSHRs are taken, so the TLB takes no new lookups
+        translation->markDelayed();
+        blockLookup(lookup);
+        return;
+    }
+
+    issueTiming(lookup, false);
+}
+
+void
+TLB::issueTiming(const TimingLookup &lookup, bool marked)
+{
+    const RequestPtr &req = lookup.req;
+    ThreadContext *tc = lookup.tc;
+    if ((lookupPorts || numBanks || indexLatency) &&
+            usesTlb(req, tc, lookup.mode)) {
+        Tick when = walker->clockEdge();
+        if (lookupPorts || numBanks)
+            when = reserveLookup(req, tc);
+        // The set indices of the ways are computed before the lookup
+        when += walker->cyclesToTicks(indexLatency);
+        if (when > walker->clockEdge()) {
+            DPRINTF(TLB, "Lookup of %#x delayed until %d\n",
+                    req->getVaddr(), when);
+            if (!marked)
+                lookup.translation->markDelayed();
+            schedule(new EventFunctionWrapper([this, lookup]{
+                lookupTiming(lookup, true);
+            }, name() + ".delayedLookup", true), when);
+            return;
+        }
+    }
+
+    lookupTiming(lookup, marked);
+}
+
+void
+TLB::lookupTiming(const TimingLookup &lookup, bool marked)
+{
+    const RequestPtr &req = lookup.req;
+    ThreadContext *tc = lookup.tc;
+    Translation *translation = lookup.translation;
+    const Mode mode = lookup.mode;
+
+    bool delayed;
+    Fault fault;
+    victimHit = false;
+    if (marked && translation->squashed()) {
+        // Squashed while it waited
+        delayed = false;
+        fault = std::make_shared<UnimpFault>("Squashed Inst");
+    } else {
+        timingLookup = &lookup;
+        fault = translate(req, tc, translation, mode, delayed);
+        timingLookup = nullptr;
+    }
+
+    if (lookup.released) {
+        // Its MSHR is taken now if it missed, so the next blocked lookup
+        // may go if one is still free
+        releasedLookups--;
+        if (!blockedLookups.empty() &&
+                mshrs.size() + releasedLookups < numMshrs &&
+                !retryLookupsEvent.scheduled()) {
+            schedule(retryLookupsEvent, walker->clockEdge());
+        }
+    }
+
+    if (!delayed && victimHit && victimLatency) {
+        // The victim buffer is only probed after the main array missed
+        if (!marked)
+            translation->markDelayed();
+        schedule(new EventFunctionWrapper([=]{
+            translation->finish(fault, req, tc, mode);
+        }, name() + ".victimHit", true), walker->clockEdge(victimLatency));
+    } else if (!delayed) {
         translation->finish(fault, req, tc, mode);
-    else
+    } else if (!marked) {
         translation->markDelayed();
+    }
+}
+
+Fault
+TLB::startWalk(const RequestPtr &req, ThreadContext *tc,
+               Translation *translation, Mode mode, Addr vaddr,
+               uint16_t asid, Tick miss_tick)
+{
+    if (!numMshrs || translation == nullptr)
+        return walker->start(tc, translation, req, mode, miss_tick);
+
+    // The miss is counted, so redoing the lookup must not count it again
+    const TimingLookup lookup = {req, tc, translation, mode, true,
+                                 timingLookup && timingLookup->blocked,
+                                 false, miss_tick};
+
+    // The size of the page is only known after the walk, so misses are
+    // merged by their 4KiB page
+    const Addr vpn = vaddr >> PageShift;
+    for (auto &mshr : mshrs) {
+        if (mshr.vpn == vpn && mshr.asid == asid) {
+            DPRINTF(TLB, "Miss of %#x merged into the MSHR of its page\n",
+                    vaddr);
+            mshr.targets.push_back(lookup);
+            stats.mshrMerges++;
+            return NoFault;
+        }
+    }
+
+    if (mshrs.size() >= numMshrs) {
+        // The lookup was issued before the last MSHR was taken
+        blockLookup(lookup);
+        return NoFault;
+    }
+
+    mshrs.push_back({vpn, asid, {}});
+    stats.mshrOccupancy.sample(mshrs.size());
+    return walker->start(tc,
+        new MshrTranslation(this, translation, std::prev(mshrs.end())),
+        req, mode, miss_tick);
+}
+
+void
+TLB::endWalk(std::list<Mshr>::iterator mshr)
+{
+    for (auto &target : mshr->targets)
+        replayLookups.push_back(target);
+    mshrs.erase(mshr);
+
+    // Retry once the walker is done with the response that ended the walk
+    if (!retryLookupsEvent.scheduled())
+        schedule(retryLookupsEvent, walker->clockEdge());
+}
+
+void
+TLB::blockLookup(TimingLookup lookup)
+{
+    DPRINTF(TLB, "Lookup of %#x blocked, all %d MSHRs are taken\n",
+            lookup.req->getVaddr(), numMshrs);
+    if (blockedLookups.empty())
+        blockedSince = curTick();
+    if (!lookup.blocked)
+        stats.mshrBlocked++;
+    lookup.blocked = true;
+    blockedLookups.push_back(lookup);
+}
+
+bool
+TLB::mshrsBlocked() const
+{
+    // Released lookups still may take the MSHRs that are free now
+    return numMshrs && (!blockedLookups.empty() ||
+                        mshrs.size() + releasedLookups >= numMshrs);
+}
+
+void
+TLB::updateBlockedCycles()
+{
+    if (blockedSince == MaxTick)
+        return;
+    stats.mshrBlockedCycles += walker->ticksToCycles(curTick() -
+                                                     blockedSince);
+    blockedSince = blockedLookups.empty() ? MaxTick : curTick();
+}
+
+void
+TLB::retryLookups()
+{
+    auto squashed = [](const TimingLookup &lookup) {
+        if (!lookup.translation->squashed())
+            return false;
+        lookup.translation->finish(
+            std::make_shared<UnimpFault>("Squashed Inst"),
+            lookup.req, lookup.tc, lookup.mode);
+        return true;
+    };
+
+    // Merged lookups hit on the entry their MSHR filled (unless it was
+    // already evicted again), so they do not wait for a free MSHR
+    while (!replayLookups.empty()) {
+        TimingLookup lookup = replayLookups.front();
+        replayLookups.pop_front();
+        if (!squashed(lookup))
+            issueTiming(lookup, true);
+    }
+
+    // Lookups delayed by ports or the index function take their MSHR
+    // later, so only release as many as MSHRs are free
+    while (!blockedLookups.empty() &&
+           mshrs.size() + releasedLookups < numMshrs) {
+        TimingLookup lookup = blockedLookups.front();
+        blockedLookups.pop_front();
+        if (blockedLookups.empty())
+            updateBlockedCycles();
+        if (squashed(lookup))
+            continue;
+        lookup.released = true;
+        releasedLookups++;
+        issueTiming(lookup, true);
+    }
 }
 
 Fault
@@ -530,7 +1280,9 @@ TLB::unserialize(CheckpointIn &cp)
     }
 }
 
-TLB::TlbStats::TlbStats(Stats::Group *parent)
+TLB::TlbStats::TlbStats(Stats::Group *parent, unsigned asid_slots,
+                        unsigned num_banks, unsigned num_domains,
+                        unsigned num_mshrs)
   : Stats::Group(parent),
     ADD_STAT(readHits, UNIT_COUNT, "read hits"),
     ADD_STAT(readMisses, UNIT_COUNT, "read misses"),
@@ -542,13 +1294,110 @@ TLB::TlbStats::TlbStats(Stats::Group *parent)
     ADD_STAT(demapRequests, UNIT_COUNT, "TLB Demap Requests"),
     ADD_STAT(rerandRequests, UNIT_COUNT, "Rerandomization requests"),
     ADD_STAT(usedASIDs, UNIT_COUNT, "Used ASIDs in TLB"),
+    ADD_STAT(microTlbHits, UNIT_COUNT, "micro-TLB hits"),
+    ADD_STAT(microTlbMisses, UNIT_COUNT, "micro-TLB misses"),
+    ADD_STAT(microTlbFlushes, UNIT_COUNT, "micro-TLB flushes"),
+    ADD_STAT(hostPageHits, UNIT_COUNT,
+             "Accesses served from host memory without a packet"),
+    ADD_STAT(hostPageFills, UNIT_COUNT,
+             "Pages (or write permissions) added to the host page cache"),
+    ADD_STAT(asidAccesses, UNIT_COUNT, "TLB accesses per ASID"),
+    ADD_STAT(asidMisses, UNIT_COUNT, "TLB misses per ASID"),
+    ADD_STAT(asidRerandRequests, UNIT_COUNT,
+             "Rerandomization requests per ASID"),
+    ADD_STAT(asidCrossEvictions, UNIT_COUNT,
+             "Evictions of other ASIDs' entries caused per ASID"),
+    ADD_STAT(asidMissRate, UNIT_RATIO, "TLB miss rate per ASID",
+             asidMisses / asidAccesses),
+    ADD_STAT(domainOccupancy, UNIT_COUNT,
+             "Valid TLB entries per domain (sampled when dumping)"),
+    ADD_STAT(domainEvictions, UNIT_COUNT,
+             "Evictions caused by the fills of each domain"),
+    ADD_STAT(domainCrossEvictions, UNIT_COUNT,
+             "Evictions of other domains' entries caused per domain"),
+    ADD_STAT(victimHits, UNIT_COUNT,
+             "Misses of the main array served by the victim buffer "
+             "(walks saved)"),
+    ADD_STAT(victimFills, UNIT_COUNT,
+             "Evicted entries moved to the victim buffer"),
+    ADD_STAT(pageSizeHits, UNIT_COUNT, "TLB hits per page size"),
+    ADD_STAT(pageSizeMisses, UNIT_COUNT,
+             "TLB misses per page size (attributed once walked)"),
     ADD_STAT(hits, UNIT_COUNT, "Total TLB (read and write) hits",
              readHits + writeHits),
     ADD_STAT(misses, UNIT_COUNT, "Total TLB (read and write) misses",
              readMisses + writeMisses),
     ADD_STAT(accesses, UNIT_COUNT, "Total TLB (read and write) accesses",
-             readAccesses + writeAccesses)
+             readAccesses + writeAccesses),
+    ADD_STAT(microTlbHitRate, UNIT_RATIO, "micro-TLB hit rate",
+             microTlbHits / (microTlbHits + microTlbMisses)),
+    ADD_STAT(portLookups, UNIT_COUNT,
+             "Timing lookups subject to the port and bank limits"),
+    ADD_STAT(portConflicts, UNIT_COUNT,
+             "Lookups delayed because all ports were taken"),
+    ADD_STAT(bankConflicts, UNIT_COUNT,
+             "Lookups delayed only because a bank they read was busy"),
+    ADD_STAT(portStallCycles, UNIT_CYCLE,
+             "Cycles lookups waited for a port or bank"),
+    ADD_STAT(banksPerLookup, UNIT_COUNT, "Banks read per lookup"),
+    ADD_STAT(avgPortStallCycles, UNIT_RATIO,
+             "Average cycles a lookup waited for a port or bank",
+             portStallCycles / portLookups),
+    ADD_STAT(mshrOccupancy, UNIT_COUNT,
+             "MSHRs taken, sampled whenever a miss takes one"),
+    ADD_STAT(mshrMerges, UNIT_COUNT,
+             "Misses merged into the MSHR of a page already walked"),
+    ADD_STAT(mshrBlocked, UNIT_COUNT,
+             "Lookups that waited because all MSHRs were taken"),
+    ADD_STAT(mshrBlockedCycles, UNIT_CYCLE,
+             "Cycles the TLB blocked lookups because all MSHRs were taken"),
+    ADD_STAT(coalescedHits, UNIT_COUNT,
+             "Hits on pages a coalesced entry mapped before they were "
+             "accessed (misses saved by coalescing)"),
+    ADD_STAT(coalescedFills, UNIT_COUNT,
+             "Fills that coalesced neighbouring pages into the entry"),
+    ADD_STAT(coalescedPages, UNIT_COUNT,
+             "Neighbouring pages added to entries by coalesced fills"),
+    ADD_STAT(reach, UNIT_BYTE, "Address space mapped by the TLB"),
+    ADD_STAT(prefetchFills, UNIT_COUNT,
+             "Entries installed from PTEs next to a walked PTE"),
+    ADD_STAT(prefetchHits, UNIT_COUNT,
+             "First hits on entries installed from neighbouring PTEs"),
+    ADD_STAT(prefetchUnused, UNIT_COUNT,
+             "Entries installed from neighbouring PTEs that were evicted "
+             "without a hit"),
+    ADD_STAT(prefetchVictims, UNIT_COUNT,
+             "Valid entries evicted to install neighbouring PTEs"),
+    ADD_STAT(prefetchAccuracy, UNIT_RATIO,
+             "Fraction of neighbouring PTE fills that hit",
+             prefetchHits / prefetchFills)
 {
+    // One slot per tracked ASID plus a shared slot for the rest
+    for (auto *vec : {&asidAccesses, &asidMisses, &asidRerandRequests,
+                      &asidCrossEvictions}) {
+        vec->init(asid_slots + 1)
+            .subname(asid_slots, "other")
+            .flags(Stats::nozero);
+    }
+    asidMissRate.subname(asid_slots, "other");
+    asidMissRate.flags(Stats::nozero | Stats::nonan);
+
+    for (auto *vec : {&domainOccupancy, &domainEvictions,
+                      &domainCrossEvictions}) {
+        vec->init(num_domains);
+    }
+
+    for (auto *vec : {&pageSizeHits, &pageSizeMisses}) {
+        vec->init(3)
+            .subname(0, "4KiB")
+            .subname(1, "2MiB")
+            .subname(2, "1GiB");
+    }
+
+    banksPerLookup.init(num_banks ? num_banks : 1);
+    mshrOccupancy.init(num_mshrs ? num_mshrs : 1);
+    avgPortStallCycles.flags(Stats::nonan);
+    prefetchAccuracy.flags(Stats::nonan);
 }
 
 Port *
@@ -32,7 +32,9 @@
 #ifndef __ARCH_RISCV_TLB_HH__
 #define __ARCH_RISCV_TLB_HH__
 
+#include <deque>
 #include <list>
+#include <map>
 
 #include "arch/generic/tlb.hh"
 #include "arch/riscv/isa.hh"
@@ -43,10 +45,13 @@
 #include "base/statistics.hh"
 #include "mem/request.hh"
 #include "params/RiscvTLB.hh"
+#include "sim/host_profiler.hh"
+#include "sim/probe/tlb.hh"
 #include "sim/sim_object.hh"
 
 #include "arch/riscv/tlb_cache.hh"
 
+class Telemetry;
 class ThreadContext;
 
 /* To maintain compatibility with other architectures, we'll
@@ -61,6 +66,9 @@ class TLB : public BaseTLB
 
   protected:
     RiscVTLBCache* tlbCache;
+    /** Host profiler scopes of the lookups and fills of tlbCache. */
+    HostProfiler::Label lookupProfile;
+    HostProfiler::Label insertProfile;
     size_t size;
     std::vector<TlbEntry> tlb;  // our TLB
     TlbEntryTrie trie;          // for quick access
@@ -69,10 +77,144 @@ class TLB : public BaseTLB
 
     Walker *walker;
 
+    /** Probe point notified for every requested translation. */
+    ProbePoints::TlbAccessUPtr ppAccess;
+    /** Probe point notified for every demap and flush. */
+    ProbePoints::TlbDemapUPtr ppDemap;
+
+    /**
+     * Counters sampled by the telemetry time series. Unlike the stats
+     * they are never reset.
+     */
+    struct TelemetryCounters
+    {
+        uint64_t accesses = 0;
+        uint64_t misses = 0;
+        uint64_t walkTicks = 0;
+    } telemetryCounters;
+
     uint8_t asid_counter[1<<16] = {0};
 
+    /**
+     * Per-ASID statistics are kept in fixed-size vectors. An ASID gets a
+     * slot (and a stat name) the first time it is seen; once all slots
+     * are taken, further ASIDs are accounted in a shared "other" slot.
+     */
+    unsigned asidStatSlots;
+    unsigned nextAsidStatSlot;
+    std::vector<uint16_t> asidStatSlot;
+
+    /**
+     * Small fully associative L0 TLB that sits in front of tlbCache for
+     * instruction fetches. It only caches translations that the main TLB
+     * already holds, so it is flushed on sfence.vma, satp writes and
+     * privilege changes and never needs to be written back.
+     */
+    struct MicroTlbEntry
+    {
+        bool valid;
+        TlbEntry entry;
+    };
+    std::vector<MicroTlbEntry> microTlb;
+
+    /**
+     * Host memory of recently translated data pages, see translateHost().
+     * The cache is direct mapped by virtual page and tagged with satp
+     * and with the privilege and mstatus bits the permission checks
+     * depend on. It is dropped on every fence, so a hit only has to
+     * find the page in the TLB cache again.
+     */
+    struct HostPage
+    {
+        Addr vpn;
+        RegVal satp;
+        uint8_t context;
+        bool writable;
+        Addr ppn;
+        uint8_t *host;
+    };
+    std::vector<HostPage> hostPages;
+
+    /**
+     * Timing lookups per CPU cycle (0: unlimited) and number of banks the
+     * sets are interleaved across (0: not banked). A lookup that finds
+     * all ports taken, or one of the banks it reads busy, is retried in
+     * the next cycle, which delays the translation of the request.
+     */
+    const unsigned lookupPorts;
+    const unsigned numBanks;
+
+    /**
+     * Latency of a hit in the victim buffer of tlbCache and whether the
+     * last lookup hit there, which delays a timing translation.
+     */
+    const Cycles victimLatency;
+    bool victimHit;
+    /** Cycles the index function of tlbCache adds to every lookup. */
+    const Cycles indexLatency;
+
+    /** Ports and banks already claimed in the current and later cycles. */
+    struct CycleUsage
+    {
+        unsigned ports = 0;
+        uint64_t banks = 0;
+    };
+    std::map<Tick, CycleUsage> portSchedule;
+
+    /** A timing translation waiting to (re)do its lookup. */
+    struct TimingLookup
+    {
+        RequestPtr req;
+        ThreadContext *tc;
+        Translation *translation;
+        Mode mode;
+        /** The access was counted already, the lookup is redone. */
+        bool counted;
+        /** The lookup was counted as blocked already. */
+        bool blocked;
+        /** The lookup left blockedLookups and may still take an MSHR. */
+        bool released;
+        /** When it was counted as a miss (MaxTick: it was not). */
+        Tick missTick;
+    };
+
+    /**
+     * Miss status holding registers of timing translations (0: none, the
+     * walker then queues any number of misses and walks them one at a
+     * time). A miss to a 4KiB page that already has an MSHR is merged
+     * into it and looked up again when the walk ends; other misses take
+     * an MSHR and walk in parallel, while hits proceed under them. With
+     * all MSHRs taken the TLB blocks: new lookups, hits included, wait
+     * in blockedLookups until a walk ends.
+     */
+    const unsigned numMshrs;
+    struct Mshr
+    {
+        Addr vpn;
+        uint16_t asid;
+        std::vector<TimingLookup> targets;
+    };
+    std::list<Mshr> mshrs;
+    class MshrTranslation;
+
+    /** Merged lookups of ended walks, redone before blocked ones. */
+    std::deque<TimingLookup> replayLookups;
+    std::deque<TimingLookup> blockedLookups;
+    /**
+     * Since when blockedLookups is not empty (MaxTick: it is empty), or
+     * since the last stats dump of mshrBlockedCycles.
+     */
+    Tick blockedSince;
+    /** Released lookups that did not look up yet. */
+    unsigned releasedLookups;
+    /** The timing lookup being translated (nullptr: none). */
+    const TimingLookup *timingLookup;
+    EventFunctionWrapper retryLookupsEvent;
+
     struct TlbStats : public Stats::Group{
-        TlbStats(Stats::Group *parent);
+        TlbStats(Stats::Group *parent, unsigned asid_slots,
+                 unsigned num_banks, unsigned num_domains,
+                 unsigned num_mshrs);
 
         Stats::Scalar readHits;
         Stats::Scalar readMisses;
@@ -88,9 +230,56 @@ class TLB : public BaseTLB
         Stats::Scalar rerandRequests;
         Stats::Scalar usedASIDs;
 
+        Stats::Scalar microTlbHits;
+        Stats::Scalar microTlbMisses;
+        Stats::Scalar microTlbFlushes;
+
+        Stats::Scalar hostPageHits;
+        Stats::Scalar hostPageFills;
+
+        Stats::Vector asidAccesses;
+        Stats::Vector asidMisses;
+        Stats::Vector asidRerandRequests;
+        Stats::Vector asidCrossEvictions;
+        Stats::Formula asidMissRate;
+
+        Stats::Vector domainOccupancy;
+        Stats::Vector domainEvictions;
+        Stats::Vector domainCrossEvictions;
+
+        Stats::Scalar victimHits;
+        Stats::Scalar victimFills;
+
+        Stats::Vector pageSizeHits;
+        Stats::Vector pageSizeMisses;
+
         Stats::Formula hits;
         Stats::Formula misses;
         Stats::Formula accesses;
+        Stats::Formula microTlbHitRate;
+
+        Stats::Scalar portLookups;
+        Stats::Scalar portConflicts;
+        Stats::Scalar bankConflicts;
+        Stats::Scalar portStallCycles;
+        Stats::Histogram banksPerLookup;
+        Stats::Formula avgPortStallCycles;
+
+        Stats::Histogram mshrOccupancy;
+        Stats::Scalar mshrMerges;
+        Stats::Scalar mshrBlocked;
+        Stats::Scalar mshrBlockedCycles;
+
+        Stats::Scalar coalescedHits;
+        Stats::Scalar coalescedFills;
+        Stats::Scalar coalescedPages;
+        Stats::Value reach;
+
+        Stats::Scalar prefetchFills;
+        Stats::Scalar prefetchHits;
+        Stats::Scalar prefetchUnused;
+        Stats::Scalar prefetchVictims;
+        Stats::Formula prefetchAccuracy;
     } stats;
 
   public:
@@ -101,12 +290,64 @@ class TLB : public BaseTLB
     TLB(const Params &p);
 
     Walker *getWalker();
+    RiscVTLBCache *getTlbCache() { return tlbCache; }
+
+    void switchOut() override;
+    void takeOverFrom(BaseTLB *old) override;
 
-    void takeOverFrom(BaseTLB *old) override {}
+    void regProbePoints() override;
+    void preDumpStats() override;
+    void resetStats() override;
+
+    /**
+     * Report a translation to the TlbAccess probe point. For misses,
+     * lookup_tick is when the TLB was looked up, so the walk latency is
+     * the time elapsed since then, and log_bytes the size of the page
+     * the miss is counted for (0 if the walk faulted).
+     */
+    void probeAccess(Addr vaddr, uint16_t asid, Mode mode,
+                     unsigned log_bytes, bool hit, Tick lookup_tick);
+    /** Report a demap (0 for all addresses or ASIDs) to TlbDemap. */
+    void probeDemap(Addr vaddr, uint16_t asid);
 
-    TlbEntry *insert(Addr vpn, const TlbEntry &entry);
+    /**
+     * @param coalesced Mask of the pages in the coalescing group of a
+     *        4KiB vpn that the walker found contiguous with it, see
+     *        TLBCache::insert().
+     */
+    TlbEntry *insert(Addr vpn, const TlbEntry &entry,
+                     uint16_t coalesced = 0);
+    /**
+     * Install a 4KiB translation the walker read along with the PTE it
+     * walked, unless the page is already mapped. Its hits and unused
+     * evictions are counted separately from demand fills.
+     */
+    void insertPrefetch(const TlbEntry &entry);
+    /** Pages one 4KiB entry may map, 1 without coalescing. */
+    unsigned coalescePages() const { return tlbCache->coalescePages(); }
     void flushAll() override;
     void demapPage(Addr vaddr, uint64_t asn) override;
+    /**
+     * sfence.vma semantics of demapPage(), returning the number of
+     * entries that were dropped from the TLB cache.
+     */
+    unsigned demap(Addr vaddr, uint64_t asn);
+
+    /** Drop every entry of the L0 micro-TLB. */
+    void flushMicroTlb();
+
+    uint8_t *translateHost(const RequestPtr &req, ThreadContext *tc,
+                           Mode mode) override;
+    void setHostPage(const RequestPtr &req, ThreadContext *tc, Mode mode,
+                     uint8_t *host_page) override;
+    void flushHostPages() override;
+
+    /**
+     * Translations requested and missed since the last stats reset, for
+     * sampling scripts that read them between simulation phases.
+     */
+    Counter totalAccesses() const;
+    Counter totalMisses() const;
 
     Fault checkPermissions(STATUS status, PrivilegeMode pmode, Addr vaddr,
                            Mode mode, PTESv39 pte);
@@ -144,13 +385,70 @@ class TLB : public BaseTLB
   private:
     uint64_t nextSeq() { return ++lruSeq; }
 
+    void registerAsid(uint16_t asid);
+    /** Name the per-ASID stats of the slot of asid after it. */
+    void nameAsidStatSlot(uint16_t asid);
+    void countInsert(uint16_t asid, const RiscVTLBCache::InsertResult &res);
+
     TlbEntry *lookup(Addr vpn, uint16_t asid, Mode mode, bool hidden);
+    /** Account a visible lookup that found entry (or nothing). */
+    void countLookup(Addr vpn, uint16_t asid, Mode mode,
+                     const TlbEntry *entry,
+                     const RiscVTLBCache::HitInfo &hit_info);
+
+    /** Tag of the context a host page was translated in. */
+    uint8_t hostContext(ThreadContext *tc, Mode mode,
+                        PrivilegeMode &pmode);
+
+    TlbEntry *lookupMicroTlb(Addr vaddr, uint16_t asid);
+    void insertMicroTlb(const TlbEntry &entry);
 
     void evictLRU();
     void remove(size_t idx);
 
     Fault translate(const RequestPtr &req, ThreadContext *tc,
                     Translation *translation, Mode mode, bool &delayed);
+    /** Whether a translation will read the TLB (not bare or M-mode). */
+    bool usesTlb(const RequestPtr &req, ThreadContext *tc, Mode mode);
+    /**
+     * Claim a lookup port and the banks the lookup reads in the first
+     * CPU cycle where both are free and return that cycle.
+     */
+    Tick reserveLookup(const RequestPtr &req, ThreadContext *tc);
+    /**
+     * Look up a timing request once a port, its banks and the index
+     * function let it, see translateTiming().
+     */
+    void issueTiming(const TimingLookup &lookup, bool marked);
+    /**
+     * Translate a timing request whose lookup happens now and finish it,
+     * after the victim buffer latency if that is where it hit. marked
+     * is set if the translation was already marked as delayed.
+     */
+    void lookupTiming(const TimingLookup &lookup, bool marked);
+    /**
+     * Walk the page of a missing translation. Timing misses are merged
+     * into an MSHR of the same page, take a free MSHR or, with all of
+     * them taken, block until a walk ends. miss_tick is when the lookup
+     * that walks was counted as a miss, the walk reports it to the
+     * TlbAccess probe point when it ends (MaxTick: the lookup hit and
+     * was reported, e.g. before a walk that sets the dirty bit).
+     */
+    Fault startWalk(const RequestPtr &req, ThreadContext *tc,
+                    Translation *translation, Mode mode, Addr vaddr,
+                    uint16_t asid, Tick miss_tick);
+    /** Free an MSHR whose walk ended and redo its merged lookups. */
+    void endWalk(std::list<Mshr>::iterator mshr);
+    void blockLookup(TimingLookup lookup);
+    /** Whether new lookups have to wait for an MSHR. */
+    bool mshrsBlocked() const;
+    /**
+     * Redo merged lookups, then release blocked ones while MSHRs are
+     * free, one per free MSHR until the released ones looked up.
+     */
+    void retryLookups();
+    /** Account the cycles blockedLookups was not empty until now. */
+    void updateBlockedCycles();
     Fault doTranslate(const RequestPtr &req, ThreadContext *tc,
                       Translation *translation, Mode mode, bool &delayed);
 };
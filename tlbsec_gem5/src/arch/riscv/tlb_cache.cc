@@ -1,20 +1,22 @@
 #include "tlb_cache.hh"
-#include "base/trace.hh"
 
-// Miss Threshold
-#define MAX_EVICT 64
+#include <algorithm>
+#include <iterator>
 
-// Enable set assosciative TLB instead
-// #define SATLB 1
+#include "base/bitfield.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
 
 namespace RiscvISA {
-    RiscVTLBCache::RiscVTLBCache(const RiscVTLBCacheParams &params) :
-    SimObject(params)
+    const unsigned TLBCache::MaxWays;
+
+    TLBCache::TLBCache(const std::string &cache_name, unsigned num_ways,
+                       unsigned num_sets, uint32_t max_evict,
+                       bool randomized) :
+    _name(cache_name), randomized(randomized), maxEvict(max_evict),
+    cacheData(nullptr), coalesceShift(0), domains(1),
+    victimRandomized(false), victimSeq(0), indexFunction(nullptr)
     {
-        // Configure TLB
-        ways = 4;
-        sets = 16;
-        
         // Dummy cpu key
         prince_key = 0x0011223344556677;
 
@@ -22,222 +24,521 @@ namespace RiscvISA {
         rerand_requests = 0;
         global_page_max = 0;
 
-        cacheData = (TLBMeta**) malloc(sets*sizeof(TLBMeta*));
-        
-
-        // Init Cache
-        for(uint8_t i=0; i<sets; i++){
-            cacheData[i] = (TLBMeta*) malloc(ways * sizeof(TLBMeta));
-            for(uint8_t j=0; j<ways; j++){
-                cacheData[i][j].valid = false;
-                (cacheData[i][j].entry).lruSeq = j+1; // set initial LRU sequence 1->4
-            }
-        }
+        setGeometry(num_ways, num_sets);
 
         DPRINTF(RiscVTLBCache, "Initilalized TLBCache with %d ways and %d sets (Struct size: %d).\n", ways, sets, sizeof(TLBMeta));
     }
 
-    RiscVTLBCache::~RiscVTLBCache()
+    TLBCache::~TLBCache()
     {
-        delete this;
+        freeCacheData();
+    }
+
+    void TLBCache::freeCacheData() {
+        if (!cacheData)
+            return;
+        for(unsigned i=0; i<sets; i++)
+            delete [] cacheData[i];
+        delete [] cacheData;
+        cacheData = nullptr;
     }
 
-    void RiscVTLBCache::randomize(Addr va, uint64_t process_id, uint64_t* set_arr) {
-        uint64_t randomization = encrypt(va, prince_key ^ process_id ^ random_id[process_id]);
+    void TLBCache::setGeometry(unsigned num_ways, unsigned num_sets) {
+        fatal_if(num_ways == 0 || num_ways > MaxWays,
+                 "%s: TLB associativity must be 1 to %d, not %d.\n",
+                 name(), MaxWays, num_ways);
+        fatal_if(num_sets == 0 || (num_sets & (num_sets - 1)) != 0,
+                 "%s: Number of TLB sets (%d) must be a power of two.\n",
+                 name(), num_sets);
+
+        freeCacheData();
+        flushVictims();
+        ways = num_ways;
+        sets = num_sets;
+
+        setBits = 0;
+        while ((1U << setBits) < sets)
+            setBits++;
+        fatal_if(setBits > 32, "%s: Too many TLB sets (%d).\n", name(), sets);
+
+        cacheData = new TLBMeta*[sets];
 
-        for(int i = 0; i < ways; i++) {
-            set_arr[i] = (randomization >> (i*4)) & 0xF;
+        // Init Cache
+        for(unsigned i=0; i<sets; i++){
+            cacheData[i] = new TLBMeta[ways];
+            for(unsigned j=0; j<ways; j++){
+                cacheData[i][j].valid = false;
+                cacheData[i][j].coalesced = 0;
+                cacheData[i][j].touched = 0;
+                cacheData[i][j].prefetched = 0;
+                (cacheData[i][j].entry).lruSeq = j+1; // set initial LRU sequence 1->ways
+            }
         }
+    }
 
+    void TLBCache::reconfigure(unsigned num_ways, unsigned num_sets,
+                               uint32_t max_evict, bool randomized) {
+        fatal_if(partitioned() && num_ways != ways,
+                 "%s: Cannot change the associativity of a way-partitioned "
+                 "TLB.\n", name());
+        setGeometry(num_ways, num_sets);
+        maxEvict = max_evict;
+        this->randomized = randomized;
+
+        // Start every ASID from a fresh random id
+        std::fill(std::begin(random_id), std::end(random_id), 0);
+        std::fill(std::begin(evict_cnt), std::end(evict_cnt), 0);
+
+        DPRINTF(RiscVTLBCache, "Reconfigured TLBCache to %d ways and %d "
+                "sets (%s, max_evict %d).\n", ways, sets,
+                randomized ? "randomized" : "set associative", maxEvict);
     }
 
-    void RiscVTLBCache::updatePLRUSet(uint32_t set, uint32_t way) {
-        // If entry to update is already MRU, then set does not have to be updated
-        if ( (cacheData[set][way].entry).lruSeq == 1) return;
-        DPRINTF(RiscVTLBCache, "Update PLRU Set %d at way %d: Before %d %d %d %d\n", set, way, (cacheData[set][0].entry).lruSeq, (cacheData[set][1].entry).lruSeq, (cacheData[set][2].entry).lruSeq, (cacheData[set][3].entry).lruSeq);
+    void TLBCache::setCoalescing(unsigned pages) {
+        fatal_if(pages == 0 || pages > 16 || (pages & (pages - 1)) != 0,
+                 "%s: Pages per coalesced entry must be a power of two up "
+                 "to 16, not %d.\n", name(), pages);
+        coalesceShift = 0;
+        while ((1U << coalesceShift) < pages)
+            coalesceShift++;
+
+        // Entries were indexed by page, not by group
+        for(unsigned i=0; i<sets; i++)
+            for(unsigned j=0; j<ways; j++)
+                cacheData[i][j].valid = false;
+        flushVictims();
+    }
 
-        // Set entry to MRU
-        (cacheData[set][way].entry).lruSeq = 1;
+    Addr TLBCache::groupBase(Addr va) const {
+        return va & ~mask(groupBits());
+    }
 
-        // Mark entry seen
-        uint8_t sawIndex = 0;
-        sawIndex ^= (1 << way);
+    TlbEntry *TLBCache::pageOf(const TlbEntry &group, Addr va) {
+        pageEntry = group;
+        pageEntry.vaddr = (va >> PageShift) << PageShift;
+        pageEntry.paddr += (pageEntry.vaddr - group.vaddr) >> PageShift;
+        return &pageEntry;
+    }
 
-        bool found = false;
+    void TLBCache::randomize(Addr va, unsigned logBytes, uint64_t process_id, uint64_t* set_arr) const {
+        uint64_t key = prince_key ^ process_id ^ random_id[process_id];
+        if (indexFunction)
+            indexFunction->wayIndices(va, logBytes, key, ways, setBits,
+                                      set_arr);
+        else
+            Prince::wayIndices(va, key, ways, setBits, set_arr);
+    }
 
-        // Search
-        for(uint32_t i = 0; i < ways; i++) {
-            if ( (sawIndex & (1 << i)) != 0 ) continue;
+    void TLBCache::setIndexFunction(const IndexFunction *function) {
+        indexFunction = function;
+        for(unsigned i=0; i<sets; i++)
+            for(unsigned j=0; j<ways; j++)
+                cacheData[i][j].valid = false;
+        flushVictims();
+    }
 
-            if (( cacheData[set][i].entry).lruSeq == 1) {
-                ( cacheData[set][i].entry).lruSeq = 2;
-                sawIndex ^= (1 << i);
-                found = true;
-                break;
-            }
+    void TLBCache::setKey(uint64_t key) {
+        prince_key = key;
+        for(unsigned i=0; i<sets; i++)
+            for(unsigned j=0; j<ways; j++)
+                cacheData[i][j].valid = false;
+        flushVictims();
+    }
+
+    void TLBCache::getSets(Addr va, unsigned logBytes, uint16_t asid, uint64_t* set_arr) const {
+        if (randomized || indexFunction) {
+            randomize(va, logBytes, (uint64_t) asid, set_arr);
+        } else {
+            for(unsigned i = 0; i < ways; i++)
+                set_arr[i] = (va >> logBytes) % sets;
         }
+    }
 
-        if (found == false) assert(false); // should not happen
-        found = false;
+    void TLBCache::updatePLRUSet(uint32_t set, uint32_t way) {
+        // If entry to update is already MRU, then set does not have to be updated
+        uint64_t old_seq = (cacheData[set][way].entry).lruSeq;
+        if (old_seq == 1) return;
+        DPRINTF(RiscVTLBCache, "Update PLRU Set %d at way %d (was %d)\n", set, way, old_seq);
 
+        // Every way that was more recently used than this one ages by one
         for(uint32_t i = 0; i < ways; i++) {
-            if ( (sawIndex & (1 << i)) != 0 ) continue;
-            
-            if (( cacheData[set][i].entry).lruSeq == 2) {
-                ( cacheData[set][i].entry).lruSeq = 3;
-                sawIndex ^= (1 << i);
-                found = true;
-                break;
+            if (( cacheData[set][i].entry).lruSeq < old_seq) {
+                ( cacheData[set][i].entry).lruSeq++;
             }
         }
 
-        if (found == false) {
-            DPRINTF(RiscVTLBCache, "Update PLRU Set %d at way %d: After %d %d %d %d (early)\n", set, way, (cacheData[set][0].entry).lruSeq, (cacheData[set][1].entry).lruSeq, (cacheData[set][2].entry).lruSeq, (cacheData[set][3].entry).lruSeq);
-            return;
-        }
+        // Set entry to MRU
+        (cacheData[set][way].entry).lruSeq = 1;
+    }
 
-        for(uint32_t i = 0; i < ways; i++) {
-            if ( (sawIndex & (1 << i)) != 0 ) continue;
-            
-            if (( cacheData[set][i].entry).lruSeq == 3) {
-                ( cacheData[set][i].entry).lruSeq = 4;
-                break;
+    TlbEntry *TLBCache::lookupGroup(Addr va, uint16_t asid, HitInfo *info) {
+        const Addr group = groupBase(va);
+        const unsigned page = (va - group) >> PageShift;
+        uint64_t set_idx[MaxWays] = {0};
+
+        getSets(group, groupBits(), asid, set_idx);
+
+        for(unsigned i = 0; i < ways; i++) {
+            TLBMeta &meta = cacheData[ set_idx[i] ][i];
+            if (!meta.valid || meta.entry.logBytes != PageShift ||
+                meta.entry.vaddr != group || meta.entry.asid != asid ||
+                !bits(meta.coalesced, page)) {
+                continue;
+            }
+            DPRINTF(RiscVTLBCache, "(Lookup Group) Found page %d of %x in set %d, way %d\n", page, group, set_idx[i], i);
+            updatePLRUSet(set_idx[i], i);
+            if (info) {
+                info->prefetched = bits(meta.prefetched, page);
+                info->coalesced = !info->prefetched &&
+                                  !bits(meta.touched, page);
             }
+            meta.touched |= 1 << page;
+            meta.prefetched &= ~(1 << page);
+            return pageOf(meta.entry, va);
         }
-        DPRINTF(RiscVTLBCache, "Update PLRU Set %d at way %d: After %d %d %d %d\n", set, way, (cacheData[set][0].entry).lruSeq, (cacheData[set][1].entry).lruSeq, (cacheData[set][2].entry).lruSeq, (cacheData[set][3].entry).lruSeq);
+        return NULL;
     }
 
-    TlbEntry* RiscVTLBCache::lookup(Addr va, uint16_t asid) {
+    TlbEntry* TLBCache::lookup(Addr va, uint16_t asid, HitInfo *info) {
         DPRINTF(RiscVTLBCache, "(Lookup) Start Lookup for %x (%x)\n", va, ((va >> 12)<<12));
 
+        if (info)
+            *info = HitInfo();
+
         // Get rid of last 12 bits (4KB page)
         va = va >> 12;
         va = va << 12;
-        uint64_t sets[ways] = {0};
-
-        #ifndef SATLB
-        randomize(va,(uint64_t) asid,sets);
-        #else
-        sets[0] = (va >> 12) % 16;
-        sets[1] = (va >> 12) % 16;
-        sets[2] = (va >> 12) % 16;
-        sets[3] = (va >> 12) % 16;
-        #endif
-
-        for(int i = 0; i < ways; i++) {
-            DPRINTF(RiscVTLBCache, "(Lookup 4KB) Trying %x in way %d, set %d\n", va, i, sets[i]);
-            if(cacheData[ sets[i] ][i].valid == true){
-                if ((cacheData[ sets[i] ][i].entry).logBytes != 12){
-                    continue;
-                }
-                if(((cacheData[ sets[i] ][i].entry).vaddr) == va && ((cacheData[ sets[i] ][i].entry).asid) == asid) {
-                    DPRINTF(RiscVTLBCache, "(Lookup 4KB) Found %x in set %d, way %d\n",va, sets[i] , i);
-                    updatePLRUSet(sets[i],i);
-                    return &(cacheData[ sets[i] ][i].entry);
+        const Addr page_va = va;
+        uint64_t set_idx[MaxWays] = {0};
+
+        if (coalesceShift) {
+            TlbEntry *entry = lookupGroup(va, asid, info);
+            if (entry)
+                return entry;
+        } else {
+            getSets(va, 12, asid, set_idx);
+
+            for(unsigned i = 0; i < ways; i++) {
+                DPRINTF(RiscVTLBCache, "(Lookup 4KB) Trying %x in way %d, set %d\n", va, i, set_idx[i]);
+                if(cacheData[ set_idx[i] ][i].valid == true){
+                    if ((cacheData[ set_idx[i] ][i].entry).logBytes != 12){
+                        continue;
+                    }
+                    if(((cacheData[ set_idx[i] ][i].entry).vaddr) == va && ((cacheData[ set_idx[i] ][i].entry).asid) == asid) {
+                        DPRINTF(RiscVTLBCache, "(Lookup 4KB) Found %x in set %d, way %d\n",va, set_idx[i] , i);
+                        updatePLRUSet(set_idx[i],i);
+                        if (info)
+                            info->prefetched = cacheData[ set_idx[i] ][i].prefetched;
+                        cacheData[ set_idx[i] ][i].prefetched = 0;
+                        return &(cacheData[ set_idx[i] ][i].entry);
+                    }
                 }
-            } 
+            }
         }
 
         // Get rid of last 21 bits (large page)
         va = va >> 21;
         va = va << 21;
 
-        #ifndef SATLB
-        randomize(va,(uint64_t) asid,sets);
-        #else
-        sets[0] = (va >> 21) % 16;
-        sets[1] = (va >> 21) % 16;
-        sets[2] = (va >> 21) % 16;
-        sets[3] = (va >> 21) % 16;
-        #endif
-
-        for(int i = 0; i < ways; i++) {
-            DPRINTF(RiscVTLBCache, "(Lookup Huge) Trying %x in way %d, set %d\n", va, i, sets[i]);
-            if(cacheData[ sets[i] ][i].valid == true){
-                if ((cacheData[ sets[i] ][i].entry).logBytes != 21){
-                    if((cacheData[ sets[i] ][i].entry).logBytes != 12){
-                        DPRINTF(RiscVTLBCache, "Size is %d\n", (cacheData[ sets[i] ][i].entry).logBytes);
+        getSets(va, 21, asid, set_idx);
+
+        for(unsigned i = 0; i < ways; i++) {
+            DPRINTF(RiscVTLBCache, "(Lookup Huge) Trying %x in way %d, set %d\n", va, i, set_idx[i]);
+            if(cacheData[ set_idx[i] ][i].valid == true){
+                if ((cacheData[ set_idx[i] ][i].entry).logBytes != 21){
+                    if((cacheData[ set_idx[i] ][i].entry).logBytes != 12){
+                        DPRINTF(RiscVTLBCache, "Size is %d\n", (cacheData[ set_idx[i] ][i].entry).logBytes);
                         assert(false);
                     }
                     continue;
                 }
-                if(((cacheData[ sets[i] ][i].entry).vaddr) == va && ((cacheData[ sets[i] ][i].entry).asid) == asid) {
-                    DPRINTF(RiscVTLBCache, "(Lookup Huge) Found %x in set %d, way %d\n",va, sets[i] , i);
-                    updatePLRUSet(sets[i],i);
-                    return &(cacheData[ sets[i] ][i].entry);
+                if(((cacheData[ set_idx[i] ][i].entry).vaddr) == va && ((cacheData[ set_idx[i] ][i].entry).asid) == asid) {
+                    DPRINTF(RiscVTLBCache, "(Lookup Huge) Found %x in set %d, way %d\n",va, set_idx[i] , i);
+                    updatePLRUSet(set_idx[i],i);
+                    return &(cacheData[ set_idx[i] ][i].entry);
                 }
-            }  
+            }
         }
 
+        return lookupVictim(page_va, asid, info);
+    }
+
+    bool TLBCache::victimMaps(const VictimMeta &victim, Addr va,
+                              uint16_t asid) const {
+        const TLBMeta &meta = victim.meta;
+        if (!meta.valid || meta.entry.asid != asid)
+            return false;
+        if (victimRandomized && victim.rid != random_id[asid])
+            return false;
+        if (coalesceShift && meta.entry.logBytes == PageShift) {
+            return groupBase(va) == meta.entry.vaddr &&
+                   bits(meta.coalesced, (va - meta.entry.vaddr) >> PageShift);
+        }
+        return (va & ~mask(meta.entry.logBytes)) == meta.entry.vaddr;
+    }
+
+    bool TLBCache::addVictim(const TLBMeta &meta) {
+        if (victims.empty())
+            return false;
+
+        // Replace an invalid or else the oldest victim
+        VictimMeta *slot = &victims[0];
+        for (auto &victim : victims) {
+            if (!victim.meta.valid) {
+                slot = &victim;
+                break;
+            }
+            if (victim.seq < slot->seq)
+                slot = &victim;
+        }
+        *slot = {meta, random_id[meta.entry.asid], ++victimSeq};
+        slot->meta.valid = true;
+        DPRINTF(RiscVTLBCache, "(Victim) Buffered %x with asid %x\n",
+                meta.entry.vaddr, meta.entry.asid);
+        return true;
+    }
+
+    TlbEntry *TLBCache::lookupVictim(Addr va, uint16_t asid,
+                                     HitInfo *info) {
+        for (auto &victim : victims) {
+            if (!victimMaps(victim, va, asid))
+                continue;
+
+            TLBMeta meta = victim.meta;
+            victim.meta.valid = false;
+            DPRINTF(RiscVTLBCache, "(Lookup Victim) Found %x, swapping it "
+                    "back\n", va);
+
+            const bool grouped =
+                coalesceShift && meta.entry.logBytes == PageShift;
+            const unsigned page =
+                grouped ? (va - meta.entry.vaddr) >> PageShift : 0;
+            if (info) {
+                info->prefetched = bits(meta.prefetched, page);
+                info->coalesced = grouped && !info->prefetched &&
+                                  !bits(meta.touched, page);
+                info->victim = true;
+            }
+            meta.touched |= grouped ? 1 << page : 0;
+            meta.prefetched &= ~(1 << page);
+
+            TlbEntry *entry = fill(meta.entry.vaddr,
+                                   grouped ? groupBits() : meta.entry.logBytes,
+                                   meta.entry, meta.coalesced, meta.touched,
+                                   meta.prefetched,
+                                   info ? &info->swap : nullptr);
+            return grouped ? pageOf(*entry, va) : entry;
+        }
         return NULL;
     }
 
-    TlbEntry* RiscVTLBCache::insert(Addr vpn, TlbEntry entry){
+    unsigned TLBCache::demapVictims(Addr va, uint64_t asn, bool any_va) {
+        unsigned dropped = 0;
+        for (auto &victim : victims) {
+            const TLBMeta &meta = victim.meta;
+            if (!meta.valid || (asn != 0 && meta.entry.asid != asn))
+                continue;
+            // Coalesced entries are dropped as a whole
+            const unsigned tag_bits = coalesceShift &&
+                meta.entry.logBytes == PageShift ? groupBits()
+                                                 : meta.entry.logBytes;
+            if (!any_va && (va & ~mask(tag_bits)) != meta.entry.vaddr)
+                continue;
+            victim.meta.valid = false;
+            dropped++;
+        }
+        return dropped;
+    }
+
+    void TLBCache::flushVictims() {
+        for (auto &victim : victims)
+            victim.meta.valid = false;
+    }
+
+    void TLBCache::setVictimBuffer(unsigned entries, bool randomized) {
+        fatal_if(entries > 16, "%s: The victim buffer holds at most 16 "
+                 "entries, not %d.\n", name(), entries);
+        victims.assign(entries, VictimMeta{});
+        flushVictims();
+        victimRandomized = randomized;
+    }
+
+    bool TLBCache::holds(Addr va, uint16_t asid) const {
+        va &= ~mask(PageShift);
+        const Addr group = groupBase(va);
+        const unsigned page = (va - group) >> PageShift;
+        uint64_t set_idx[MaxWays] = {0};
+
+        getSets(group, groupBits(), asid, set_idx);
+        for(unsigned i = 0; i < ways; i++) {
+            const TLBMeta &meta = cacheData[ set_idx[i] ][i];
+            if (meta.valid && meta.entry.logBytes == PageShift &&
+                meta.entry.vaddr == group && meta.entry.asid == asid &&
+                (!coalesceShift || bits(meta.coalesced, page))) {
+                return true;
+            }
+        }
+        for (const auto &victim : victims) {
+            if (victim.meta.entry.logBytes == PageShift &&
+                victimMaps(victim, va, asid)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t TLBCache::lookupBanks(Addr va, uint16_t asid, unsigned num_banks) {
+        uint64_t set_idx[MaxWays] = {0};
+        getSets(groupBase(va), groupBits(), asid, set_idx);
+
+        uint64_t banks = 0;
+        for(unsigned i = 0; i < ways; i++)
+            banks |= 1ULL << (set_idx[i] % num_banks);
+        return banks;
+    }
+
+    void TLBCache::wayIndices(Addr va, uint16_t asid,
+                              uint64_t *set_arr) const {
+        getSets(groupBase(va), groupBits(), asid, set_arr);
+    }
+
+    TlbEntry* TLBCache::insert(Addr vpn, TlbEntry entry, InsertResult *result,
+                               uint16_t coalesced, bool prefetch){
+        if (coalesceShift && entry.logBytes == PageShift)
+            return insertGroup(vpn, entry, coalesced, prefetch, result);
 
         // Get rid of last x bits (large or small page)
         uint64_t addr = vpn >> entry.logBytes;
         addr = addr << entry.logBytes;
         DPRINTF(RiscVTLBCache, "(Insert) Start inserting %x with asid %x (%x)\n", vpn,entry.asid,addr);
 
-        uint64_t sets[ways] = {0};
-        #ifndef SATLB
-        randomize(addr, (uint64_t) entry.asid, sets);
-        #else
-        sets[0] = (vpn >> entry.logBytes) % 16;
-        sets[1] = (vpn >> entry.logBytes) % 16;
-        sets[2] = (vpn >> entry.logBytes) % 16;
-        sets[3] = (vpn >> entry.logBytes) % 16;
-        #endif
+        return fill(addr, entry.logBytes, entry, 0, 0, prefetch, result);
+    }
+
+    TlbEntry *TLBCache::insertGroup(Addr vpn, TlbEntry entry,
+                                    uint16_t coalesced, bool prefetch,
+                                    InsertResult *result) {
+        const Addr group = groupBase(vpn);
+        const unsigned page = (vpn - group) >> PageShift;
+        const uint16_t pages =
+            (coalesced | (1 << page)) & mask(coalescePages());
+        entry.vaddr = group;
+        entry.paddr -= page;
+        DPRINTF(RiscVTLBCache, "(Insert Group) Start inserting pages %#x of %x with asid %x\n", pages, group, entry.asid);
+
+        uint64_t set_idx[MaxWays] = {0};
+        getSets(group, groupBits(), entry.asid, set_idx);
+
+        for(unsigned i = 0; i < ways; i++) {
+            TLBMeta &meta = cacheData[ set_idx[i] ][i];
+            if (!meta.valid || meta.entry.logBytes != PageShift ||
+                meta.entry.vaddr != group || meta.entry.asid != entry.asid) {
+                continue;
+            }
+            // The PTE holds the PPN of the page that was walked, which
+            // paddr already compares as the frame of the group
+            if (meta.entry.paddr == entry.paddr &&
+                bits((uint64_t)meta.entry.pte, 7, 0) ==
+                bits((uint64_t)entry.pte, 7, 0)) {
+                // Same frames and flags, extend the existing entry
+                if (!prefetch) {
+                    meta.touched |= 1 << page;
+                    meta.prefetched &= ~(1 << page);
+                } else if (!bits(meta.coalesced | meta.touched, page)) {
+                    meta.prefetched |= 1 << page;
+                }
+                meta.coalesced |= pages;
+                updatePLRUSet(set_idx[i], i);
+                if (result)
+                    *result = {false, false, 0, 0, false};
+                return pageOf(meta.entry, vpn);
+            }
+            // The mapping of these pages changed (e.g. they became
+            // dirty), the new entry supersedes them
+            meta.coalesced &= ~pages;
+            meta.touched &= ~pages;
+            meta.prefetched &= ~pages;
+            if (!meta.coalesced)
+                meta.valid = false;
+        }
+
+        return pageOf(*fill(group, groupBits(), entry, pages,
+                            prefetch ? 0 : 1 << page,
+                            prefetch ? 1 << page : 0, result), vpn);
+    }
+
+    TlbEntry *TLBCache::fill(Addr addr, unsigned index_bits,
+                             const TlbEntry &entry, uint16_t coalesced,
+                             uint16_t touched, uint16_t prefetched,
+                             InsertResult *result) {
+        uint64_t set_idx[MaxWays] = {0};
+        getSets(addr, index_bits, entry.asid, set_idx);
+
+        InsertResult res = {false, false, 0, 0, false};
+        const uint16_t way_mask = fillWays(entry.asid);
 
         // Look if we find an invalid entry already
         int32_t wayIndex = -1;
-        for(int i = 0; i < ways; i++) {
-            if(cacheData[ sets[i] ][i].valid == false) {
+        for(unsigned i = 0; i < ways; i++) {
+            if(bits(way_mask, i) && cacheData[ set_idx[i] ][i].valid == false) {
                 wayIndex = i;
                 break;
             }
         }
 
-        #ifndef SATLB
         // If not, rerandomize and check again
-        if (wayIndex == -1) {
+        if (wayIndex == -1 && randomized && maxEvict != 0) {
             evict_cnt[entry.asid]++;
-            if(evict_cnt[entry.asid] == MAX_EVICT) {
+            if(evict_cnt[entry.asid] == maxEvict) {
                 rerand_requests++;
+                res.rerandomized = true;
                 evict_cnt[entry.asid] = 0;
                 random_id[entry.asid]++; // Worst case rid selection (just incrementing from 0)
-                randomize(addr, (uint64_t) entry.asid, sets);
-                for(int i = 0; i < ways; i++) {
-                    if(cacheData[ sets[i] ][i].valid == false) {
+                randomize(addr, index_bits, (uint64_t) entry.asid, set_idx);
+                for(unsigned i = 0; i < ways; i++) {
+                    if(bits(way_mask, i) && cacheData[ set_idx[i] ][i].valid == false) {
                         wayIndex = i;
                         break;
                     }
                 }
             }
         }
-        #endif
 
         // We will did not find any invalid entry. Evict LRU.
         if (wayIndex == -1) {
-            wayIndex = evict(sets);
+            wayIndex = evict(set_idx, way_mask);
+            res.evicted = true;
+            res.evictedAsid = (cacheData[ set_idx[wayIndex] ][wayIndex].entry).asid;
+            res.evictedUnused = popCount(cacheData[ set_idx[wayIndex] ][wayIndex].prefetched);
+            res.victimFilled = addVictim(cacheData[ set_idx[wayIndex] ][wayIndex]);
         };
 
-        uint32_t temp_lru = (cacheData[ sets[wayIndex] ][wayIndex].entry).lruSeq;
+        if (result)
+            *result = res;
 
-        cacheData[ sets[wayIndex] ][wayIndex].entry = entry;
-        cacheData[ sets[wayIndex] ][wayIndex].valid = true;
+        uint32_t temp_lru = (cacheData[ set_idx[wayIndex] ][wayIndex].entry).lruSeq;
 
-        (cacheData[ sets[wayIndex] ][wayIndex].entry).lruSeq = temp_lru;
-        updatePLRUSet(sets[wayIndex], wayIndex);
+        cacheData[ set_idx[wayIndex] ][wayIndex].entry = entry;
+        cacheData[ set_idx[wayIndex] ][wayIndex].valid = true;
+        cacheData[ set_idx[wayIndex] ][wayIndex].coalesced = coalesced;
+        cacheData[ set_idx[wayIndex] ][wayIndex].touched = touched;
+        cacheData[ set_idx[wayIndex] ][wayIndex].prefetched = prefetched;
 
-        DPRINTF(RiscVTLBCache, "(Insert) Inserted %x in set %d and way %d\n",vpn, sets[wayIndex] , wayIndex);
-        return &(cacheData[ sets[wayIndex] ][wayIndex].entry);
+        (cacheData[ set_idx[wayIndex] ][wayIndex].entry).lruSeq = temp_lru;
+        updatePLRUSet(set_idx[wayIndex], wayIndex);
+
+        DPRINTF(RiscVTLBCache, "(Insert) Inserted %x in set %d and way %d\n",addr, set_idx[wayIndex] , wayIndex);
+        return &(cacheData[ set_idx[wayIndex] ][wayIndex].entry);
     }
 
-    uint8_t RiscVTLBCache::evict(uint64_t* set_arr){
+    uint8_t TLBCache::evict(uint64_t* set_arr, uint16_t way_mask){
         // Evict if no free index found
-        uint8_t wayIndex = 0;
-        for(int i = 1; i < ways; i++) {
+        way_mask &= mask(ways);
+        assert(way_mask);
+        uint8_t wayIndex = findLsbSet(way_mask);
+        for(unsigned i = wayIndex + 1; i < ways; i++) {
+            if(!bits(way_mask, i))
+                continue;
             if(cacheData[ set_arr[i] ][i].valid == true && (cacheData[ set_arr[i] ][i].entry).lruSeq > (cacheData[ set_arr[wayIndex] ][wayIndex].entry).lruSeq) {
                 wayIndex = i;
             }
@@ -247,96 +548,284 @@ namespace RiscvISA {
         return wayIndex;
     }
 
-    void RiscVTLBCache::flushAll(){
+    unsigned TLBCache::flushAll(){
         rerand_requests++;
+        unsigned dropped = 0;
         for(int i = 0; i < (1<<16); i++) {
             random_id[i]++;
             evict_cnt[i] = 0;
         }
-        for(uint8_t i=0; i<sets; i++){
-            for(uint8_t j=0; j<ways; j++){
+        for(unsigned i=0; i<sets; i++){
+            for(unsigned j=0; j<ways; j++){
+                dropped += cacheData[i][j].valid;
                 cacheData[i][j].valid = false;
             }
         }
+        return dropped + demapVictims(0, 0, true);
     }
 
-    void RiscVTLBCache::demapPage(Addr va, uint64_t asn){
-        DPRINTF(RiscVTLBCache, "(Demap) Starting demapping of %x\n",va); 
-        // Get rid of last 12 bits (4KB page)   
+    unsigned TLBCache::demapPage(Addr va, uint64_t asn){
+        DPRINTF(RiscVTLBCache, "(Demap) Starting demapping of %x\n",va);
+        // Get rid of last 12 bits (4KB page)
         va = va >> 12;
         va = va << 12;
+        const unsigned victims_dropped = demapVictims(va, asn, false);
 
-        uint64_t sets[ways] = {0};
+        uint64_t set_idx[MaxWays] = {0};
 
-        #ifndef SATLB
-        randomize(va,asn,sets);
-        #else
-        sets[0] = (va >> 12) % 16;
-        sets[1] = (va >> 12) % 16;
-        sets[2] = (va >> 12) % 16;
-        sets[3] = (va >> 12) % 16;
-        #endif
+        // With coalescing, 4KiB pages are indexed and tagged by group
+        const Addr group = groupBase(va);
+        getSets(group, groupBits(), (uint16_t) asn, set_idx);
 
-        for(int i = 0; i < ways; i++) {
-            if(cacheData[ sets[i] ][i].valid == true){
-                if ((cacheData[ sets[i] ][i].entry).logBytes != 12){
+        for(unsigned i = 0; i < ways; i++) {
+            if(cacheData[ set_idx[i] ][i].valid == true){
+                if ((cacheData[ set_idx[i] ][i].entry).logBytes != 12){
                     continue;
                 }
 
-                if(((cacheData[ sets[i] ][i].entry).vaddr) == va && ((cacheData[ sets[i] ][i].entry).asid) == ( (uint16_t) asn)) {
-                    DPRINTF(RiscVTLBCache, "(Demap) Found %x in set %d, way %d\n",va,sets[i],i);
-                    cacheData[sets[i]][i].valid = false;
-                    return;
+                if(((cacheData[ set_idx[i] ][i].entry).vaddr) == group && ((cacheData[ set_idx[i] ][i].entry).asid) == ( (uint16_t) asn)) {
+                    if (coalesceShift) {
+                        if (demapGroupPage(cacheData[set_idx[i]][i], va))
+                            return 1 + victims_dropped;
+                        continue;
+                    }
+                    DPRINTF(RiscVTLBCache, "(Demap) Found %x in set %d, way %d\n",va,set_idx[i],i);
+                    cacheData[set_idx[i]][i].valid = false;
+                    return 1 + victims_dropped;
                 }
-            }  
+            }
         }
 
         // Get rid of last 21 bits (large page)
         va = va >> 21;
         va = va << 21;
-        
-        #ifndef SATLB
-        randomize(va,asn,sets);
-        #else
-        sets[0] = (va >> 21) % 16;
-        sets[1] = (va >> 21) % 16;
-        sets[2] = (va >> 21) % 16;
-        sets[3] = (va >> 21) % 16;
-        #endif 
-
-
-        for(int i = 0; i < ways; i++) {
-            if(cacheData[ sets[i] ][i].valid == true){
-                if ((cacheData[ sets[i] ][i].entry).logBytes != 21){
-                    if((cacheData[ sets[i] ][i].entry).logBytes != 12){
-                        DPRINTF(RiscVTLBCache, "Size is %d\n", (cacheData[ sets[i] ][i].entry).logBytes);
+
+        getSets(va, 21, (uint16_t) asn, set_idx);
+
+        for(unsigned i = 0; i < ways; i++) {
+            if(cacheData[ set_idx[i] ][i].valid == true){
+                if ((cacheData[ set_idx[i] ][i].entry).logBytes != 21){
+                    if((cacheData[ set_idx[i] ][i].entry).logBytes != 12){
+                        DPRINTF(RiscVTLBCache, "Size is %d\n", (cacheData[ set_idx[i] ][i].entry).logBytes);
                         assert(false);
                     }
                     continue;
                 }
 
-                if(((cacheData[ sets[i] ][i].entry).vaddr) == va && ((cacheData[ sets[i] ][i].entry).asid) == ( (uint16_t) asn)) {
-                    DPRINTF(RiscVTLBCache, "(Demap Huge) Found %x in set %d, way %d\n",va,sets[i],i);
-                    cacheData[ sets[i] ][i].valid = false;
-                    return;
+                if(((cacheData[ set_idx[i] ][i].entry).vaddr) == va && ((cacheData[ set_idx[i] ][i].entry).asid) == ( (uint16_t) asn)) {
+                    DPRINTF(RiscVTLBCache, "(Demap Huge) Found %x in set %d, way %d\n",va,set_idx[i],i);
+                    cacheData[ set_idx[i] ][i].valid = false;
+                    return 1 + victims_dropped;
                 }
-            }  
+            }
         }
+        return victims_dropped;
     }
 
-    void RiscVTLBCache::demapPageComplex(Addr va, uint64_t asn) {
+    unsigned TLBCache::demapPageComplex(Addr va, uint64_t asn) {
          asn &= 0xFFFF;
-         for(uint8_t i=0; i<sets; i++){
-            for(uint8_t j=0; j<ways; j++){
+         unsigned dropped = 0;
+         for(unsigned i=0; i<sets; i++){
+            for(unsigned j=0; j<ways; j++){
+                TLBMeta &meta = cacheData[i][j];
+                if (coalesceShift && va != 0 && meta.valid &&
+                    meta.entry.logBytes == PageShift) {
+                    if ((asn == 0 || meta.entry.asid == asn) &&
+                        groupBase(va) == meta.entry.vaddr) {
+                        dropped += demapGroupPage(meta, va);
+                    }
+                    continue;
+                }
                 Addr mask = ~( (cacheData[i][j].entry).size() - 1);
                 if ((va == 0 || (va & mask) == (cacheData[i][j].entry).vaddr) && (asn == 0 || (cacheData[i][j].entry).asid == asn)) {
+                    dropped += cacheData[i][j].valid;
                     cacheData[i][j].valid = false;
                 }
             }
         }
+        return dropped + demapVictims(va, asn, va == 0);
+    }
+
+    unsigned TLBCache::demapGroupPage(TLBMeta &meta, Addr va) {
+        const unsigned page = (va - meta.entry.vaddr) >> PageShift;
+        if (!bits(meta.coalesced, page))
+            return 0;
+        DPRINTF(RiscVTLBCache, "(Demap) Dropping page %d of group %x\n", page, meta.entry.vaddr);
+        meta.coalesced &= ~(1 << page);
+        meta.touched &= ~(1 << page);
+        meta.prefetched &= ~(1 << page);
+        if (!meta.coalesced)
+            meta.valid = false;
+        return 1;
+    }
+
+    uint64_t TLBCache::reach() const {
+        uint64_t bytes = 0;
+        for(unsigned i=0; i<sets; i++){
+            for(unsigned j=0; j<ways; j++){
+                const TLBMeta &meta = cacheData[i][j];
+                if (!meta.valid)
+                    continue;
+                const unsigned pages =
+                    meta.coalesced ? popCount(meta.coalesced) : 1;
+                bytes += pages * meta.entry.size();
+            }
+        }
+        return bytes;
+    }
+
+    uint16_t TLBCache::fillWays(uint16_t asid) const {
+        if (domainWays.empty())
+            return mask(ways);
+        return domainWays[asid_domain[asid]];
+    }
+
+    void TLBCache::setDomains(unsigned num_domains,
+                              const std::vector<unsigned> &partition_ways) {
+        fatal_if(num_domains == 0 || num_domains > MaxWays,
+                 "%s: The TLB supports 1 to %d domains, not %d.\n",
+                 name(), MaxWays, num_domains);
+        fatal_if(!partition_ways.empty() &&
+                 partition_ways.size() != num_domains,
+                 "%s: Got ways for %d partitions but %d domains.\n",
+                 name(), partition_ways.size(), num_domains);
+
+        domains = num_domains;
+        domainWays.clear();
+        unsigned first = 0;
+        for (unsigned count : partition_ways) {
+            fatal_if(count == 0, "%s: Every TLB partition needs a way.\n",
+                     name());
+            domainWays.push_back(mask(count) << first);
+            first += count;
+        }
+        fatal_if(partitioned() && first != ways,
+                 "%s: The TLB partitions have %d ways, not %d.\n", name(),
+                 first, ways);
+
+        std::fill(std::begin(asid_domain), std::end(asid_domain), 0);
+        for(unsigned i=0; i<sets; i++)
+            for(unsigned j=0; j<ways; j++)
+                cacheData[i][j].valid = false;
+        flushVictims();
+        DPRINTF(RiscVTLBCache, "%d domains, %s\n", domains,
+                partitioned() ? "way-partitioned" : "sharing all ways");
+    }
+
+    void TLBCache::setAsidDomain(uint16_t asid, unsigned domain) {
+        fatal_if(domain >= domains, "%s: Cannot put ASID %d in domain %d, "
+                 "there are %d domains.\n", name(), asid, domain, domains);
+        asid_domain[asid] = domain;
     }
 
-    uint64_t RiscVTLBCache::getRerandRequestCount() {
+    unsigned TLBCache::occupancy(unsigned domain) const {
+        unsigned entries = 0;
+        for(unsigned i=0; i<sets; i++)
+            for(unsigned j=0; j<ways; j++)
+                entries += cacheData[i][j].valid &&
+                           asid_domain[cacheData[i][j].entry.asid] == domain;
+        return entries;
+    }
+
+    unsigned TLBCache::validEntries() const {
+        unsigned entries = 0;
+        for(unsigned i=0; i<sets; i++)
+            for(unsigned j=0; j<ways; j++)
+                entries += cacheData[i][j].valid;
+        return entries;
+    }
+
+    void TLBCache::takeOverFrom(const TLBCache &old) {
+        fatal_if(old.ways != ways || old.sets != sets,
+                 "%s: Cannot take over the entries of %s, it has %d ways "
+                 "and %d sets instead of %d and %d.\n", name(), old.name(),
+                 old.ways, old.sets, ways, sets);
+        fatal_if(old.coalesceShift != coalesceShift,
+                 "%s: Cannot take over the entries of %s, it coalesces %d "
+                 "pages per entry instead of %d.\n", name(), old.name(),
+                 old.coalescePages(), coalescePages());
+        fatal_if(old.domains != domains,
+                 "%s: Cannot take over the entries of %s, it has %d "
+                 "domains instead of %d.\n", name(), old.name(),
+                 old.domains, domains);
+        fatal_if(old.domainWays != domainWays,
+                 "%s: Cannot take over the entries of %s, its ways are "
+                 "partitioned differently.\n", name(), old.name());
+        auto index_name = [](const TLBCache &cache) -> std::string {
+            if (cache.indexFunction)
+                return cache.indexFunction->name();
+            return cache.randomized ? "prince" : "identity";
+        };
+        fatal_if(index_name(old) != index_name(*this),
+                 "%s: Cannot take over the entries of %s, it indexes its "
+                 "sets with %s instead of %s.\n", name(), old.name(),
+                 index_name(old), index_name(*this));
+        fatal_if(old.randomized != randomized || old.maxEvict != maxEvict,
+                 "%s: Cannot take over the entries of %s, it %s after %d "
+                 "evictions instead of %s after %d.\n", name(), old.name(),
+                 old.randomized ? "rerandomizes" : "does not rerandomize",
+                 old.maxEvict,
+                 randomized ? "rerandomizing" : "not rerandomizing",
+                 maxEvict);
+        fatal_if(old.victims.size() != victims.size() ||
+                 old.victimRandomized != victimRandomized,
+                 "%s: Cannot take over the entries of %s, it has %d "
+                 "victim buffer entries (%srandomized) instead of %d "
+                 "(%srandomized).\n", name(), old.name(),
+                 old.victims.size(), old.victimRandomized ? "" : "not ",
+                 victims.size(), victimRandomized ? "" : "not ");
+
+        for(unsigned i=0; i<sets; i++)
+            std::copy(old.cacheData[i], old.cacheData[i] + ways,
+                      cacheData[i]);
+
+        prince_key = old.prince_key;
+        std::copy(std::begin(old.random_id), std::end(old.random_id),
+                  std::begin(random_id));
+        std::copy(std::begin(old.evict_cnt), std::end(old.evict_cnt),
+                  std::begin(evict_cnt));
+        rerand_requests = old.rerand_requests;
+        std::copy(std::begin(old.asid_domain), std::end(old.asid_domain),
+                  std::begin(asid_domain));
+        victims = old.victims;
+        victimSeq = old.victimSeq;
+    }
+
+    uint64_t TLBCache::getRerandRequestCount() {
         return rerand_requests;
     }
-}
\ No newline at end of file
+
+    RiscVTLBCache::RiscVTLBCache(const RiscVTLBCacheParams &params) :
+    SimObject(params),
+#ifndef SATLB
+    TLBCache(params.name, params.ways, params.sets, params.max_evict,
+             params.randomized),
+#else
+    TLBCache(params.name, params.ways, params.sets, params.max_evict, false),
+#endif
+    index(params.index)
+    {
+        setCoalescing(params.coalesce_pages);
+        setDomains(params.domains, params.partition_ways);
+        setVictimBuffer(params.victim_entries, params.victim_randomized);
+        if (index)
+            setIndexFunction(&index->function());
+        fatal_if(params.asid_domains.size() > (1 << 16),
+                 "%s: asid_domains lists more than 65536 ASIDs.\n", name());
+        for (unsigned asid = 0; asid < params.asid_domains.size(); asid++)
+            TLBCache::setAsidDomain(asid, params.asid_domains[asid]);
+    }
+
+    void RiscVTLBCache::reconfigure(unsigned num_ways, unsigned num_sets,
+                                    uint32_t max_evict, bool randomized) {
+        TLBCache::reconfigure(num_ways, num_sets, max_evict, randomized);
+    }
+
+    void RiscVTLBCache::setAsidDomain(uint16_t asid, unsigned domain) {
+        TLBCache::setAsidDomain(asid, domain);
+    }
+
+    Cycles RiscVTLBCache::indexLatency() const {
+        return index ? index->latency() : Cycles(0);
+    }
+}
@@ -1,28 +1,68 @@
 #ifndef __ARCH_RISCV_TLBCache_HH__
 #define __ARCH_RISCV_TLBCache_HH__
 
+#include <string>
+#include <vector>
+
 #include "debug/RiscVTLBCache.hh"
 
 #include "arch/generic/tlb.hh"
+#include "arch/riscv/index_function.hh"
 #include "arch/riscv/isa.hh"
 #include "arch/riscv/isa_traits.hh"
 #include "arch/riscv/pagetable.hh"
 #include "arch/riscv/pma_checker.hh"
+#include "arch/riscv/prince.hh"
 #include "arch/riscv/utility.hh"
 #include "base/statistics.hh"
 #include "mem/request.hh"
 
+#include "arch/riscv/tlb_index.hh"
 #include "params/RiscVTLBCache.hh"
 #include "sim/sim_object.hh"
 
+// Default miss threshold
+#define MAX_EVICT 64
+
+// Enable set assosciative TLB instead
+// #define SATLB 1
+
 namespace RiscvISA {
-    class RiscVTLBCache : public SimObject {
-        private:
-            uint8_t ways, sets;
+    /**
+     * The TLB array itself (randomized or set associative) without any
+     * simulator plumbing, so it can also be driven by standalone tools
+     * such as the trace-driven TLB simulator. RiscVTLBCache wraps it as a
+     * SimObject.
+     */
+    class TLBCache {
+        public:
+            // Upper bound for the associativity
+            static const unsigned MaxWays = 16;
+
+        protected:
+            std::string _name;
+            unsigned ways, sets;
+            unsigned setBits;
+            bool randomized;
+            uint32_t maxEvict;
 
             struct TLBMeta { 
                 bool valid; 
                 TlbEntry entry;
+                /**
+                 * With coalescing, 4KiB entries map an aligned group of
+                 * pages: entry.vaddr is the group base, entry.paddr the
+                 * frame of its first page, and bit i of coalesced is set
+                 * if page i of the group is mapped. touched marks the
+                 * pages that were walked or have hit since.
+                 */
+                uint16_t coalesced;
+                uint16_t touched;
+                /**
+                 * Pages (bit 0 without coalescing) the walker installed
+                 * from a neighbouring PTE that have not hit yet.
+                 */
+                uint16_t prefetched;
             };
 
             TLBMeta **cacheData;
@@ -34,128 +74,249 @@ namespace RiscvISA {
             uint64_t rerand_requests;
             uint64_t global_page_max; // unused
 
-            static uint8_t prince_sbox(uint8_t index){
-                const uint8_t sbox[] = {0xB, 0xF, 0x3, 0x2, 0xA, 0xC, 0x9, 0x1, 0x6, 0x7, 0x8, 0x0, 0xE, 0x5, 0xD, 0x4};  
-                return sbox[index & 0xF];
-            }
+            // log2 of the pages per coalesced entry, 0 disables coalescing
+            unsigned coalesceShift;
+            // Per-page copy of a coalesced entry returned by lookups
+            TlbEntry pageEntry;
 
-            static uint8_t prince_sbox_inv(uint8_t index){
-                const uint8_t sbox_inv[] = {0xB, 0x7, 0x3, 0x2, 0xF, 0xD, 0x8, 0x9, 0xA, 0x6, 0x4, 0x0, 0x5, 0xE, 0xC, 0x1};
-                return sbox_inv[index & 0xF];
-            }
+            // Security/QoS domain of every ASID (0 unless assigned)
+            unsigned domains;
+            uint8_t asid_domain[1 << 16] = {0};
+            // Ways each domain may fill, empty if all domains share them
+            std::vector<uint16_t> domainWays;
 
-            static uint64_t gf2_mul_16(const uint64_t in, const uint32_t mat[16]){
-                uint64_t out = 0;
-                uint8_t i;
-                for(i = 0; i < 16; i++){
-                if((in >> i) & 1){
-                    out ^= mat[i];
-                }
-                }
-                return out;
-            }
-
-            static void prince_m_prime_layer(uint64_t *prince_block){
-                static const uint32_t m_0[16] = {
-                0x0111, 0x2220, 0x4404, 0x8088,
-                0x1011, 0x0222, 0x4440, 0x8808,
-                0x1101, 0x2022, 0x0444, 0x8880,
-                0x1110, 0x2202, 0x4044, 0x0888
-                };
-                
-                static const uint32_t m_1[16] = {
-                0x1110, 0x2202, 0x4044, 0x0888, 
-                0x0111, 0x2220, 0x4404, 0x8088,
-                0x1011, 0x0222, 0x4440, 0x8808,
-                0x1101, 0x2022, 0x0444, 0x8880
-                };
-
-                const uint64_t out_0 = gf2_mul_16(*prince_block, m_0);
-                const uint64_t out_1 = gf2_mul_16(*prince_block >> 16, m_1);
-                const uint64_t out_2 = gf2_mul_16(*prince_block >> 32, m_1);
-                const uint64_t out_3 = gf2_mul_16(*prince_block >> 48, m_0);
-                *prince_block = (out_3 << 48) | (out_2 << 32) | (out_1 << 16) | out_0;
-                
-                //return m_prime_out;
-            }
-
-            const static uint64_t prince_row_mask = UINT64_C(0xF000F000F000F000);
-
-            static void prince_shift_rows(uint64_t* prince_block, int inverse){
-                uint64_t out = 0;
-                for(uint8_t i = 0; i < 4; ++i){
-                const uint64_t row = *prince_block & (prince_row_mask >> (4*i));
-                const unsigned int shift = inverse ? i*16 : 64-i*16;
-                out |= (row >> shift) | (row << (64-shift));
-                }
-                *prince_block = out;
-            }
+            /**
+             * Fully associative buffer of the valid entries the array
+             * evicted, searched when the array misses. rid is the random
+             * id of the ASID when the entry was evicted.
+             */
+            struct VictimMeta {
+                TLBMeta meta;
+                uint64_t rid;
+                uint64_t seq;
+            };
+            std::vector<VictimMeta> victims;
+            bool victimRandomized;
+            uint64_t victimSeq;
 
-            static void prince_s_layer(uint64_t* prince_block){
-                uint64_t out = 0;
-                for(uint8_t i=15; i > 0; --i){
-                    out |= prince_sbox((*prince_block) >> (i << 2));
-                    out <<= 4;
-                }
-                out |= prince_sbox(*prince_block);
-                *prince_block = out;
-            }
+            // Index function replacing the built-in ones, if not null
+            const IndexFunction *indexFunction;
 
-            static void prince_s_layer_inv(uint64_t* prince_block){
-                uint64_t out = 0;
-                for(uint8_t i=15; i > 0; --i){
-                    out |= prince_sbox_inv(*prince_block >> (i << 2));
-                    out <<= 4;
-                }
-                out |= prince_sbox_inv(*prince_block);
-                *prince_block = out;
-            }
+            void setGeometry(unsigned num_ways, unsigned num_sets);
+            void freeCacheData();
+            void randomize(Addr va, unsigned logBytes, uint64_t process_id,
+                           uint64_t* set_arr) const;
+            void getSets(Addr va, unsigned logBytes, uint16_t asid,
+                         uint64_t* set_arr) const;
+            /**
+             * Group of pages a 4KiB page is indexed by with coalescing,
+             * and the size of the group in address bits.
+             */
+            Addr groupBase(Addr va) const;
+            unsigned groupBits() const { return PageShift + coalesceShift; }
+            TlbEntry *pageOf(const TlbEntry &group, Addr va);
+            unsigned demapGroupPage(TLBMeta &meta, Addr va);
+            /** Ways a fill of an entry of asid may replace. */
+            uint16_t fillWays(uint16_t asid) const;
+        public:
+            // What happened to the TLB while inserting an entry
+            struct InsertResult {
+                bool rerandomized;
+                bool evicted;
+                uint16_t evictedAsid;
+                // Prefetched pages of the victim that never hit
+                uint16_t evictedUnused;
+                // The evicted entry went to the victim buffer
+                bool victimFilled;
+            };
 
+            // Why a lookup hit a page the walker did not fill on demand
+            struct HitInfo {
+                // First hit on a page a coalesced entry mapped before
+                bool coalesced;
+                // First hit on a page installed from a neighbouring PTE
+                bool prefetched;
+                // The array missed and the victim buffer held the page
+                bool victim;
+                // What swapping the page back did to the array
+                InsertResult swap;
+            };
 
-            static void prince_m_layer(uint64_t *prince_block){
-                prince_m_prime_layer(prince_block);
-                prince_shift_rows(prince_block, 0);
+            /**
+             * @param num_ways Associativity (at most MaxWays)
+             * @param num_sets Number of sets, a power of two
+             * @param max_evict Evictions per ASID before its random id is
+             *        changed, 0 never rerandomizes
+             * @param randomized Use PRINCE-randomized per-way set indices
+             *        instead of set associative indexing
+             */
+            TLBCache(const std::string &cache_name, unsigned num_ways,
+                     unsigned num_sets, uint32_t max_evict, bool randomized);
+            virtual ~TLBCache();
+            const std::string &name() const { return _name; }
+            unsigned numWays() const { return ways; }
+            unsigned numSets() const { return sets; }
+            /**
+             * @param info Set to whether the hit saved a miss because
+             *        the page was mapped by a coalesced entry or a
+             *        neighbour fill before it was accessed.
+             */
+            TlbEntry* lookup(Addr va, uint16_t asid,
+                             HitInfo *info = nullptr);
+            /**
+             * Whether the 4KiB page of va is mapped, without updating
+             * the replacement or hit state like lookup() does.
+             */
+            bool holds(Addr va, uint16_t asid) const;
+            /**
+             * @param coalesced Pages of the group of a 4KiB vpn that
+             *        are virtually and physically contiguous with it and
+             *        share its PTE flags (bit i is page i of the group).
+             * @param prefetch The walker read the PTE of vpn along with
+             *        the one it walked, track whether it is ever used.
+             */
+            TlbEntry* insert(Addr vpn, TlbEntry entry,
+                             InsertResult *result = nullptr,
+                             uint16_t coalesced = 0, bool prefetch = false);
+            /** Evict the LRU entry among the ways in way_mask. */
+            uint8_t evict(uint64_t* set_arr,
+                          uint16_t way_mask = (1U << MaxWays) - 1);
+            /**
+             * Invalidation functions return the number of valid entries
+             * they dropped.
+             */
+            unsigned flushAll();
+            unsigned demapPage(Addr va, uint64_t asn);
+            unsigned demapPageComplex(Addr va, uint64_t asn);
+            /**
+             * Copy the entries and the randomization state (key, random
+             * ids and eviction counters) of another cache with the same
+             * geometry, e.g. when a CPU is switched in.
+             */
+            void takeOverFrom(const TLBCache &old);
+            /**
+             * Change the organization of the cache at run time. All
+             * entries and the per-ASID rerandomization state are dropped,
+             * the PRINCE key is kept.
+             */
+            void reconfigure(unsigned num_ways, unsigned num_sets,
+                             uint32_t max_evict, bool randomized);
+            /**
+             * Banks read by a lookup of va when the sets are interleaved
+             * across num_banks banks. Way i reads its own set, so a
+             * randomized lookup can touch a different bank in every way
+             * while a set associative one stays in a single bank. Only
+             * the 4KiB probe is modelled.
+             */
+            uint64_t lookupBanks(Addr va, uint16_t asid, unsigned num_banks);
+            /**
+             * Set the 4KiB page of va maps to in every way. This is
+             * ground truth for analyses of the index function (e.g. to
+             * validate an eviction set), no lookup uses it.
+             */
+            void wayIndices(Addr va, uint16_t asid, uint64_t *set_arr) const;
+            /**
+             * Let one 4KiB entry map up to pages (a power of two, at most
+             * 16) contiguous pages. 4KiB pages are then indexed by their
+             * group, so all entries are dropped.
+             */
+            void setCoalescing(unsigned pages);
+            unsigned coalescePages() const { return 1U << coalesceShift; }
+            /** Bytes of address space mapped by the valid entries. */
+            uint64_t reach() const;
+            /**
+             * Group the ASIDs into num_domains domains. With partition
+             * ways (one count per domain, adding up to the
+             * associativity), domain i only fills the next
+             * partition_ways[i] ways, so fills of one domain never evict
+             * entries of another. All entries are dropped and all
+             * ASIDs return to domain 0.
+             */
+            void setDomains(unsigned num_domains,
+                            const std::vector<unsigned> &partition_ways);
+            /**
+             * Move asid to domain. Entries it already holds stay in
+             * their ways until they are evicted.
+             */
+            void setAsidDomain(uint16_t asid, unsigned domain);
+            unsigned numDomains() const { return domains; }
+            unsigned domainOf(uint16_t asid) const
+            {
+                return asid_domain[asid];
             }
-
-            static void prince_m_layer_inv(uint64_t *prince_block){
-                prince_shift_rows(prince_block, 1);
-                prince_m_prime_layer(prince_block);
+            bool partitioned() const { return !domainWays.empty(); }
+            /**
+             * Keep the last entries (at most 16, 0 disables the buffer)
+             * the array evicted in a fully associative victim buffer. If
+             * randomized, a victim only hits until its ASID is
+             * rerandomized, like the entries it left behind in the array.
+             */
+            void setVictimBuffer(unsigned entries, bool randomized);
+            unsigned victimEntries() const { return victims.size(); }
+            /**
+             * Compute the set indices of all ways with function (owned
+             * by the caller) instead of PRINCE or set associative
+             * indexing; nullptr restores those. All entries are dropped.
+             */
+            void setIndexFunction(const IndexFunction *function);
+            /**
+             * Replace the key the set indices are derived from, e.g. to
+             * draw it from a seed. All entries are dropped.
+             */
+            void setKey(uint64_t key);
+            /** Valid entries of the ASIDs of domain. */
+            unsigned occupancy(unsigned domain) const;
+            unsigned validEntries() const;
+            /** Id the set indices of asid are randomized with. */
+            uint64_t randomId(uint16_t asid) const
+            {
+                return random_id[asid];
             }
+            uint64_t getRerandRequestCount();
+            void updatePLRUSet(uint32_t set, uint32_t way);
 
-            static uint64_t encrypt(uint64_t input, uint64_t key) {
-                uint64_t output = input;
-                // PRINCE Round 1
-                output ^= key;
-                output ^= 0x13198a2e03707344; // RC1
-                prince_m_layer(&output);
-                prince_s_layer_inv(&output);
+        protected:
+            TlbEntry *lookupGroup(Addr va, uint16_t asid, HitInfo *info);
+            bool victimMaps(const VictimMeta &victim, Addr va,
+                            uint16_t asid) const;
+            /** Buffer an evicted entry, false without a victim buffer. */
+            bool addVictim(const TLBMeta &meta);
+            /**
+             * Move the victim entry mapping va back into the array, which
+             * may push another entry into the victim buffer.
+             */
+            TlbEntry *lookupVictim(Addr va, uint16_t asid, HitInfo *info);
+            /** Drop victims of asn (0: any) mapping va, or all if any_va. */
+            unsigned demapVictims(Addr va, uint64_t asn, bool any_va);
+            void flushVictims();
+            TlbEntry *insertGroup(Addr vpn, TlbEntry entry,
+                                  uint16_t coalesced, bool prefetch,
+                                  InsertResult *result);
+            TlbEntry *fill(Addr addr, unsigned index_bits,
+                           const TlbEntry &entry, uint16_t coalesced,
+                           uint16_t touched, uint16_t prefetched,
+                           InsertResult *result);
+    };
 
-                // PRINCE Round 2
-                output ^= key;
-                output ^= 0xa4093822299f31d0; // RC2
-                prince_m_layer(&output);
-                prince_s_layer(&output);
+    class RiscVTLBCache : public SimObject, public TLBCache {
+        public:
+            using SimObject::name;
 
-                output ^= key;
+            RiscVTLBCache(const RiscVTLBCacheParams &params);
 
-                // PRINCE Round 3
-                prince_s_layer(&output);
-                prince_m_prime_layer(&output);
+            /**
+             * Python entry point for TLBCache::reconfigure(), only valid
+             * while the system is drained (e.g. right after m5.fork()).
+             */
+            void reconfigure(unsigned num_ways, unsigned num_sets,
+                             uint32_t max_evict, bool randomized);
+            /** Python entry point for TLBCache::setAsidDomain(). */
+            void setAsidDomain(uint16_t asid, unsigned domain);
+            /** Cycles the index function adds to a lookup. */
+            Cycles indexLatency() const;
 
-                return output;
-            }
-            void randomize(Addr va, uint64_t process_id, uint64_t* set_arr);
-        public:
-            RiscVTLBCache(const RiscVTLBCacheParams &params);
-            ~RiscVTLBCache();
-            TlbEntry* lookup(Addr va, uint16_t asid);
-            TlbEntry* insert(Addr vpn, TlbEntry entry);
-            uint8_t evict(uint64_t* set_arr);
-            void flushAll();
-            void demapPage(Addr va, uint64_t asn);
-            void demapPageComplex(Addr va, uint64_t asn);
-            uint64_t getRerandRequestCount();
-            void updatePLRUSet(uint32_t set, uint32_t way);
+        protected:
+            TLBIndex *index;
     };
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arch/riscv/tlb_coherence.hh"
+
+#include "arch/riscv/mmu.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "cpu/base.hh"
+#include "cpu/thread_context.hh"
+#include "debug/TLB.hh"
+#include "dev/riscv/clint.hh"
+#include "params/RiscvTLBCoherence.hh"
+#include "sim/system.hh"
+
+namespace RiscvISA
+{
+
+TLBCoherence::TLBCoherence(const RiscvTLBCoherenceParams &p)
+    : SimObject(p), system(p.system), clint(p.clint),
+      broadcast(p.broadcast), broadcastLatency(p.broadcast_latency),
+      mailbox(eventQueue(), name() + ".mailbox"), stats(this)
+{
+}
+
+void
+TLBCoherence::init()
+{
+    SimObject::init();
+    pending.resize(system->threads.size());
+}
+
+void
+TLBCoherence::regProbeListeners()
+{
+    if (clint) {
+        listener.reset(new IpiListener(*this, clint->getProbeManager(),
+                                       "Ipi"));
+    }
+}
+
+void
+TLBCoherence::preDumpStats()
+{
+    SimObject::preDumpStats();
+    // The last shootdown of a hart has no IPI after it to record it
+    for (int hart = 0; hart < (int)pending.size(); hart++) {
+        if (pending[hart].fenced)
+            completeShootdown(hart);
+    }
+}
+
+void
+TLBCoherence::handleIpi(const ProbePoints::IpiInfo &info)
+{
+    fatal_if(info.hart < 0 || info.hart >= (int)pending.size(),
+             "%s: IPI to unknown hart %d\n", name(), info.hart);
+    PendingIpi &ipi = pending[info.hart];
+
+    if (info.set) {
+        stats.ipis++;
+        // IPIs posted before the hart took the previous one are merged
+        if (ipi.valid && !ipi.acked)
+            return;
+        // Otherwise the previous IPI is finished. If it was acked
+        // without a fence it was not a shootdown, e.g. a reschedule.
+        completeShootdown(info.hart);
+        ipi.valid = true;
+        ipi.acked = false;
+        ipi.fenced = false;
+        ipi.sent = curTick();
+    } else if (ipi.valid) {
+        ipi.acked = true;
+    }
+}
+
+void
+TLBCoherence::completeShootdown(int hart)
+{
+    PendingIpi &ipi = pending[hart];
+    if (ipi.valid && ipi.fenced) {
+        const Tick latency = ipi.lastFence - ipi.sent;
+        DPRINTF(TLB, "Shootdown of hart %d took %d ticks\n", hart, latency);
+        stats.shootdowns++;
+        stats.shootdownTicks += latency;
+        stats.shootdownLatency.sample(latency);
+    }
+    ipi.valid = false;
+}
+
+void
+TLBCoherence::fence(ThreadContext *tc, PrivilegeMode pm, Addr vaddr,
+                    uint64_t asid, unsigned dropped)
+{
+    // Harts may be simulated in their own event queues, so fences are
+    // accounted in the queue of this object
+    const int hart = tc->contextId();
+    const Tick when = curTick();
+    mailbox.post([=]{ recordFence(hart, pm, vaddr, asid, dropped, when); });
+}
+
+void
+TLBCoherence::recordFence(int hart, PrivilegeMode pm, Addr vaddr,
+                          uint64_t asid, unsigned dropped, Tick when)
+{
+    if (vaddr == 0 && (asid & 0xFFFF) == 0)
+        stats.fullFlushes++;
+
+    if (pm == PRV_M) {
+        // Fences are only executed in M-mode by the SBI firmware. The
+        // initiating hart fences itself without an IPI, so only a hart
+        // that took an IPI is fencing on behalf of a remote one.
+        if (hart < (int)pending.size() && pending[hart].valid &&
+            pending[hart].acked) {
+            stats.remoteFences++;
+            stats.remoteEntriesDropped += dropped;
+            pending[hart].fenced = true;
+            pending[hart].lastFence = when;
+        } else {
+            stats.localFences++;
+            stats.localEntriesDropped += dropped;
+        }
+        return;
+    }
+
+    stats.localFences++;
+    stats.localEntriesDropped += dropped;
+    if (!broadcast)
+        return;
+
+    for (auto *remote_tc : system->threads) {
+        if (remote_tc->contextId() == hart)
+            continue;
+        auto *mmu = static_cast<MMU *>(remote_tc->getMMUPtr());
+        remote_tc->getCpuPtr()->mailbox().post([=]{
+            const unsigned remote_dropped = mmu->demap(vaddr, asid);
+            DPRINTF(TLB, "Broadcast fence(vpn=%#x, asid=%#x) from hart %d "
+                    "dropped %d entries of hart %d\n", vaddr, asid, hart,
+                    remote_dropped, remote_tc->contextId());
+            mailbox.post([this, remote_dropped]{
+                stats.broadcastEntriesDropped += remote_dropped;
+            });
+        });
+    }
+    stats.broadcasts++;
+    stats.broadcastTicks += broadcastLatency;
+}
+
+TLBCoherence::CoherenceStats::CoherenceStats(Stats::Group *parent)
+    : Stats::Group(parent),
+      ADD_STAT(localFences, UNIT_COUNT,
+               "sfence.vma instructions executed by the kernel or the "
+               "firmware for the local hart"),
+      ADD_STAT(localEntriesDropped, UNIT_COUNT,
+               "TLB entries dropped by fences of the local hart"),
+      ADD_STAT(fullFlushes, UNIT_COUNT,
+               "Fences of all addresses and ASIDs, each rerandomizing "
+               "every ASID"),
+      ADD_STAT(remoteFences, UNIT_COUNT,
+               "sfence.vma instructions executed by the firmware on a "
+               "hart that took a shootdown IPI"),
+      ADD_STAT(remoteEntriesDropped, UNIT_COUNT,
+               "TLB entries dropped by remote shootdown fences"),
+      ADD_STAT(ipis, UNIT_COUNT, "Software interrupts posted to harts"),
+      ADD_STAT(shootdowns, UNIT_COUNT,
+               "IPIs that were serviced by at least one fence"),
+      ADD_STAT(shootdownTicks, UNIT_TICK,
+               "Total time from IPI to the last fence on the target"),
+      ADD_STAT(shootdownLatency, UNIT_TICK,
+               "Distribution of the time from IPI to the last fence on "
+               "the target"),
+      ADD_STAT(avgShootdownLatency, UNIT_RATIO,
+               "Average time from IPI to the last fence on the target",
+               shootdownTicks / shootdowns),
+      ADD_STAT(broadcasts, UNIT_COUNT,
+               "Fences broadcast to the TLBs of all other harts"),
+      ADD_STAT(broadcastEntriesDropped, UNIT_COUNT,
+               "TLB entries dropped on other harts by broadcast fences"),
+      ADD_STAT(broadcastTicks, UNIT_TICK,
+               "Interconnect time spent on broadcast fences")
+{
+    shootdownLatency.init(16);
+}
+
+} // namespace RiscvISA
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARCH_RISCV_TLB_COHERENCE_HH__
+#define __ARCH_RISCV_TLB_COHERENCE_HH__
+
+#include <memory>
+#include <vector>
+
+#include "arch/riscv/isa.hh"
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "sim/eventq_mailbox.hh"
+#include "sim/probe/ipi.hh"
+#include "sim/sim_object.hh"
+
+struct RiscvTLBCoherenceParams;
+class System;
+class ThreadContext;
+
+namespace RiscvISA
+{
+
+/**
+ * Observes TLB shootdowns and optionally models a hardware broadcast
+ * invalidation.
+ *
+ * Every hart's MMU reports its sfence.vma instructions here. Linux
+ * performs remote shootdowns through the SBI: the firmware posts an IPI
+ * by writing the target's msip register, and the target executes
+ * sfence.vma in M-mode from its IPI handler. Listening to the Ipi probe
+ * point of the CLINT, a shootdown is timed from the msip write to the
+ * last M-mode fence on the target after it cleared its msip bit. It is
+ * recorded when the next IPI is posted to that hart, or at the next stats
+ * dump if none is.
+ *
+ * With broadcast enabled, every S-mode fence is also applied to the TLBs
+ * of all other harts, as if the invalidation travelled on the
+ * interconnect without interrupting them. The guest still sends its own
+ * IPIs, so the cost of the broadcast is accounted in the statistics
+ * rather than charged to the initiating instruction.
+ */
+class TLBCoherence : public SimObject
+{
+  public:
+    TLBCoherence(const RiscvTLBCoherenceParams &p);
+
+    void init() override;
+    void regProbeListeners() override;
+    void preDumpStats() override;
+
+    /**
+     * Report an sfence.vma executed by tc at privilege pm that dropped
+     * dropped entries from its own TLBs.
+     */
+    void fence(ThreadContext *tc, PrivilegeMode pm, Addr vaddr,
+               uint64_t asid, unsigned dropped);
+
+  protected:
+    void handleIpi(const ProbePoints::IpiInfo &info);
+
+    /** Record the shootdown of a hart if its IPI was serviced by fences. */
+    void completeShootdown(int hart);
+
+    /** Account a fence reported at tick when in the queue of this object. */
+    void recordFence(int hart, PrivilegeMode pm, Addr vaddr, uint64_t asid,
+                     unsigned dropped, Tick when);
+
+    System *system;
+    SimObject *clint;
+    const bool broadcast;
+    const Tick broadcastLatency;
+
+    /** Receives the fences of harts simulated by other event queues. */
+    EventqMailbox mailbox;
+
+    /** The IPI most recently posted to one hart. */
+    struct PendingIpi
+    {
+        bool valid = false;
+        /** The hart cleared its msip bit. */
+        bool acked = false;
+        /** At least one M-mode fence followed the ack. */
+        bool fenced = false;
+        Tick sent = 0;
+        Tick lastFence = 0;
+    };
+    std::vector<PendingIpi> pending;
+
+    class IpiListener : public ProbeListenerArgBase<ProbePoints::IpiInfo>
+    {
+      public:
+        IpiListener(TLBCoherence &_parent, ProbeManager *pm,
+                    const std::string &name)
+            : ProbeListenerArgBase(pm, name), parent(_parent) {}
+
+        void notify(const ProbePoints::IpiInfo &info) override {
+            parent.handleIpi(info);
+        }
+
+      protected:
+        TLBCoherence &parent;
+    };
+
+    std::unique_ptr<IpiListener> listener;
+
+    struct CoherenceStats : public Stats::Group
+    {
+        CoherenceStats(Stats::Group *parent);
+
+        Stats::Scalar localFences;
+        Stats::Scalar localEntriesDropped;
+        Stats::Scalar fullFlushes;
+        Stats::Scalar remoteFences;
+        Stats::Scalar remoteEntriesDropped;
+        Stats::Scalar ipis;
+        Stats::Scalar shootdowns;
+        Stats::Scalar shootdownTicks;
+        Stats::Histogram shootdownLatency;
+        Stats::Formula avgShootdownLatency;
+        Stats::Scalar broadcasts;
+        Stats::Scalar broadcastEntriesDropped;
+        Stats::Scalar broadcastTicks;
+    } stats;
+};
+
+} // namespace RiscvISA
+
+#endif // __ARCH_RISCV_TLB_COHERENCE_HH__
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arch/riscv/tlb_index.hh"
+
+#include "params/RiscvIdentityIndex.hh"
+#include "params/RiscvPrinceIndex.hh"
+#include "params/RiscvQarmaIndex.hh"
+#include "params/RiscvXorIndex.hh"
+
+namespace RiscvISA
+{
+
+TLBIndex::TLBIndex(const RiscvTLBIndexParams &p,
+                   std::unique_ptr<IndexFunction> function)
+    : SimObject(p), _latency(p.latency), _function(std::move(function))
+{
+}
+
+PrinceTLBIndex::PrinceTLBIndex(const RiscvPrinceIndexParams &p)
+    : TLBIndex(p, std::unique_ptr<IndexFunction>(new PrinceIndex(p.rounds)))
+{
+}
+
+QarmaTLBIndex::QarmaTLBIndex(const RiscvQarmaIndexParams &p)
+    : TLBIndex(p, std::unique_ptr<IndexFunction>(new QarmaIndex(p.rounds)))
+{
+}
+
+XorTLBIndex::XorTLBIndex(const RiscvXorIndexParams &p)
+    : TLBIndex(p, std::unique_ptr<IndexFunction>(new XorIndex))
+{
+}
+
+IdentityTLBIndex::IdentityTLBIndex(const RiscvIdentityIndexParams &p)
+    : TLBIndex(p, std::unique_ptr<IndexFunction>(new IdentityIndex))
+{
+}
+
+} // namespace RiscvISA
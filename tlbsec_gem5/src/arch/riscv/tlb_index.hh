@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __ARCH_RISCV_TLB_INDEX_HH__
+#define __ARCH_RISCV_TLB_INDEX_HH__
+
+#include <memory>
+
+#include "arch/riscv/index_function.hh"
+#include "base/types.hh"
+#include "sim/sim_object.hh"
+
+struct RiscvTLBIndexParams;
+struct RiscvPrinceIndexParams;
+struct RiscvQarmaIndexParams;
+struct RiscvXorIndexParams;
+struct RiscvIdentityIndexParams;
+
+namespace RiscvISA
+{
+
+/**
+ * An index function of the TLB cache together with the cycles the
+ * hardware needs to compute it, which the TLB adds to every timing
+ * lookup.
+ */
+class TLBIndex : public SimObject
+{
+  protected:
+    const Cycles _latency;
+    const std::unique_ptr<IndexFunction> _function;
+
+    TLBIndex(const RiscvTLBIndexParams &p,
+             std::unique_ptr<IndexFunction> function);
+
+  public:
+    Cycles latency() const { return _latency; }
+    const IndexFunction &function() const { return *_function; }
+};
+
+class PrinceTLBIndex : public TLBIndex
+{
+  public:
+    PrinceTLBIndex(const RiscvPrinceIndexParams &p);
+};
+
+class QarmaTLBIndex : public TLBIndex
+{
+  public:
+    QarmaTLBIndex(const RiscvQarmaIndexParams &p);
+};
+
+class XorTLBIndex : public TLBIndex
+{
+  public:
+    XorTLBIndex(const RiscvXorIndexParams &p);
+};
+
+class IdentityTLBIndex : public TLBIndex
+{
+  public:
+    IdentityTLBIndex(const RiscvIdentityIndexParams &p);
+};
+
+} // namespace RiscvISA
+
+#endif // __ARCH_RISCV_TLB_INDEX_HH__
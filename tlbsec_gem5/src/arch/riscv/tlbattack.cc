@@ -0,0 +1,566 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Eviction-set attack benchmark. Runs the prime+prune+probe attacks of
+ * functional/tlb.py against TLBCache, the array the gem5 TLB is built
+ * on, so that a change to the geometry, the index function or the
+ * rerandomization threshold can be priced in attack cost as well as in
+ * miss rate (see tlbsim).
+ *
+ * Attacker and victim run in different ASIDs and only use lookup() and
+ * insert(), i.e. they touch pages and every miss is filled like the
+ * walker would. Two experiments run for every prime set size:
+ *
+ * - prime+prune: prime a random set of pages and re-access it until it
+ *   stays in the TLB, then let the victim touch one page. The attack
+ *   succeeds if that evicts a primed page, which a probe would see.
+ * - profiling: repeat prime+prune+probe and collect the pages that miss
+ *   after a victim access until they cover the set of the victim page
+ *   in every way, or until the attacker took too many misses (by
+ *   default 2 * entries, like functional/tlb.py).
+ *
+ * Every seed runs on its own TLBs, keyed and driven by its own random
+ * stream; seeds are spread over host threads.
+ *
+ * usage: tlbattack [--ways=4,8] [--sets=16,32] [--max-evict=16,64]
+ *                  [--index=prince,qarma5,xor,sa]
+ *                  [--set-sizes=16,32,64]
+ *                  [--max-misses=N] [--seeds=N] [--trials=N]
+ *                  [--threads=N]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arch/riscv/index_function.hh"
+#include "arch/riscv/pagetable.hh"
+#include "arch/riscv/tlb_cache.hh"
+#include "base/bitfield.hh"
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/str.hh"
+
+using namespace RiscvISA;
+
+namespace
+{
+
+const uint16_t AttackerAsid = 1;
+const uint16_t VictimAsid = 2;
+
+struct Config
+{
+    unsigned ways;
+    unsigned sets;
+    uint32_t maxEvict;
+    // "sa", "prince" (the built-in PRINCE) or an IndexFunction name
+    std::string index;
+    std::shared_ptr<const IndexFunction> function;
+
+    bool randomized() const { return index != "sa"; }
+    // Prime set sizes to run
+    std::vector<unsigned> setSizes;
+    // Misses after which profiling gives up
+    uint64_t maxMisses;
+
+    unsigned entries() const { return ways * sets; }
+};
+
+// Results of one prime set size, summed over trials and seeds
+struct Result
+{
+    // prime+prune
+    uint64_t trials = 0;
+    uint64_t evictions = 0;
+    uint64_t pruneMisses = 0;
+    uint64_t pruneRerands = 0;
+
+    // profiling, accesses and misses only of the runs that succeeded
+    uint64_t runs = 0;
+    uint64_t found = 0;
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    uint64_t minAccesses = std::numeric_limits<uint64_t>::max();
+    uint64_t minMisses = std::numeric_limits<uint64_t>::max();
+    uint64_t rerands = 0;
+
+    void
+    add(const Result &r)
+    {
+        trials += r.trials;
+        evictions += r.evictions;
+        pruneMisses += r.pruneMisses;
+        pruneRerands += r.pruneRerands;
+        runs += r.runs;
+        found += r.found;
+        accesses += r.accesses;
+        misses += r.misses;
+        minAccesses = std::min(minAccesses, r.minAccesses);
+        minMisses = std::min(minMisses, r.minMisses);
+        rerands += r.rerands;
+    }
+};
+
+/**
+ * A process touching pages of its address space. Every access that
+ * misses fills the TLB, as the page table walker would.
+ */
+class Process
+{
+  public:
+    Process(TLBCache &tlb, uint16_t asid) : tlb(tlb), asid(asid) {}
+
+    /** @return Whether the access missed. */
+    bool
+    access(Addr va)
+    {
+        accesses++;
+        if (tlb.lookup(va, asid))
+            return false;
+
+        misses++;
+        TlbEntry entry;
+        entry.vaddr = va;
+        entry.paddr = va >> PageShift;
+        entry.logBytes = PageShift;
+        entry.asid = asid;
+        tlb.insert(va, entry);
+        return true;
+    }
+
+    bool holds(Addr va) const { return tlb.holds(va, asid); }
+
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+
+  private:
+    TLBCache &tlb;
+    uint16_t asid;
+};
+
+Addr
+randomPage(std::mt19937_64 &rng)
+{
+    return (rng() & mask(VADDR_BITS - PageShift)) << PageShift;
+}
+
+/**
+ * Re-access the prime set until it causes no more misses. If that does
+ * not converge, the set does not fit and pages that missed are dropped.
+ */
+void
+prune(Process &attacker, std::vector<Addr> &pages)
+{
+    for (unsigned fails = 0; ; fails++) {
+        std::vector<size_t> conflicts;
+        for (size_t i = 0; i < pages.size(); i++) {
+            if (attacker.access(pages[i]))
+                conflicts.push_back(i);
+        }
+        if (conflicts.empty())
+            return;
+
+        if (fails >= 3) {
+            size_t drop = conflicts.size() > 10 ? 6 : 1;
+            while (drop-- > 0)
+                pages.erase(pages.begin() + conflicts[drop]);
+        }
+    }
+}
+
+/** @return Whether the victim access evicted a primed page. */
+bool
+primePrune(Process &attacker, Process &victim, std::mt19937_64 &rng,
+           unsigned set_size)
+{
+    std::vector<Addr> pages(set_size);
+    for (auto &page : pages) {
+        page = randomPage(rng);
+        attacker.access(page);
+    }
+    prune(attacker, pages);
+
+    victim.access(randomPage(rng));
+
+    return std::any_of(pages.begin(), pages.end(),
+                       [&](Addr page) { return !attacker.holds(page); });
+}
+
+bool
+matchWay(unsigned way, const std::vector<uint16_t> &covers,
+         std::vector<int> &page_way, std::vector<bool> &visited)
+{
+    for (size_t n = 0; n < covers.size(); n++) {
+        if (!bits(covers[n], way) || visited[n])
+            continue;
+        visited[n] = true;
+        if (page_way[n] < 0 ||
+            matchWay(page_way[n], covers, page_way, visited)) {
+            page_way[n] = way;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Whether the pages of an eviction set can take the set of the target
+ * in every way, each page in a different way (is_valid_eviction_set()
+ * of functional/tlb.py as a bipartite matching). This uses the current
+ * random ids, so a rerandomization invalidates the pages found so far.
+ */
+bool
+isEvictionSet(const TLBCache &tlb, Addr target,
+              const std::vector<Addr> &evset)
+{
+    uint64_t target_sets[TLBCache::MaxWays];
+    tlb.wayIndices(target, VictimAsid, target_sets);
+
+    // Bit i is set if the page maps to the set of the target in way i
+    std::vector<uint16_t> covers;
+    for (Addr page : evset) {
+        uint64_t page_sets[TLBCache::MaxWays];
+        tlb.wayIndices(page, AttackerAsid, page_sets);
+        uint16_t ways = 0;
+        for (unsigned i = 0; i < tlb.numWays(); i++) {
+            if (page_sets[i] == target_sets[i])
+                ways |= 1 << i;
+        }
+        if (ways)
+            covers.push_back(ways);
+    }
+    if (covers.size() < tlb.numWays())
+        return false;
+
+    std::vector<int> page_way(covers.size(), -1);
+    for (unsigned i = 0; i < tlb.numWays(); i++) {
+        std::vector<bool> visited(covers.size(), false);
+        if (!matchWay(i, covers, page_way, visited))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * One run of prime_prune_probe_profiling() of functional/tlb.py.
+ *
+ * @return Whether an eviction set of the target was found before the
+ *         attacker took more than max_misses misses.
+ */
+bool
+profile(const TLBCache &tlb, Process &attacker, Process &victim,
+        std::mt19937_64 &rng, unsigned set_size, uint64_t max_misses,
+        Addr target)
+{
+    const uint64_t budget = attacker.misses + max_misses;
+    std::vector<Addr> pages;
+    std::vector<Addr> evset;
+
+    while (true) {
+        while (pages.size() < set_size)
+            pages.push_back(randomPage(rng));
+
+        for (Addr page : pages)
+            attacker.access(page);
+        prune(attacker, pages);
+        // Keep the known conflicts more recently used than the prime
+        // set, or an LRU TLB evicts them instead of a new one
+        for (Addr page : evset)
+            attacker.access(page);
+
+        victim.access(target);
+
+        // The first page that misses conflicts with the victim
+        for (auto it = pages.begin(); it != pages.end(); ++it) {
+            if (attacker.access(*it)) {
+                evset.push_back(*it);
+                pages.erase(it);
+                break;
+            }
+        }
+        if (attacker.misses > budget)
+            return false;
+
+        // Evict the victim page for the next round, known conflicts
+        // first. Unlike a real attacker we know when it is gone.
+        auto evict = [&](const std::vector<Addr> &from) {
+            for (Addr page : from) {
+                if (!victim.holds(target))
+                    return;
+                attacker.access(page);
+            }
+        };
+        evict(evset);
+        evict(pages);
+        while (victim.holds(target) && attacker.misses <= budget) {
+            pages.push_back(randomPage(rng));
+            evict(pages);
+        }
+
+        if (pages.size() > set_size)
+            pages.erase(pages.begin(), pages.end() - set_size);
+
+        if (isEvictionSet(tlb, target, evset))
+            return true;
+        if (attacker.misses > budget)
+            return false;
+    }
+}
+
+std::unique_ptr<TLBCache>
+makeTLB(const Config &cfg, std::mt19937_64 &rng)
+{
+    std::unique_ptr<TLBCache> tlb(new TLBCache("tlb", cfg.ways, cfg.sets,
+                                               cfg.maxEvict,
+                                               cfg.randomized()));
+    if (cfg.function)
+        tlb->setIndexFunction(cfg.function.get());
+    tlb->setKey(rng());
+    return tlb;
+}
+
+void
+run(const Config &cfg, unsigned trials, uint64_t seed,
+    std::vector<Result> &results)
+{
+    std::mt19937_64 rng(seed);
+
+    for (size_t i = 0; i < cfg.setSizes.size(); i++) {
+        const unsigned set_size = cfg.setSizes[i];
+        Result &r = results[i];
+
+        auto tlb = makeTLB(cfg, rng);
+        Process attacker(*tlb, AttackerAsid);
+        Process victim(*tlb, VictimAsid);
+        for (unsigned t = 0; t < trials; t++) {
+            r.trials++;
+            if (primePrune(attacker, victim, rng, set_size))
+                r.evictions++;
+        }
+        r.pruneMisses += attacker.misses;
+        r.pruneRerands += tlb->getRerandRequestCount();
+
+        tlb = makeTLB(cfg, rng);
+        Process prof_attacker(*tlb, AttackerAsid);
+        Process prof_victim(*tlb, VictimAsid);
+        for (unsigned t = 0; t < trials; t++) {
+            const uint64_t accesses = prof_attacker.accesses;
+            const uint64_t misses = prof_attacker.misses;
+            r.runs++;
+            if (!profile(*tlb, prof_attacker, prof_victim, rng, set_size,
+                         cfg.maxMisses, randomPage(rng))) {
+                continue;
+            }
+            r.found++;
+            r.accesses += prof_attacker.accesses - accesses;
+            r.misses += prof_attacker.misses - misses;
+            r.minAccesses = std::min(r.minAccesses,
+                                     prof_attacker.accesses - accesses);
+            r.minMisses = std::min(r.minMisses,
+                                   prof_attacker.misses - misses);
+        }
+        r.rerands += tlb->getRerandRequestCount();
+    }
+}
+
+template <class T>
+std::vector<T>
+parseList(const std::string &opt, const std::string &value)
+{
+    std::vector<std::string> tokens;
+    tokenize(tokens, value, ',');
+    std::vector<T> list;
+    for (const auto &token : tokens) {
+        T val;
+        if (!to_number(token, val))
+            fatal("Invalid value '%s' for --%s\n", token, opt);
+        list.push_back(val);
+    }
+    return list;
+}
+
+std::string
+minOf(uint64_t val)
+{
+    return val == std::numeric_limits<uint64_t>::max() ? "-" :
+        csprintf("%d", val);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    std::vector<unsigned> ways = {4};
+    std::vector<unsigned> sets = {16};
+    std::vector<uint32_t> max_evicts = {MAX_EVICT};
+    std::vector<std::string> index_fns = {"prince"};
+    std::vector<unsigned> set_sizes;
+    uint64_t max_misses = 0;
+    unsigned num_seeds = 16;
+    unsigned trials = 100;
+    unsigned num_threads = std::max(1U, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        std::string opt = arg.substr(0, eq);
+        std::string val = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        if (opt == "--ways") {
+            ways = parseList<unsigned>("ways", val);
+        } else if (opt == "--sets") {
+            sets = parseList<unsigned>("sets", val);
+        } else if (opt == "--max-evict") {
+            max_evicts = parseList<uint32_t>("max-evict", val);
+        } else if (opt == "--set-sizes") {
+            set_sizes = parseList<unsigned>("set-sizes", val);
+        } else if (opt == "--max-misses") {
+            if (!to_number(val, max_misses))
+                fatal("Invalid value '%s' for --max-misses\n", val);
+        } else if (opt == "--seeds") {
+            if (!to_number(val, num_seeds) || num_seeds == 0)
+                fatal("Invalid value '%s' for --seeds\n", val);
+        } else if (opt == "--trials") {
+            if (!to_number(val, trials) || trials == 0)
+                fatal("Invalid value '%s' for --trials\n", val);
+        } else if (opt == "--threads") {
+            if (!to_number(val, num_threads) || num_threads == 0)
+                fatal("Invalid value '%s' for --threads\n", val);
+        } else if (opt == "--index") {
+            std::vector<std::string> names;
+            tokenize(names, val, ',');
+            index_fns.clear();
+            for (const auto &name : names) {
+                if (name != "sa" && name != "prince" &&
+                        !IndexFunction::create(name)) {
+                    fatal("Unknown index function '%s'\n", name);
+                }
+                index_fns.push_back(name);
+            }
+        } else {
+            panic("usage: %s [--ways=4,8] [--sets=16,32] "
+                  "[--max-evict=16,64] [--index=prince,qarma5,xor,sa] "
+                  "[--set-sizes=16,32,64] [--max-misses=N] [--seeds=N] "
+                  "[--trials=N] [--threads=N]\n", argv[0]);
+        }
+    }
+
+    std::vector<Config> configs;
+    for (const auto &index : index_fns) {
+        std::shared_ptr<const IndexFunction> function;
+        if (index != "sa" && index != "prince")
+            function = IndexFunction::create(index);
+        for (unsigned w : ways)
+            for (unsigned s : sets)
+                for (uint32_t m : max_evicts) {
+                    Config cfg = {w, s, m, index, function, set_sizes,
+                                  max_misses ? max_misses : 2 * w * s};
+                    // Sweep up to the number of entries in 16 steps
+                    if (cfg.setSizes.empty()) {
+                        unsigned step = std::max(1U, cfg.entries() / 16);
+                        for (unsigned n = step; n <= cfg.entries();
+                             n += step) {
+                            cfg.setSizes.push_back(n);
+                        }
+                    }
+                    configs.push_back(cfg);
+                    // The threshold does not matter without a key
+                    if (index == "sa" || index == "identity")
+                        break;
+                }
+    }
+
+    // One job per configuration and seed
+    std::vector<std::vector<std::vector<Result>>> results(configs.size());
+    for (size_t i = 0; i < configs.size(); i++) {
+        results[i].assign(num_seeds,
+                          std::vector<Result>(configs[i].setSizes.size()));
+    }
+    const size_t num_jobs = configs.size() * num_seeds;
+    std::atomic<size_t> next_job(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < std::min<size_t>(num_threads, num_jobs); t++) {
+        threads.emplace_back([&]() {
+            size_t job;
+            while ((job = next_job++) < num_jobs) {
+                size_t i = job / num_seeds;
+                size_t seed = job % num_seeds;
+                run(configs[i], trials, seed, results[i][seed]);
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    std::chrono::duration<double> secs =
+        std::chrono::steady_clock::now() - start;
+
+    cprintf("%-8s %5s %6s %10s %8s | %9s %9s %10s %8s | %7s %12s %12s "
+            "%10s %10s %8s\n",
+            "index", "ways", "sets", "max_evict", "set_size",
+            "evict_%", "misses", "rerands", "trials",
+            "found_%", "min_accesses", "avg_accesses", "min_misses",
+            "avg_misses", "rerands");
+    for (size_t i = 0; i < configs.size(); i++) {
+        const Config &cfg = configs[i];
+        for (size_t n = 0; n < cfg.setSizes.size(); n++) {
+            Result r;
+            for (const auto &seed_results : results[i])
+                r.add(seed_results[n]);
+
+            cprintf("%-8s %5d %6d %10d %8d | %9.2f %9.1f %10.3f %8d | "
+                    "%7.2f %12s %12.1f %10s %10.1f %8.3f\n",
+                    cfg.index, cfg.ways, cfg.sets,
+                    cfg.maxEvict, cfg.setSizes[n],
+                    100.0 * r.evictions / r.trials,
+                    (double)r.pruneMisses / r.trials,
+                    (double)r.pruneRerands / r.trials, r.trials,
+                    100.0 * r.found / r.runs, minOf(r.minAccesses),
+                    r.found ? (double)r.accesses / r.found : 0.0,
+                    minOf(r.minMisses),
+                    r.found ? (double)r.misses / r.found : 0.0,
+                    (double)r.rerands / r.runs);
+        }
+    }
+
+    cprintf("Ran %d configurations x %d seeds x %d trials in %.2fs\n",
+            configs.size(), num_seeds, trials, secs.count());
+
+    return 0;
+}
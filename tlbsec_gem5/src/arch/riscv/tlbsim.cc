@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Trace-driven TLB simulator. Replays translation traces recorded by the
+ * TLBTraceProbe against a sweep of TLBCache configurations (geometry,
+ * index function and rerandomization threshold) without the event queue
+ * and prints miss, rerandomization and eviction tables.
+ *
+ * Every TLB in the trace (see the id strings in its header, e.g. ITB and
+ * DTB) is replayed against its own TLBCache instance, including the
+ * demaps and flushes recorded between its translations. Configurations
+ * are distributed over host threads.
+ *
+ * usage: tlbsim [--ways=4,8] [--sets=16,32] [--max-evict=16,64]
+ *               [--index=prince,qarma5,xor,sa] [--threads=N] <trace>
+ *
+ * Index functions are sa (set associative), prince (the reduced PRINCE
+ * of the TLB) or any name IndexFunction::create() accepts, e.g. prince12,
+ * qarma5, xor or identity.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arch/riscv/index_function.hh"
+#include "arch/riscv/pagetable.hh"
+#include "arch/riscv/tlb_cache.hh"
+#include "base/bitfield.hh"
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/str.hh"
+#include "proto/protoio.hh"
+#include "proto/tlb_trace.pb.h"
+
+using namespace RiscvISA;
+
+namespace
+{
+
+struct TraceRecord
+{
+    Addr vaddr;
+    uint16_t asid;
+    uint8_t logBytes;
+    uint8_t tlbId;
+    // sfence.vma of vaddr and asid (0 for all) instead of a translation
+    bool demap;
+};
+
+struct Config
+{
+    unsigned ways;
+    unsigned sets;
+    uint32_t maxEvict;
+    // "sa", "prince" (the built-in PRINCE) or an IndexFunction name
+    std::string index;
+    std::shared_ptr<const IndexFunction> function;
+
+    bool randomized() const { return index != "sa"; }
+};
+
+struct Result
+{
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    uint64_t rerands = 0;
+    uint64_t evictions = 0;
+    uint64_t crossAsidEvictions = 0;
+};
+
+template <class T>
+std::vector<T>
+parseList(const std::string &opt, const std::string &value)
+{
+    std::vector<std::string> tokens;
+    tokenize(tokens, value, ',');
+    std::vector<T> list;
+    for (const auto &token : tokens) {
+        T val;
+        if (!to_number(token, val))
+            fatal("Invalid value '%s' for --%s\n", token, opt);
+        list.push_back(val);
+    }
+    return list;
+}
+
+std::vector<TraceRecord>
+loadTrace(const std::string &filename, std::vector<std::string> &tlb_names)
+{
+    ProtoInputStream trace(filename);
+
+    ProtoMessage::TlbTraceHeader header;
+    if (!trace.read(header))
+        fatal("Failed to read header of TLB trace %s\n", filename);
+    for (const auto &id_string : header.id_strings()) {
+        if (id_string.key() >= tlb_names.size())
+            tlb_names.resize(id_string.key() + 1);
+        tlb_names[id_string.key()] = id_string.value();
+    }
+
+    std::vector<TraceRecord> records;
+    ProtoMessage::TlbAccess access;
+    uint64_t faults = 0;
+    uint64_t demaps = 0;
+    while (trace.read(access)) {
+        // Faulting translations never made it into the TLB
+        if (!access.demap() && !access.has_log_bytes()) {
+            faults++;
+            continue;
+        }
+
+        TraceRecord rec;
+        rec.vaddr = access.vaddr();
+        rec.asid = access.asid();
+        // TLBCache only holds 4 KiB and 2 MiB pages, so gigapages are
+        // replayed at 2 MiB granularity.
+        rec.logBytes = std::min<unsigned>(access.log_bytes(),
+                                          PageShift + LEVEL_BITS);
+        rec.tlbId = access.tlb_id();
+        rec.demap = access.demap();
+        demaps += rec.demap;
+        if (rec.tlbId >= tlb_names.size())
+            tlb_names.resize(rec.tlbId + 1);
+        records.push_back(rec);
+    }
+
+    cprintf("Loaded %d translations and %d demaps (%d faulting ones "
+            "skipped) from %s\n", records.size() - demaps, demaps, faults,
+            filename);
+    return records;
+}
+
+void
+replay(const std::vector<TraceRecord> &trace, const Config &cfg,
+       std::vector<Result> &results)
+{
+    std::vector<std::unique_ptr<TLBCache>> tlbs;
+    for (unsigned i = 0; i < results.size(); i++) {
+        tlbs.emplace_back(new TLBCache(csprintf("tlb%d", i), cfg.ways,
+                                       cfg.sets, cfg.maxEvict,
+                                       cfg.randomized()));
+        if (cfg.function)
+            tlbs.back()->setIndexFunction(cfg.function.get());
+    }
+
+    TLBCache::InsertResult res;
+    for (const auto &rec : trace) {
+        Result &r = results[rec.tlbId];
+        TLBCache &tlb = *tlbs[rec.tlbId];
+
+        if (rec.demap) {
+            // Same cases as TLB::demap()
+            if (rec.vaddr == 0 && rec.asid == 0)
+                tlb.flushAll();
+            else if (rec.vaddr != 0 && rec.asid != 0)
+                tlb.demapPage(rec.vaddr, rec.asid);
+            else
+                tlb.demapPageComplex(rec.vaddr, rec.asid);
+            continue;
+        }
+
+        r.accesses++;
+        if (tlb.lookup(rec.vaddr, rec.asid))
+            continue;
+
+        r.misses++;
+        TlbEntry entry;
+        entry.vaddr = rec.vaddr & ~mask(rec.logBytes);
+        entry.logBytes = rec.logBytes;
+        entry.asid = rec.asid;
+        tlb.insert(entry.vaddr, entry, &res);
+        if (res.rerandomized)
+            r.rerands++;
+        if (res.evicted) {
+            r.evictions++;
+            if (res.evictedAsid != rec.asid)
+                r.crossAsidEvictions++;
+        }
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    std::vector<unsigned> ways = {4};
+    std::vector<unsigned> sets = {16};
+    std::vector<uint32_t> max_evicts = {MAX_EVICT};
+    std::vector<std::string> index_fns = {"prince"};
+    unsigned num_threads = std::max(1U, std::thread::hardware_concurrency());
+    std::string filename;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        std::string opt = arg.substr(0, eq);
+        std::string val = eq == std::string::npos ? "" : arg.substr(eq + 1);
+
+        if (opt == "--ways") {
+            ways = parseList<unsigned>("ways", val);
+        } else if (opt == "--sets") {
+            sets = parseList<unsigned>("sets", val);
+        } else if (opt == "--max-evict") {
+            max_evicts = parseList<uint32_t>("max-evict", val);
+        } else if (opt == "--threads") {
+            if (!to_number(val, num_threads) || num_threads == 0)
+                fatal("Invalid value '%s' for --threads\n", val);
+        } else if (opt == "--index") {
+            std::vector<std::string> names;
+            tokenize(names, val, ',');
+            index_fns.clear();
+            for (const auto &name : names) {
+                if (name != "sa" && name != "prince" &&
+                        !IndexFunction::create(name)) {
+                    fatal("Unknown index function '%s'\n", name);
+                }
+                index_fns.push_back(name);
+            }
+        } else if (arg[0] != '-' && filename.empty()) {
+            filename = arg;
+        } else {
+            panic("usage: %s [--ways=4,8] [--sets=16,32] "
+                  "[--max-evict=16,64] [--index=prince,qarma5,xor,sa] "
+                  "[--threads=N] <trace>\n", argv[0]);
+        }
+    }
+    if (filename.empty())
+        panic("usage: %s [options] <trace>\n", argv[0]);
+
+    std::vector<std::string> tlb_names;
+    std::vector<TraceRecord> trace = loadTrace(filename, tlb_names);
+
+    std::vector<Config> configs;
+    for (const auto &index : index_fns) {
+        std::shared_ptr<const IndexFunction> function;
+        if (index != "sa" && index != "prince")
+            function = IndexFunction::create(index);
+        for (unsigned w : ways)
+            for (unsigned s : sets)
+                for (uint32_t m : max_evicts) {
+                    configs.push_back({w, s, m, index, function});
+                    // The threshold does not matter without a key
+                    if (index == "sa" || index == "identity")
+                        break;
+                }
+    }
+
+    std::vector<std::vector<Result>> results(configs.size(),
+        std::vector<Result>(tlb_names.size()));
+    std::atomic<size_t> next_config(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < std::min<size_t>(num_threads, configs.size());
+         t++) {
+        threads.emplace_back([&]() {
+            size_t i;
+            while ((i = next_config++) < configs.size())
+                replay(trace, configs[i], results[i]);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    std::chrono::duration<double> secs =
+        std::chrono::steady_clock::now() - start;
+
+    cprintf("%-8s %5s %6s %8s %10s %-24s %14s %12s %9s %10s %12s %12s\n",
+            "index", "ways", "sets", "entries", "max_evict", "tlb",
+            "accesses", "misses", "miss_%", "rerands", "evictions",
+            "cross_asid");
+    for (size_t i = 0; i < configs.size(); i++) {
+        const Config &cfg = configs[i];
+        for (size_t id = 0; id < tlb_names.size(); id++) {
+            const Result &r = results[i][id];
+            if (r.accesses == 0)
+                continue;
+            cprintf("%-8s %5d %6d %8d %10d %-24s %14d %12d %9.4f %10d "
+                    "%12d %12d\n",
+                    cfg.index, cfg.ways, cfg.sets,
+                    cfg.ways * cfg.sets, cfg.maxEvict,
+                    tlb_names[id].empty() ? csprintf("tlb%d", id) :
+                                            tlb_names[id],
+                    r.accesses, r.misses, 100.0 * r.misses / r.accesses,
+                    r.rerands, r.evictions, r.crossAsidEvictions);
+        }
+    }
+
+    cprintf("Replayed %d configurations x %d records in %.2fs "
+            "(%.1fM records/s)\n", configs.size(), trace.size(),
+            secs.count(),
+            configs.size() * trace.size() / secs.count() / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_ORDER_STAT_TREE_HH__
+#define __BASE_ORDER_STAT_TREE_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * An ordered multiset that also answers rank queries ("how many keys are
+ * smaller than k") and selects the i-th smallest key, all in O(log n)
+ * expected time.
+ *
+ * It is implemented as a treap whose nodes are augmented with the size of
+ * their subtree. Nodes live in a vector and are addressed by index, so
+ * the tree does not allocate per insertion once it has reached its
+ * largest size. Priorities come from a fixed-seed generator to keep runs
+ * reproducible.
+ */
+template <typename Key, typename Compare = std::less<Key>>
+class OrderStatTree
+{
+  private:
+    typedef uint32_t NodeId;
+    static const NodeId Null = 0;
+
+    struct Node
+    {
+        Key key;
+        uint32_t priority;
+        uint32_t size;
+        NodeId left;
+        NodeId right;
+    };
+
+    /** All nodes, nodes[Null] is a sentinel with size 0. */
+    std::vector<Node> nodes;
+    std::vector<NodeId> freeNodes;
+    NodeId root;
+    uint32_t prioritySeed;
+    Compare comp;
+
+    uint32_t
+    nextPriority()
+    {
+        // xorshift32
+        prioritySeed ^= prioritySeed << 13;
+        prioritySeed ^= prioritySeed >> 17;
+        prioritySeed ^= prioritySeed << 5;
+        return prioritySeed;
+    }
+
+    uint32_t subtreeSize(NodeId n) const { return nodes[n].size; }
+
+    void
+    update(NodeId n)
+    {
+        nodes[n].size = 1 + subtreeSize(nodes[n].left) +
+            subtreeSize(nodes[n].right);
+    }
+
+    NodeId
+    allocNode(const Key &key)
+    {
+        NodeId n;
+        if (!freeNodes.empty()) {
+            n = freeNodes.back();
+            freeNodes.pop_back();
+        } else {
+            n = nodes.size();
+            nodes.emplace_back();
+        }
+        nodes[n].key = key;
+        nodes[n].priority = nextPriority();
+        nodes[n].size = 1;
+        nodes[n].left = nodes[n].right = Null;
+        return n;
+    }
+
+    /**
+     * Split the subtree t into the keys before key (l) and the rest (r).
+     * With inclusive set, keys equal to key go to l as well.
+     */
+    void
+    split(NodeId t, const Key &key, bool inclusive, NodeId &l, NodeId &r)
+    {
+        if (t == Null) {
+            l = r = Null;
+            return;
+        }
+        const bool goes_left = inclusive ? !comp(key, nodes[t].key) :
+            comp(nodes[t].key, key);
+        if (goes_left) {
+            split(nodes[t].right, key, inclusive, nodes[t].right, r);
+            l = t;
+        } else {
+            split(nodes[t].left, key, inclusive, l, nodes[t].left);
+            r = t;
+        }
+        update(t);
+    }
+
+    /** Merge two subtrees where all keys of l come before those of r. */
+    NodeId
+    merge(NodeId l, NodeId r)
+    {
+        if (l == Null)
+            return r;
+        if (r == Null)
+            return l;
+        if (nodes[l].priority > nodes[r].priority) {
+            NodeId right = merge(nodes[l].right, r);
+            nodes[l].right = right;
+            update(l);
+            return l;
+        } else {
+            NodeId left = merge(l, nodes[r].left);
+            nodes[r].left = left;
+            update(r);
+            return r;
+        }
+    }
+
+  public:
+    explicit OrderStatTree(const Compare &compare = Compare())
+        : nodes(1, Node()), root(Null), prioritySeed(0x9e3779b9),
+          comp(compare)
+    {
+        nodes[Null].size = 0;
+    }
+
+    size_t size() const { return subtreeSize(root); }
+    bool empty() const { return root == Null; }
+
+    /** Remove all keys. */
+    void
+    clear()
+    {
+        nodes.resize(1);
+        freeNodes.clear();
+        root = Null;
+    }
+
+    /** Insert a key, duplicates are kept. */
+    void
+    insert(const Key &key)
+    {
+        // Allocate first, this may move the nodes
+        const NodeId n = allocNode(key);
+        NodeId l, r;
+        split(root, key, false, l, r);
+        root = merge(merge(l, n), r);
+    }
+
+    /**
+     * Remove one instance of a key.
+     *
+     * @return false if the key was not in the tree.
+     */
+    bool
+    erase(const Key &key)
+    {
+        NodeId l, m, r;
+        split(root, key, false, l, r);
+        split(r, key, true, m, r);
+        const bool found = m != Null;
+        if (found) {
+            freeNodes.push_back(m);
+            m = merge(nodes[m].left, nodes[m].right);
+        }
+        root = merge(merge(l, m), r);
+        return found;
+    }
+
+    /** Number of keys that are smaller than key. */
+    size_t
+    countLess(const Key &key) const
+    {
+        size_t count = 0;
+        NodeId t = root;
+        while (t != Null) {
+            if (comp(nodes[t].key, key)) {
+                count += subtreeSize(nodes[t].left) + 1;
+                t = nodes[t].right;
+            } else {
+                t = nodes[t].left;
+            }
+        }
+        return count;
+    }
+
+    /** Number of keys that are greater than key. */
+    size_t
+    countGreater(const Key &key) const
+    {
+        size_t count = 0;
+        NodeId t = root;
+        while (t != Null) {
+            if (comp(key, nodes[t].key)) {
+                count += subtreeSize(nodes[t].right) + 1;
+                t = nodes[t].left;
+            } else {
+                t = nodes[t].right;
+            }
+        }
+        return count;
+    }
+
+    /** The i-th smallest key, counting from 0. */
+    const Key &
+    select(size_t i) const
+    {
+        assert(i < size());
+        NodeId t = root;
+        while (true) {
+            const size_t left_size = subtreeSize(nodes[t].left);
+            if (i < left_size) {
+                t = nodes[t].left;
+            } else if (i == left_size) {
+                return nodes[t].key;
+            } else {
+                i -= left_size + 1;
+                t = nodes[t].right;
+            }
+        }
+    }
+};
+
+#endif // __BASE_ORDER_STAT_TREE_HH__
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+
+#include "base/order_stat_tree.hh"
+
+TEST(OrderStatTreeTest, Empty)
+{
+    OrderStatTree<uint64_t> tree;
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(0U, tree.size());
+    EXPECT_EQ(0U, tree.countLess(10));
+    EXPECT_EQ(0U, tree.countGreater(10));
+    EXPECT_FALSE(tree.erase(10));
+}
+
+TEST(OrderStatTreeTest, RankAndSelect)
+{
+    OrderStatTree<uint64_t> tree;
+    for (uint64_t key : {50, 10, 40, 20, 30})
+        tree.insert(key);
+
+    EXPECT_EQ(5U, tree.size());
+    EXPECT_EQ(0U, tree.countLess(10));
+    EXPECT_EQ(2U, tree.countLess(30));
+    EXPECT_EQ(2U, tree.countLess(25));
+    EXPECT_EQ(5U, tree.countLess(60));
+    EXPECT_EQ(2U, tree.countGreater(30));
+    EXPECT_EQ(0U, tree.countGreater(50));
+    for (size_t i = 0; i < 5; i++)
+        EXPECT_EQ((i + 1) * 10, tree.select(i));
+}
+
+TEST(OrderStatTreeTest, Duplicates)
+{
+    OrderStatTree<int> tree;
+    tree.insert(3);
+    tree.insert(3);
+    tree.insert(1);
+    EXPECT_EQ(3U, tree.size());
+    EXPECT_EQ(1U, tree.countLess(3));
+    EXPECT_EQ(0U, tree.countGreater(3));
+
+    EXPECT_TRUE(tree.erase(3));
+    EXPECT_EQ(2U, tree.size());
+    EXPECT_EQ(3, tree.select(1));
+    EXPECT_TRUE(tree.erase(3));
+    EXPECT_FALSE(tree.erase(3));
+    EXPECT_EQ(1U, tree.size());
+}
+
+TEST(OrderStatTreeTest, Clear)
+{
+    OrderStatTree<int> tree;
+    for (int i = 0; i < 100; i++)
+        tree.insert(i);
+    tree.clear();
+    EXPECT_TRUE(tree.empty());
+    tree.insert(7);
+    EXPECT_EQ(1U, tree.size());
+    EXPECT_EQ(7, tree.select(0));
+}
+
+/** Random inserts and erases checked against std::multiset. */
+TEST(OrderStatTreeTest, MatchesMultiset)
+{
+    std::mt19937 rng(1);
+    OrderStatTree<int> tree;
+    std::multiset<int> ref;
+
+    for (int i = 0; i < 20000; i++) {
+        const int key = rng() % 1000;
+        if (rng() % 3 == 0) {
+            const bool in_ref = ref.find(key) != ref.end();
+            if (in_ref)
+                ref.erase(ref.find(key));
+            ASSERT_EQ(in_ref, tree.erase(key));
+        } else {
+            ref.insert(key);
+            tree.insert(key);
+        }
+        ASSERT_EQ(ref.size(), tree.size());
+
+        const int probe = rng() % 1000;
+        ASSERT_EQ((size_t)std::distance(ref.begin(), ref.lower_bound(probe)),
+                  tree.countLess(probe));
+        ASSERT_EQ((size_t)std::distance(ref.upper_bound(probe), ref.end()),
+                  tree.countGreater(probe));
+        if (!ref.empty()) {
+            const size_t idx = rng() % ref.size();
+            ASSERT_EQ(*std::next(ref.begin(), idx), tree.select(idx));
+        }
+    }
+}
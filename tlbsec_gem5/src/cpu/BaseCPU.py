@@ -47,6 +47,7 @@ from m5.proxy import *
 from m5.util.fdthelper import *
 
 from m5.objects.ClockedObject import ClockedObject
+from m5.objects.EventqCrossing import EventqCrossing
 from m5.objects.XBar import L2XBar
 from m5.objects.InstTracer import InstTracer
 from m5.objects.CPUTracers import ExeTracer
@@ -198,6 +199,22 @@ class BaseCPU(ClockedObject):
         for p in self._uncached_interrupt_request_ports:
             exec('self.%s = bus.slave' % p)
 
+    def addEventqCrossings(self, mem_side_eventq_index=0):
+        """Put an EventqCrossing on every port that connectAllPorts()
+        will connect to the cached bus, so that the CPU and its private
+        caches (e.g. those of addPrivateSplitL1Caches()) can be simulated
+        by another event queue than mem_side_eventq_index. Caches stay
+        in the queue of the CPU, only their misses cross."""
+        self.eventq_crossings = [
+            EventqCrossing(mem_side_eventq_index=mem_side_eventq_index)
+            for p in self._cached_ports ]
+        cached_ports = []
+        for i, (xing, p) in enumerate(zip(self.eventq_crossings,
+                                          self._cached_ports)):
+            exec('xing.cpu_side_port = self.%s' % p)
+            cached_ports.append('eventq_crossings[%d].mem_side_port' % i)
+        self._cached_ports = cached_ports
+
     def connectAllPorts(self, cached_bus, uncached_bus = None):
         self.connectCachedPorts(cached_bus)
         if not uncached_bus:
@@ -74,6 +74,8 @@ class StaticInstFlags(Enum):
         'IsSerializeAfter',
         'IsWriteBarrier',   # Is a write barrier
         'IsReadBarrier',    # Is a read barrier
+        'IsInstSync',       # Makes earlier stores visible to instruction
+                            # fetch, e.g. RISC-V fence.i
 
         'IsNonSpeculative', # Should not be executed speculatively
         'IsQuiesce',        # Is a quiesce instruction
@@ -127,7 +127,8 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
       _dataRequestorId(p.system->getRequestorId(this, "data")),
       _taskId(ContextSwitchTaskId::Unknown), _pid(invldPid),
       _switchedOut(p.switched_out), _cacheLineSize(p.system->cacheLineSize()),
-      interrupts(p.interrupts), numThreads(p.numThreads), system(p.system),
+      interrupts(p.interrupts), _mailbox(eventQueue(), name() + ".mailbox"),
+      numThreads(p.numThreads), system(p.system),
       previousCycle(0), previousState(CPU_STATE_SLEEP),
       functionTraceStream(nullptr), currentFunctionStart(0),
       currentFunctionEnd(0), functionEntryTick(0),
@@ -539,8 +540,17 @@ BaseCPU::switchOut()
     _switchedOut = true;
 
     // Flush all TLBs in the CPU to avoid having stale translations if
-    // it gets switched in later.
-    flushTLBs();
+    // it gets switched in later. TLBs that the CPU switched in takes
+    // over may keep their entries for it instead.
+    for (ThreadID i = 0; i < threadContexts.size(); ++i) {
+        ThreadContext &tc(*threadContexts[i]);
+        CheckerCPU *checker(tc.getCheckerCpuPtr());
+
+        tc.getMMUPtr()->switchOut();
+        if (checker) {
+            checker->getMMUPtr()->flushAll();
+        }
+    }
 
     // Go to the power gating state
     powerState->set(Enums::PwrState::OFF);
@@ -55,6 +55,7 @@
 #include "mem/port_proxy.hh"
 #include "sim/clocked_object.hh"
 #include "sim/eventq.hh"
+#include "sim/eventq_mailbox.hh"
 #include "sim/full_system.hh"
 #include "sim/insttracer.hh"
 #include "sim/probe/pmu.hh"
@@ -231,7 +232,16 @@ class BaseCPU : public ClockedObject
   protected:
     std::vector<BaseInterrupts*> interrupts;
 
+    /** Work posted to this CPU by other event queues. */
+    EventqMailbox _mailbox;
+
   public:
+    /**
+     * Run work in the event queue of this CPU, e.g. to deliver an
+     * interrupt from a device simulated by another event queue.
+     */
+    EventqMailbox &mailbox() { return _mailbox; }
+
     BaseInterrupts *
     getInterruptController(ThreadID tid)
     {
@@ -31,10 +31,12 @@
 #include <string>
 #include <vector>
 
+#include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/base.hh"
 #include "cpu/thread_context.hh"
 #include "debug/IntrControl.hh"
+#include "sim/eventq.hh"
 #include "sim/sim_object.hh"
 
 IntrControl::IntrControl(const Params &p)
@@ -46,7 +48,10 @@ IntrControl::post(int cpu_id, int int_num, int index)
 {
     DPRINTF(IntrControl, "post  %d:%d (cpu %d)\n", int_num, index, cpu_id);
     auto *tc = sys->threads[cpu_id];
-    tc->getCpuPtr()->postInterrupt(tc->threadId(), int_num, index);
+    // Devices may run in another event queue than the CPU
+    tc->getCpuPtr()->mailbox().post([tc, int_num, index]{
+        tc->getCpuPtr()->postInterrupt(tc->threadId(), int_num, index);
+    });
 }
 
 void
@@ -54,7 +59,9 @@ IntrControl::clear(int cpu_id, int int_num, int index)
 {
     DPRINTF(IntrControl, "clear %d:%d (cpu %d)\n", int_num, index, cpu_id);
     auto *tc = sys->threads[cpu_id];
-    tc->getCpuPtr()->clearInterrupt(tc->threadId(), int_num, index);
+    tc->getCpuPtr()->mailbox().post([tc, int_num, index]{
+        tc->getCpuPtr()->clearInterrupt(tc->threadId(), int_num, index);
+    });
 }
 
 void
@@ -62,7 +69,9 @@ IntrControl::clearAll(int cpu_id)
 {
     DPRINTF(IntrControl, "Clear all pending interrupts for CPU %d\n", cpu_id);
     auto *tc = sys->threads[cpu_id];
-    tc->getCpuPtr()->clearInterrupts(tc->threadId());
+    tc->getCpuPtr()->mailbox().post([tc]{
+        tc->getCpuPtr()->clearInterrupts(tc->threadId());
+    });
 }
 
 bool
@@ -70,5 +79,9 @@ IntrControl::havePosted(int cpu_id) const
 {
     DPRINTF(IntrControl, "Check pending interrupts for CPU %d\n", cpu_id);
     auto *tc = sys->threads[cpu_id];
+    panic_if(inParallelMode &&
+             tc->getCpuPtr()->eventQueue() != curEventQueue(),
+             "Interrupts of CPU %d can't be checked from another event "
+             "queue.\n", cpu_id);
     return tc->getCpuPtr()->checkInterrupts(tc->threadId());
 }
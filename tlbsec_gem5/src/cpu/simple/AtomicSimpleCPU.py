@@ -59,6 +59,15 @@ class AtomicSimpleCPU(BaseSimpleCPU):
     width = Param.Int(1, "CPU width")
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
+    block_cache = Param.Bool(False, "Execute from a cache of decoded basic "
+        "blocks instead of fetching and decoding every instruction "
+        "(RISC-V only)")
+    block_cache_blocks = Param.Unsigned(16384, "Number of blocks the block "
+        "cache holds before it is flushed")
+    block_cache_insts = Param.Unsigned(64, "Maximum instructions per block")
+    data_backdoor = Param.Bool(False, "Load and store through memory "
+        "backdoors, without packets, when the data TLB maps the page to "
+        "host memory (stores only if this is the only CPU)")
 
     def addSimPointProbe(self, interval):
         simpoint = SimPoint()
@@ -77,6 +77,8 @@ AtomicSimpleCPU::AtomicSimpleCPU(const AtomicSimpleCPUParams &p)
       width(p.width), locked(false),
       simulate_data_stalls(p.simulate_data_stalls),
       simulate_inst_stalls(p.simulate_inst_stalls),
+      curBlock(nullptr), curBlockPC(0), curBlockPos(0), recBlockPC(0),
+      dataBackdoor(p.data_backdoor),
       icachePort(name() + ".icache_port", this),
       dcachePort(name() + ".dcache_port", this),
       dcache_access(false), dcache_latency(0),
@@ -87,6 +89,37 @@ AtomicSimpleCPU::AtomicSimpleCPU(const AtomicSimpleCPUParams &p)
     data_read_req = std::make_shared<Request>();
     data_write_req = std::make_shared<Request>();
     data_amo_req = std::make_shared<Request>();
+
+    if (p.block_cache) {
+        fatal_if(THE_ISA != RISCV_ISA,
+                 "%s: The block cache only supports RISC-V.", name());
+        fatal_if(numThreads > 1,
+                 "%s: The block cache supports a single thread only.",
+                 name());
+        fatal_if(simulate_inst_stalls,
+                 "%s: Instructions from the block cache are not fetched, "
+                 "so they cannot simulate icache stalls.", name());
+        blockCache.reset(new InstBlockCache(p.block_cache_blocks,
+                                            p.block_cache_insts,
+                                            TheISA::PageBytes));
+        blockStats.reset(new BlockCacheStats(this));
+    }
+
+    fatal_if(dataBackdoor && simulate_data_stalls,
+             "%s: Accesses through a backdoor cannot simulate dcache "
+             "stalls.", name());
+}
+
+AtomicSimpleCPU::BlockCacheStats::BlockCacheStats(Stats::Group *parent)
+    : Stats::Group(parent, "blockCache"),
+      ADD_STAT(hits, UNIT_COUNT, "Blocks entered from the cache"),
+      ADD_STAT(misses, UNIT_COUNT, "Blocks recorded from the decoder"),
+      ADD_STAT(insts, UNIT_COUNT,
+               "Instructions executed from the cache without decoding"),
+      ADD_STAT(invalidations, UNIT_COUNT,
+               "Writes that dropped the blocks of a page"),
+      ADD_STAT(flushes, UNIT_COUNT, "Flushes of the whole cache")
+{
 }
 
 
@@ -147,6 +180,9 @@ AtomicSimpleCPU::drainResume()
     DPRINTF(SimpleCPU, "Resume\n");
     verifyMemoryMode();
 
+    // Memory may have been restored from a checkpoint
+    flushBlocks();
+
     assert(!threadContexts.empty());
 
     _status = BaseSimpleCPU::Idle;
@@ -192,6 +228,9 @@ AtomicSimpleCPU::switchOut()
 {
     BaseSimpleCPU::switchOut();
 
+    // Other CPUs will change memory without this one snooping
+    flushBlocks();
+
     assert(!tickEvent.scheduled());
     assert(_status == BaseSimpleCPU::Running || _status == Idle);
     assert(isCpuDrained());
@@ -298,6 +337,7 @@ AtomicSimpleCPU::AtomicCPUDPort::recvAtomicSnoop(PacketPtr pkt)
         for (auto &t_info : cpu->threadInfo) {
             TheISA::handleLockedSnoop(t_info->thread, pkt, cacheBlockMask);
         }
+        cpu->invalidateBlocks(pkt->getAddr(), pkt->getSize());
     }
 
     return 0;
@@ -325,6 +365,9 @@ AtomicSimpleCPU::AtomicCPUDPort::recvFunctionalSnoop(PacketPtr pkt)
             TheISA::handleLockedSnoop(t_info->thread, pkt, cacheBlockMask);
         }
     }
+
+    if (pkt->isInvalidate() || pkt->isWrite())
+        cpu->invalidateBlocks(pkt->getAddr(), pkt->getSize());
 }
 
 bool
@@ -378,25 +421,38 @@ AtomicSimpleCPU::readMem(Addr addr, uint8_t *data, unsigned size,
     int size_left = size;
     bool predicate;
     Fault fault = NoFault;
+    const bool backdoor = dataBackdoor && flags == 0 && byte_enable.empty();
 
     while (1) {
         predicate = genMemFragmentRequest(req, frag_addr, size, flags,
                                           byte_enable, frag_size, size_left);
 
+        uint8_t *host = nullptr;
+        if (predicate && backdoor) {
+            host = thread->mmu->translateHost(req, thread->getTC(),
+                                              BaseTLB::Read);
+        }
+
         // translate to physical address
-        if (predicate) {
+        if (predicate && !host) {
             fault = thread->mmu->translateAtomic(req, thread->getTC(),
                                                  BaseTLB::Read);
         }
 
         // Now do the access.
-        if (predicate && fault == NoFault &&
+        if (host) {
+            memcpy(data, host, frag_size);
+            dcache_access = true;
+        } else if (predicate && fault == NoFault &&
             !req->getFlags().isSet(Request::NO_ACCESS)) {
             Packet pkt(req, Packet::makeReadCmd(req));
             pkt.dataStatic(data);
 
             if (req->isLocalAccess()) {
                 dcache_latency += req->localAccessor(thread->getTC(), &pkt);
+            } else if (backdoor) {
+                dcache_latency += sendDataPacket(&pkt);
+                setHostPage(req, BaseTLB::Read);
             } else {
                 dcache_latency += sendPacket(dcachePort, &pkt);
             }
@@ -464,18 +520,31 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size, Addr addr,
     int curr_frag_id = 0;
     bool predicate;
     Fault fault = NoFault;
+    // Stores through a backdoor are not snooped by other CPUs
+    const bool backdoor = dataBackdoor && system->threads.size() == 1 &&
+        flags == 0 && !res && byte_enable.empty();
 
     while (1) {
         predicate = genMemFragmentRequest(req, frag_addr, size, flags,
                                           byte_enable, frag_size, size_left);
 
+        uint8_t *host = nullptr;
+        if (predicate && backdoor) {
+            host = thread->mmu->translateHost(req, thread->getTC(),
+                                              BaseTLB::Write);
+        }
+
         // translate to physical address
-        if (predicate)
+        if (predicate && !host)
             fault = thread->mmu->translateAtomic(req, thread->getTC(),
                                                  BaseTLB::Write);
 
         // Now do the access.
-        if (predicate && fault == NoFault) {
+        if (host) {
+            memcpy(host, data, frag_size);
+            invalidateBlocks(req->getPaddr(), frag_size);
+            dcache_access = true;
+        } else if (predicate && fault == NoFault) {
             bool do_access = true;  // flag to suppress cache access
 
             if (req->isLLSC()) {
@@ -499,10 +568,14 @@ AtomicSimpleCPU::writeMem(uint8_t *data, unsigned size, Addr addr,
                     dcache_latency +=
                         req->localAccessor(thread->getTC(), &pkt);
                 } else {
-                    dcache_latency += sendPacket(dcachePort, &pkt);
+                    dcache_latency += backdoor ? sendDataPacket(&pkt) :
+                        sendPacket(dcachePort, &pkt);
 
                     // Notify other threads on this CPU of write
                     threadSnoop(&pkt, curThread);
+                    invalidateBlocks(req->getPaddr(), req->getSize());
+                    if (backdoor)
+                        setHostPage(req, BaseTLB::Write);
                 }
                 dcache_access = true;
                 assert(!pkt.isError());
@@ -590,6 +663,7 @@ AtomicSimpleCPU::amoMem(Addr addr, uint8_t* data, unsigned size,
             dcache_latency += req->localAccessor(thread->getTC(), &pkt);
         } else {
             dcache_latency += sendPacket(dcachePort, &pkt);
+            invalidateBlocks(req->getPaddr(), req->getSize());
         }
 
         dcache_access = true;
@@ -628,8 +702,13 @@ AtomicSimpleCPU::tick()
     SimpleThread *thread = t_info.thread;
 
     Tick latency = 0;
+    // Instructions of a block beyond the width, one cycle each
+    Cycles block_cycles(0);
+
+    for (int i = 0; i < width || locked || continueBlock(t_info); ++i) {
+        if (i >= width && !locked)
+            ++block_cycles;
 
-    for (int i = 0; i < width || locked; ++i) {
         baseStats.numCycles++;
         updateCycleCounters(BaseCPU::CPU_STATE_ON);
 
@@ -650,11 +729,26 @@ AtomicSimpleCPU::tick()
 
         bool needToFetch = !isRomMicroPC(pcState.microPC()) &&
                            !curMacroStaticInst;
-        if (needToFetch) {
+        const InstBlockCache::Inst *block_inst = nullptr;
+        if (needToFetch && curBlock)
+            block_inst = nextBlockInst(pcState);
+        if (needToFetch && !block_inst) {
             ifetch_req->taskId(taskId());
             setupFetchRequest(ifetch_req);
             fault = thread->mmu->translateAtomic(ifetch_req, thread->getTC(),
                                                  BaseTLB::Execute);
+            if (blockCache && fault == NoFault && t_info.fetchOffset == 0) {
+                block_inst = enterBlock(pcState,
+                        ifetch_req->getPaddr() +
+                        (pcState.instAddr() - ifetch_req->getVaddr()));
+            }
+        }
+        if (block_inst) {
+            // The block stands in for fetch and decode
+            needToFetch = false;
+            pcState.npc(pcState.instAddr() + block_inst->size);
+            thread->pcState(pcState);
+            ++blockStats->insts;
         }
 
         if (fault == NoFault) {
@@ -675,7 +769,13 @@ AtomicSimpleCPU::tick()
                 //}
             }
 
-            preExecute();
+            if (block_inst) {
+                preExecute(block_inst->staticInst);
+            } else {
+                preExecute();
+                if (recBlock && needToFetch && curStaticInst)
+                    recordInst(thread->pcState());
+            }
 
             Tick stall_ticks = 0;
             if (curStaticInst) {
@@ -685,6 +785,15 @@ AtomicSimpleCPU::tick()
                 if (fault == NoFault) {
                     countInst();
                     ppCommit->notify(std::make_pair(thread, curStaticInst));
+
+                    // Code may have changed without the block cache
+                    // seeing the writes: fence.i orders earlier stores
+                    // before later fetches, and emulated syscalls write
+                    // memory functionally through this CPU's own port.
+                    if (blockCache && (curStaticInst->isInstSync() ||
+                            (!FullSystem && curStaticInst->isSyscall()))) {
+                        flushBlocks();
+                    }
                 } else if (traceData) {
                     traceFault();
                 }
@@ -731,11 +840,186 @@ AtomicSimpleCPU::tick()
     // instruction takes at least one cycle
     if (latency < clockPeriod())
         latency = clockPeriod();
+    latency += cyclesToTicks(block_cycles);
 
     if (_status != Idle)
         reschedule(tickEvent, curTick() + latency, true);
 }
 
+const InstBlockCache::Inst *
+AtomicSimpleCPU::enterBlock(const TheISA::PCState &pc, Addr paddr)
+{
+    if (recBlock) {
+        const auto &insts = recBlock->insts;
+        Addr rec_end = insts.empty() ? 0 :
+            insts.back().offset + insts.back().size;
+        // The block goes on only if this instruction follows it both
+        // virtually and physically
+        if (pc.instAddr() != recBlockPC + rec_end ||
+            paddr != recBlock->paddr + rec_end ||
+            blockCache->full(*recBlock)) {
+            finishRecording();
+        }
+    }
+
+    const InstBlockCache::Block *block = blockCache->find(paddr);
+    if (!block) {
+        if (!recBlock) {
+            ++blockStats->misses;
+            recBlock.reset(new InstBlockCache::Block{paddr, {}});
+            recBlockPC = pc.instAddr();
+        }
+        return nullptr;
+    }
+
+    if (recBlock)
+        finishRecording();
+
+    ++blockStats->hits;
+    curBlock = block;
+    curBlockPC = pc.instAddr();
+    curBlockPos = 0;
+    return nextBlockInst(pc);
+}
+
+const InstBlockCache::Inst *
+AtomicSimpleCPU::nextBlockInst(const TheISA::PCState &pc)
+{
+    if (curBlockPos < curBlock->insts.size()) {
+        const InstBlockCache::Inst &inst = curBlock->insts[curBlockPos];
+        if (pc.instAddr() == curBlockPC + inst.offset) {
+            ++curBlockPos;
+            return &inst;
+        }
+    }
+
+    curBlock = nullptr;
+    return nullptr;
+}
+
+bool
+AtomicSimpleCPU::continueBlock(const SimpleExecContext &t_info) const
+{
+    if (!curBlock || curBlockPos == curBlock->insts.size() ||
+        _status != BaseSimpleCPU::Running || t_info.stayAtPC) {
+        return false;
+    }
+
+    // Leave instruction count events to the next tick, so that a
+    // simulation exiting on one doesn't run past it
+    const EventQueue &com_inst_queue = t_info.thread->comInstEventQueue;
+    if (!com_inst_queue.empty() &&
+        com_inst_queue.nextTick() <= t_info.numInst) {
+        return false;
+    }
+
+    return t_info.thread->instAddr() ==
+        curBlockPC + curBlock->insts[curBlockPos].offset;
+}
+
+void
+AtomicSimpleCPU::recordInst(const TheISA::PCState &pc)
+{
+    const auto &insts = recBlock->insts;
+    Addr offset = pc.instAddr() - recBlockPC;
+    Addr rec_end = insts.empty() ? 0 :
+        insts.back().offset + insts.back().size;
+    Addr size = pc.npc() - pc.instAddr();
+
+    if (offset != rec_end || size == 0 || size > sizeof(TheISA::MachInst) ||
+        !blockCache->fits(*recBlock, curStaticInst, recBlock->paddr + offset,
+                          size)) {
+        finishRecording();
+        return;
+    }
+
+    recBlock->insts.push_back({curStaticInst, (uint32_t)offset,
+                               (uint8_t)size});
+    if (InstBlockCache::endsBlock(curStaticInst))
+        finishRecording();
+}
+
+void
+AtomicSimpleCPU::finishRecording()
+{
+    blockCache->insert(std::move(recBlock));
+    recBlock.reset();
+}
+
+void
+AtomicSimpleCPU::invalidateBlocks(Addr paddr, Addr size)
+{
+    if (!blockCache)
+        return;
+
+    if (recBlock && blockCache->touches(*recBlock, paddr, size))
+        recBlock.reset();
+
+    if (blockCache->invalidate(paddr, size)) {
+        DPRINTF(SimpleCPU, "Write to %#x dropped decoded blocks\n", paddr);
+        ++blockStats->invalidations;
+        curBlock = nullptr;
+    }
+}
+
+void
+AtomicSimpleCPU::flushBlocks()
+{
+    if (!blockCache)
+        return;
+
+    blockCache->flush();
+    curBlock = nullptr;
+    recBlock.reset();
+    ++blockStats->flushes;
+}
+
+Tick
+AtomicSimpleCPU::sendDataPacket(const PacketPtr &pkt)
+{
+    MemBackdoorPtr bd = nullptr;
+    Tick latency = dcachePort.sendAtomicBackdoor(pkt, bd);
+
+    if (bd && dataBackdoors.insert(bd->range(), bd) != dataBackdoors.end()) {
+        // The TLBs may point into the backdoor, so they forget all host
+        // pages when it goes away.
+        auto callback = [this](const MemBackdoor &backdoor) {
+                for (auto it = dataBackdoors.begin();
+                        it != dataBackdoors.end(); it++) {
+                    if (it->second == &backdoor) {
+                        dataBackdoors.erase(it);
+                        for (auto *tc : threadContexts)
+                            tc->getMMUPtr()->flushHostPages();
+                        return;
+                    }
+                }
+                panic("Got invalidation for unknown memory backdoor.");
+            };
+        bd->addInvalidationCallback(callback);
+    }
+    return latency;
+}
+
+void
+AtomicSimpleCPU::setHostPage(const RequestPtr &req, BaseTLB::Mode mode)
+{
+    if (req->isUncacheable())
+        return;
+
+    Addr page = roundDown(req->getPaddr(), TheISA::PageBytes);
+    auto it = dataBackdoors.contains(RangeSize(page, TheISA::PageBytes));
+    if (it == dataBackdoors.end())
+        return;
+
+    const MemBackdoor &bd = *it->second;
+    if (!bd.readable() || (mode == BaseTLB::Write && !bd.writeable()))
+        return;
+
+    threadInfo[curThread]->thread->mmu->setHostPage(req,
+            threadContexts[curThread], mode,
+            bd.ptr() + (page - bd.range().start()));
+}
+
 Tick
 AtomicSimpleCPU::fetchInstMem()
 {
@@ -41,8 +41,13 @@
 #ifndef __CPU_SIMPLE_ATOMIC_HH__
 #define __CPU_SIMPLE_ATOMIC_HH__
 
+#include <memory>
+
+#include "base/addr_range_map.hh"
 #include "cpu/simple/base.hh"
 #include "cpu/simple/exec_context.hh"
+#include "cpu/simple/inst_block_cache.hh"
+#include "mem/backdoor.hh"
 #include "mem/request.hh"
 #include "params/AtomicSimpleCPU.hh"
 #include "sim/probe/probe.hh"
@@ -67,6 +72,83 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     // main simulation loop (one cycle)
     void tick();
 
+    /**
+     * Decoded basic blocks, or nullptr if the block cache is disabled.
+     *
+     * A block is looked up by the physical address of its first
+     * instruction once that has been translated, and then executed
+     * without fetching or decoding, all within the same tick. The
+     * translation of the block entry is never skipped, so blocks need
+     * not be tagged with the address space or privilege they were
+     * recorded in: a decoded instruction only depends on its bytes.
+     */
+    std::unique_ptr<InstBlockCache> blockCache;
+
+    /** Block being executed, its virtual start and next instruction. */
+    const InstBlockCache::Block *curBlock;
+    Addr curBlockPC;
+    size_t curBlockPos;
+
+    /** Block being recorded from the decoder, and its virtual start. */
+    std::unique_ptr<InstBlockCache::Block> recBlock;
+    Addr recBlockPC;
+
+    struct BlockCacheStats : public Stats::Group
+    {
+        BlockCacheStats(Stats::Group *parent);
+
+        Stats::Scalar hits;
+        Stats::Scalar misses;
+        Stats::Scalar insts;
+        Stats::Scalar invalidations;
+        Stats::Scalar flushes;
+    };
+    std::unique_ptr<BlockCacheStats> blockStats;
+
+    /**
+     * Enter the block at the translated fetch address, or start
+     * recording one there.
+     *
+     * @return The first instruction of the block, or nullptr.
+     */
+    const InstBlockCache::Inst *enterBlock(const TheISA::PCState &pc,
+                                           Addr paddr);
+
+    /**
+     * The next instruction of the current block, or nullptr if the
+     * thread left it.
+     */
+    const InstBlockCache::Inst *nextBlockInst(const TheISA::PCState &pc);
+
+    /** Whether the tick should go on with the current block. */
+    bool continueBlock(const SimpleExecContext &t_info) const;
+
+    /** Add the instruction just decoded to the block being recorded. */
+    void recordInst(const TheISA::PCState &pc);
+    void finishRecording();
+
+    /** Drop the blocks of pages written at [paddr, paddr + size). */
+    void invalidateBlocks(Addr paddr, Addr size);
+    void flushBlocks();
+
+    /**
+     * Whether plain loads and stores use memory backdoors. The data TLB
+     * remembers the host memory of the pages they access, and later
+     * accesses to these pages skip translateAtomic() and the packet; see
+     * BaseTLB::translateHost(). Stores only do so if this is the only
+     * CPU, as nothing snoops them.
+     */
+    const bool dataBackdoor;
+    AddrRangeMap<MemBackdoorPtr, 1> dataBackdoors;
+
+    /** Send a data packet, collecting the backdoor of its target. */
+    Tick sendDataPacket(const PacketPtr &pkt);
+    /**
+     * Tell the data TLB where the page of req, just translated for a
+     * plain access, is in host memory, if a backdoor holds all of it.
+     */
+    void setHostPage(const RequestPtr &req, BaseTLB::Mode mode);
+
     /**
      * Check if a system is in a drained state.
      *
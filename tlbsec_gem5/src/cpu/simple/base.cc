@@ -302,7 +302,7 @@ BaseSimpleCPU::setupFetchRequest(const RequestPtr &req)
 
 
 void
-BaseSimpleCPU::preExecute()
+BaseSimpleCPU::preExecute(const StaticInstPtr &predecoded)
 {
     SimpleExecContext &t_info = *threadInfo[curThread];
     SimpleThread* thread = t_info.thread;
@@ -324,6 +324,10 @@ BaseSimpleCPU::preExecute()
         t_info.stayAtPC = false;
         curStaticInst = thread->decoder.fetchRomMicroop(
                 pcState.microPC(), curMacroStaticInst);
+    } else if (predecoded) {
+        assert(!curMacroStaticInst && !predecoded->isMacroop());
+        t_info.stayAtPC = false;
+        curStaticInst = predecoded;
     } else if (!curMacroStaticInst) {
         //We're not in the middle of a macro instruction
         StaticInstPtr instPtr = NULL;
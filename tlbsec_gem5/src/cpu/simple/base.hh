@@ -131,7 +131,13 @@ class BaseSimpleCPU : public BaseCPU
   public:
     void checkForInterrupts();
     void setupFetchRequest(const RequestPtr &req);
-    void preExecute();
+    /**
+     * Prepare the instruction at the current PC for execution.
+     *
+     * @param predecoded The instruction, if the CPU already has it
+     *        decoded and has set the next PC. The decoder is skipped.
+     */
+    void preExecute(const StaticInstPtr &predecoded = StaticInstPtr());
     void postExecute();
     void advancePC(const Fault &fault);
 
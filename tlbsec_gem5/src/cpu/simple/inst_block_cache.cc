@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "cpu/simple/inst_block_cache.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+InstBlockCache::InstBlockCache(size_t max_blocks, size_t max_insts,
+                               Addr page_bytes)
+    : maxBlocks(max_blocks), maxInsts(max_insts), pageBytes(page_bytes)
+{
+    fatal_if(!isPowerOf2(pageBytes),
+             "Block cache page size must be a power of 2.");
+    fatal_if(maxBlocks == 0 || maxInsts == 0,
+             "Block cache needs room for at least one instruction.");
+}
+
+void
+InstBlockCache::insert(std::unique_ptr<Block> block)
+{
+    if (block->insts.empty())
+        return;
+
+    if (blocks.size() >= maxBlocks)
+        flush();
+
+    Addr paddr = block->paddr;
+    auto it = blocks.find(paddr);
+    if (it != blocks.end()) {
+        it->second = std::move(block);
+        return;
+    }
+    pages[pageOf(paddr)].push_back(paddr);
+    blocks.emplace(paddr, std::move(block));
+}
+
+bool
+InstBlockCache::invalidatePage(Addr page)
+{
+    auto it = pages.find(page);
+    if (it == pages.end())
+        return false;
+
+    for (Addr paddr : it->second)
+        blocks.erase(paddr);
+    pages.erase(it);
+    return true;
+}
+
+void
+InstBlockCache::flush()
+{
+    blocks.clear();
+    pages.clear();
+}
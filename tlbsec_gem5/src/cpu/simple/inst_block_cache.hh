@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __CPU_SIMPLE_INST_BLOCK_CACHE_HH__
+#define __CPU_SIMPLE_INST_BLOCK_CACHE_HH__
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/static_inst.hh"
+
+/**
+ * Decoded basic blocks of the atomic CPU.
+ *
+ * A block is the run of instructions decoded from one physical page,
+ * starting at the physical address it is found by. It ends with the
+ * first instruction that may change the control flow or the state the
+ * following instructions are decoded in: branches and jumps, but also
+ * everything serializing or non-speculative (CSR accesses, fences,
+ * sfence.vma, ecall, xret). Instructions that cross the end of the page
+ * or are split into microops are never part of a block.
+ *
+ * Blocks are dropped a page at a time, whenever that page is written,
+ * and all at once on an instruction fetch barrier or when the cache is
+ * full.
+ */
+class InstBlockCache
+{
+  public:
+    struct Inst
+    {
+        StaticInstPtr staticInst;
+        /** Offset of the instruction from the start of the block. */
+        uint32_t offset;
+        /** Size of the instruction in bytes. */
+        uint8_t size;
+    };
+
+    struct Block
+    {
+        Addr paddr;
+        std::vector<Inst> insts;
+    };
+
+    /**
+     * @param max_blocks Number of blocks the cache holds before it is
+     *        flushed.
+     * @param max_insts Length limit of a block.
+     * @param page_bytes Size of the pages blocks are confined to.
+     */
+    InstBlockCache(size_t max_blocks, size_t max_insts, Addr page_bytes);
+
+    /** The block starting at paddr, or nullptr. */
+    const Block *
+    find(Addr paddr) const
+    {
+        auto it = blocks.find(paddr);
+        return it == blocks.end() ? nullptr : it->second.get();
+    }
+
+    /**
+     * Add a recorded block to the cache, flushing it first if it is
+     * full. Empty blocks are dropped.
+     */
+    void insert(std::unique_ptr<Block> block);
+
+    /**
+     * Whether an instruction can be added to a block.
+     *
+     * @param inst The decoded instruction.
+     * @param paddr Physical address of the instruction.
+     * @param size Size of the instruction.
+     */
+    bool
+    fits(const Block &block, const StaticInstPtr &inst, Addr paddr,
+         unsigned size) const
+    {
+        return !inst->isMacroop() && !inst->isMicroop() && !full(block) &&
+            pageOf(paddr) == pageOf(block.paddr) &&
+            pageOf(paddr + size - 1) == pageOf(block.paddr);
+    }
+
+    bool
+    full(const Block &block) const
+    {
+        return block.insts.size() >= maxInsts;
+    }
+
+    /** Whether a block cannot continue after this instruction. */
+    static bool
+    endsBlock(const StaticInstPtr &inst)
+    {
+        return inst->isControl() || inst->isSerializing() ||
+            inst->isNonSpeculative() || inst->isSyscall() ||
+            inst->isQuiesce() || inst->isInstSync();
+    }
+
+    /**
+     * Drop the blocks of the pages [paddr, paddr + size) touches.
+     *
+     * @return Whether any block was dropped.
+     */
+    bool
+    invalidate(Addr paddr, Addr size)
+    {
+        if (pages.empty())
+            return false;
+        bool dropped = invalidatePage(pageOf(paddr));
+        if (pageOf(paddr + size - 1) != pageOf(paddr))
+            dropped |= invalidatePage(pageOf(paddr + size - 1));
+        return dropped;
+    }
+
+    /** Whether a write to [paddr, paddr + size) touches the block. */
+    bool
+    touches(const Block &block, Addr paddr, Addr size) const
+    {
+        return pageOf(block.paddr) == pageOf(paddr) ||
+            pageOf(block.paddr) == pageOf(paddr + size - 1);
+    }
+
+    /** Drop all blocks. */
+    void flush();
+
+    bool empty() const { return blocks.empty(); }
+
+  private:
+    Addr pageOf(Addr paddr) const { return paddr & ~(pageBytes - 1); }
+
+    bool invalidatePage(Addr page);
+
+    const size_t maxBlocks;
+    const size_t maxInsts;
+    const Addr pageBytes;
+
+    std::unordered_map<Addr, std::unique_ptr<Block>> blocks;
+    /** Start addresses of the blocks of every page. */
+    std::unordered_map<Addr, std::vector<Addr>> pages;
+};
+
+#endif // __CPU_SIMPLE_INST_BLOCK_CACHE_HH__
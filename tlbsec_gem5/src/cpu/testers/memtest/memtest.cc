@@ -100,6 +100,7 @@ MemTest::MemTest(const Params &p)
       suppressFuncErrors(p.suppress_func_errors), stats(this)
 {
     id = TESTER_ALLOCATOR++;
+    rng.init(random_mt.random<uint32_t>());
     fatal_if(id >= blockSize, "Too many testers, only %d allowed\n",
              blockSize - 1);
 
@@ -204,16 +205,16 @@ MemTest::tick()
     assert(!retryPkt);
 
     // create a new request
-    unsigned cmd = random_mt.random(0, 100);
-    uint8_t data = random_mt.random<uint8_t>();
-    bool uncacheable = random_mt.random(0, 100) < percentUncacheable;
-    unsigned base = random_mt.random(0, 1);
+    unsigned cmd = rng.random(0, 100);
+    uint8_t data = rng.random<uint8_t>();
+    bool uncacheable = rng.random(0, 100) < percentUncacheable;
+    unsigned base = rng.random(0, 1);
     Request::Flags flags;
     Addr paddr;
 
     // generate a unique address
     do {
-        unsigned offset = random_mt.random<unsigned>(0, size - 1);
+        unsigned offset = rng.random<unsigned>(0, size - 1);
 
         // use the tester id as offset within the block for false sharing
         offset = blockAlign(offset);
@@ -227,7 +228,7 @@ MemTest::tick()
         }
     } while (outstandingAddrs.find(paddr) != outstandingAddrs.end());
 
-    bool do_functional = (random_mt.random(0, 100) < percentFunctional) &&
+    bool do_functional = (rng.random(0, 100) < percentFunctional) &&
         !uncacheable;
     RequestPtr req = std::make_shared<Request>(paddr, 1, flags, requestorId);
     req->setContext(id);
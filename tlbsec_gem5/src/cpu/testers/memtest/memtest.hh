@@ -44,6 +44,7 @@
 #include <set>
 #include <unordered_map>
 
+#include "base/random.hh"
 #include "base/statistics.hh"
 #include "mem/port.hh"
 #include "params/MemTest.hh"
@@ -130,6 +131,12 @@ class MemTest : public ClockedObject
 
     unsigned int id;
 
+    /**
+     * Random numbers of this tester, as testers may be simulated by
+     * different event queues (host threads).
+     */
+    Random rng;
+
     std::set<Addr> outstandingAddrs;
 
     // store the expected value for the addresses we have touched
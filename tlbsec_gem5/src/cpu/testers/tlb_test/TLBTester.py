@@ -0,0 +1,90 @@
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.proxy import *
+from m5.util.pybind import PyBindMethod
+
+from m5.objects.ClockedObject import ClockedObject
+from m5.objects.RiscvISA import RiscvISA
+from m5.objects.RiscvMMU import RiscvMMU
+
+class TLBTestPattern(ScopedEnum):
+    vals = ['Uniform', 'Zipf', 'Strided']
+
+class TLBTester(ClockedObject):
+    type = 'TLBTester'
+    cxx_header = "cpu/testers/tlb_test/tlb_tester.hh"
+
+    system = Param.System(Parent.any, "System this tester is part of")
+    mmu = Param.RiscvMMU(RiscvMMU(), "MMU under test")
+    isa = Param.RiscvISA(RiscvISA(), "ISA holding the translation CSRs")
+
+    # Virtual address streams
+    pattern = Param.TLBTestPattern('Uniform', "Virtual address pattern")
+    va_base = Param.Addr(0x10000000, "Start of the mapped virtual range")
+    footprint = Param.MemorySize('64MiB', "Size of the mapped virtual "
+                                 "range (a multiple of 2MiB)")
+    stride = Param.MemorySize('4KiB', "Stride of the Strided pattern")
+    zipf_exponent = Param.Float(1.0, "Exponent of the Zipf pattern")
+    asids = Param.Unsigned(1, "Address spaces mapping the virtual range "
+                           "to different frames, one is picked per access")
+    huge_percent = Param.Percent(0, "Percentage of 2MiB regions mapped "
+                                 "by a 2MiB page")
+    contiguous = Param.Bool(True, "Map the pages of a 2MiB region to "
+                            "consecutive frames rather than shuffled ones")
+
+    # Access mix and stop conditions
+    percent_writes = Param.Percent(30, "Percentage of store translations")
+    percent_fetches = Param.Percent(0, "Percentage of instruction fetch "
+                                    "translations (use the ITB)")
+    max_outstanding = Param.Unsigned(4, "Translations in flight in timing "
+                                     "mode, translations per cycle in "
+                                     "atomic mode")
+    sfence_interval = Param.Counter(0, "Translations between injected "
+                                    "sfence.vma (0: never)")
+    max_translations = Param.Counter(0, "Translations before exiting "
+                                     "(0: run until the simulation ends)")
+
+    # CPU switch
+    switch_mmu = Param.RiscvMMU(NULL, "MMU that takes over from mmu, like "
+                                "the MMU of a CPU that is switched in")
+    switch_after = Param.Counter(0, "Translations before exiting to let "
+                                 "the script call switchMmu() (0: never)")
+
+    # Physical layout
+    page_table_base = Param.Addr(0x80000000, "Start of the page tables, "
+                                 "which must be backed by memory")
+    page_table_size = Param.MemorySize('16MiB', "Memory for page tables")
+    frame_base = Param.Addr(0x100000000, "First frame the pages map to, "
+                            "frames are never accessed")
+
+    cxx_exports = [
+        PyBindMethod("switchMmu"),
+    ]
+
+    def connectWalkerPorts(self, port):
+        self.mmu.connectWalkerPorts(port, port)
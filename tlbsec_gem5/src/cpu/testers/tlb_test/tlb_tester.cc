@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/testers/tlb_test/tlb_tester.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "arch/riscv/isa.hh"
+#include "arch/riscv/mmu.hh"
+#include "arch/riscv/pagetable.hh"
+#include "base/bitfield.hh"
+#include "base/logging.hh"
+#include "base/random.hh"
+#include "base/trace.hh"
+#include "cpu/simple_thread.hh"
+#include "debug/TLBTester.hh"
+#include "sim/faults.hh"
+#include "sim/sim_exit.hh"
+#include "sim/system.hh"
+
+using namespace RiscvISA;
+
+namespace
+{
+
+const Addr HugePageShift = PageShift + LEVEL_BITS;
+const Addr HugePageBytes = ULL(1) << HugePageShift;
+const Addr GigaPageShift = PageShift + 2 * LEVEL_BITS;
+
+} // anonymous namespace
+
+void
+TLBTester::Translation::finish(const Fault &fault, const RequestPtr &req,
+                               ThreadContext *tc, BaseTLB::Mode mode)
+{
+    tester.complete(fault, req, asid, mode, issued);
+    delete this;
+}
+
+TLBTester::TLBTester(const TLBTesterParams &p)
+  : ClockedObject(p),
+    tickEvent([this]{ tick(); }, name()),
+    mmu(dynamic_cast<MMU *>(p.mmu)),
+    switchTarget(dynamic_cast<MMU *>(p.switch_mmu)), system(p.system),
+    requestorId(p.system->getRequestorId(this)),
+    pattern(p.pattern), vaBase(p.va_base), footprint(p.footprint),
+    stride(p.stride), numAsids(p.asids), hugePercent(p.huge_percent),
+    contiguous(p.contiguous), percentWrites(p.percent_writes),
+    percentFetches(p.percent_fetches), maxOutstanding(p.max_outstanding),
+    sfenceInterval(p.sfence_interval),
+    maxTranslations(p.max_translations), switchAfter(p.switch_after),
+    atomic(p.system->isAtomicMode()),
+    tableBase(p.page_table_base),
+    tableLimit(p.page_table_base + p.page_table_size),
+    nextTable(p.page_table_base),
+    nextFrame(p.frame_base), strideSeq(0), currentAsid(1), outstanding(0),
+    issued(0),
+    completed(0), nextSfence(p.sfence_interval), exited(false),
+    stats(*this)
+{
+    fatal_if(!mmu, "%s: The TLB tester needs a RISC-V MMU.\n", name());
+    fatal_if(p.switch_mmu && !switchTarget,
+             "%s: Only a RISC-V MMU can take over.\n", name());
+    fatal_if(numAsids == 0 || numAsids >= (1 << 16),
+             "%s: Between 1 and 65535 ASIDs can be tested, not %d.\n",
+             name(), numAsids);
+    fatal_if(footprint == 0 || footprint % HugePageBytes ||
+             vaBase % HugePageBytes,
+             "%s: The virtual footprint must be a non-empty range of "
+             "whole 2MiB regions.\n", name());
+    fatal_if(vaBase + footprint > (ULL(1) << (VADDR_BITS - 1)),
+             "%s: The virtual footprint must be below %#x.\n", name(),
+             ULL(1) << (VADDR_BITS - 1));
+    fatal_if(percentWrites + percentFetches > 100,
+             "%s: More than 100%% writes and fetches requested.\n", name());
+    fatal_if(maxOutstanding == 0,
+             "%s: At least one translation must be in flight.\n", name());
+
+    if (pattern == TLBTestPattern::Zipf) {
+        // P(rank k) ~ 1 / k^s for the k-th most popular page
+        const size_t pages = footprint >> PageShift;
+        zipfCdf.resize(pages);
+        double sum = 0;
+        for (size_t k = 0; k < pages; k++) {
+            sum += 1.0 / std::pow(k + 1, p.zipf_exponent);
+            zipfCdf[k] = sum;
+        }
+        for (auto &c : zipfCdf)
+            c /= sum;
+    }
+
+    // A thread context without a CPU, holding the satp, status and
+    // privilege registers the MMU reads for every translation.
+    thread.reset(new SimpleThread(nullptr, 0, system, mmu, p.isa));
+    p.isa->setThreadContext(thread.get());
+    thread->setMiscRegNoEffect(MISCREG_PRV, PRV_S);
+}
+
+TLBTester::~TLBTester()
+{
+}
+
+void
+TLBTester::init()
+{
+    ClockedObject::init();
+
+    spaces.resize(numAsids);
+    for (unsigned i = 0; i < numAsids; i++)
+        buildAddressSpace(i + 1);
+
+    inform("%s: Mapped %#x bytes for %d ASIDs in %d KiB of page tables.\n",
+           name(), footprint, numAsids,
+           (nextTable - tableBase) / 1024);
+}
+
+void
+TLBTester::startup()
+{
+    hostStart = std::chrono::steady_clock::now();
+    schedule(tickEvent, clockEdge());
+}
+
+Addr
+TLBTester::allocTable()
+{
+    fatal_if(nextTable + PageBytes > tableLimit,
+             "%s: Out of page table memory, increase page_table_size.\n",
+             name());
+    const Addr table = nextTable;
+    nextTable += PageBytes;
+    system->physProxy.memsetBlob(table, 0, PageBytes);
+    return table;
+}
+
+Addr
+TLBTester::allocFrames(unsigned log_bytes)
+{
+    nextFrame = roundUp(nextFrame, ULL(1) << log_bytes);
+    const Addr frame = nextFrame;
+    nextFrame += ULL(1) << log_bytes;
+    return frame;
+}
+
+void
+TLBTester::writePte(Addr pte_addr, Addr ppn, bool leaf)
+{
+    PTESv39 pte = 0;
+    pte.v = 1;
+    if (leaf) {
+        // Accessed and dirty, so walks never write the PTE back
+        pte.r = pte.w = pte.x = 1;
+        pte.a = pte.d = 1;
+    }
+    pte.ppn = ppn;
+    system->physProxy.write<uint64_t>(pte_addr, pte, ByteOrder::little);
+}
+
+void
+TLBTester::buildAddressSpace(uint16_t asid)
+{
+    AddressSpace &space = spaces[asid - 1];
+    space.root = allocTable();
+
+    Addr l1_table = 0;
+    for (Addr region = vaBase; region < vaBase + footprint;
+         region += HugePageBytes) {
+        const Addr l2_pte = space.root +
+            bits(region, GigaPageShift + LEVEL_BITS - 1, GigaPageShift) * 8;
+        if (region == vaBase || !bits(region, GigaPageShift - 1, 0)) {
+            l1_table = allocTable();
+            writePte(l2_pte, l1_table >> PageShift, false);
+        }
+        const Addr l1_pte = l1_table +
+            bits(region, GigaPageShift - 1, HugePageShift) * 8;
+
+        if (random_mt.random<unsigned>(0, 99) < hugePercent) {
+            const Addr frame = allocFrames(HugePageShift);
+            writePte(l1_pte, frame >> PageShift, true);
+            space.leaves[region] = {l1_pte, frame >> PageShift,
+                                    (unsigned)HugePageShift};
+            space.leafAddrs.push_back(region);
+            continue;
+        }
+
+        const Addr l0_table = allocTable();
+        writePte(l1_pte, l0_table >> PageShift, false);
+
+        // The frames of the region in page order, unless shuffled
+        const Addr frames = allocFrames(HugePageShift);
+        std::vector<Addr> order(1 << LEVEL_BITS);
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        if (!contiguous) {
+            for (size_t i = order.size() - 1; i > 0; i--)
+                std::swap(order[i], order[random_mt.random<size_t>(0, i)]);
+        }
+
+        for (size_t i = 0; i < order.size(); i++) {
+            const Addr vaddr = region + (i << PageShift);
+            const Addr pte_addr = l0_table + i * 8;
+            const Addr ppn = (frames >> PageShift) + order[i];
+            writePte(pte_addr, ppn, true);
+            space.leaves[vaddr] = {pte_addr, ppn, (unsigned)PageShift};
+            space.leafAddrs.push_back(vaddr);
+        }
+    }
+}
+
+const TLBTester::Mapping &
+TLBTester::mappingOf(uint16_t asid, Addr vaddr) const
+{
+    const AddressSpace &space = spaces[asid - 1];
+    auto it = space.leaves.find(vaddr & ~mask(PageShift));
+    if (it == space.leaves.end())
+        it = space.leaves.find(vaddr & ~mask(HugePageShift));
+    assert(it != space.leaves.end());
+    return it->second;
+}
+
+Addr
+TLBTester::nextVaddr()
+{
+    const size_t pages = footprint >> PageShift;
+    size_t page = 0;
+    switch (pattern) {
+      case TLBTestPattern::Uniform:
+        page = random_mt.random<size_t>(0, pages - 1);
+        break;
+      case TLBTestPattern::Zipf:
+        page = std::lower_bound(zipfCdf.begin(), zipfCdf.end(),
+                                random_mt.random<double>()) -
+               zipfCdf.begin();
+        page = std::min(page, pages - 1);
+        break;
+      case TLBTestPattern::Strided:
+        return vaBase + (strideSeq++ * stride) % footprint;
+      default:
+        panic("%s: Unknown address pattern.\n", name());
+    }
+    // Any naturally aligned doubleword within the page
+    return vaBase + (page << PageShift) +
+        (random_mt.random<Addr>(0, PageBytes - 1) & ~Addr(7));
+}
+
+void
+TLBTester::setAddressSpace(uint16_t asid)
+{
+    SATP satp = 0;
+    satp.mode = AddrXlateMode::SV39;
+    satp.asid = asid;
+    satp.ppn = spaces[asid - 1].root >> PageShift;
+    thread->setMiscRegNoEffect(MISCREG_SATP, satp);
+}
+
+void
+TLBTester::issue()
+{
+    // Like a core, only switch address spaces when no translation is
+    // in flight, as delayed TLB lookups read satp when they happen.
+    if (!outstanding) {
+        currentAsid = random_mt.random<unsigned>(1, numAsids);
+        setAddressSpace(currentAsid);
+    }
+    const uint16_t asid = currentAsid;
+    const Addr vaddr = nextVaddr();
+    const unsigned kind = random_mt.random<unsigned>(0, 99);
+    BaseTLB::Mode mode = BaseTLB::Read;
+    Request::Flags flags = 0;
+    if (kind < percentFetches) {
+        mode = BaseTLB::Execute;
+        flags = Request::INST_FETCH;
+    } else if (kind < percentFetches + percentWrites) {
+        mode = BaseTLB::Write;
+    }
+
+    RequestPtr req = std::make_shared<Request>(
+        vaddr, 8, flags, requestorId, 0, 0);
+
+    DPRINTF(TLBTester, "Translating %#x (asid %d, mode %d)\n",
+            vaddr, asid, mode);
+    issued++;
+    outstanding++;
+    if (atomic) {
+        Fault fault = mmu->translateAtomic(req, thread.get(), mode);
+        complete(fault, req, asid, mode, curTick());
+    } else {
+        mmu->translateTiming(req, thread.get(),
+                             new Translation(*this, asid), mode);
+    }
+}
+
+void
+TLBTester::complete(const Fault &fault, const RequestPtr &req,
+                    uint16_t asid, BaseTLB::Mode mode, Tick issued_tick)
+{
+    assert(outstanding);
+    outstanding--;
+    completed++;
+    stats.translations++;
+    stats.latency.sample(curTick() - issued_tick);
+
+    const Addr vaddr = req->getVaddr();
+    if (fault != NoFault) {
+        panic("%s: Translation of %#x (asid %d, mode %d) faulted: %s\n",
+              name(), vaddr, asid, mode, fault->name());
+    }
+
+    // Mappings only change while no translation is in flight, so the
+    // golden map still holds the mapping the translation started with.
+    const Mapping &m = mappingOf(asid, vaddr);
+    const Addr expected = (m.ppn << PageShift) | (vaddr & mask(m.logBytes));
+    if (req->getPaddr() != expected) {
+        panic("%s: %#x (asid %d) translated to %#x, expected %#x\n",
+              name(), vaddr, asid, req->getPaddr(), expected);
+    }
+
+    if (switchAfter && completed == switchAfter && !exited)
+        exitSimLoop("switching the MMU of the TLB tester");
+
+    if (maxTranslations && completed >= maxTranslations && !exited) {
+        exited = true;
+        exitSimLoop("maximum number of TLB translations reached");
+    }
+}
+
+void
+TLBTester::switchMmu()
+{
+    fatal_if(!switchTarget, "%s: There is no MMU to switch to.\n", name());
+    fatal_if(outstanding, "%s: Cannot switch MMUs with %d translations in "
+             "flight.\n", name(), outstanding);
+
+    // The entries, ids and rerandomizations of both TLBs
+    auto tlb_state = [this](MMU *m) {
+        std::vector<uint64_t> state;
+        for (auto *tlb : {m->itb, m->dtb}) {
+            auto *cache = static_cast<TLB *>(tlb)->getTlbCache();
+            state.push_back(cache->validEntries());
+            state.push_back(cache->getRerandRequestCount());
+            for (unsigned asid = 1; asid <= numAsids; asid++)
+                state.push_back(cache->randomId(asid));
+        }
+        return state;
+    };
+
+    const std::vector<uint64_t> before = tlb_state(mmu);
+    panic_if(!static_cast<TLB *>(mmu->dtb)->getTlbCache()->validEntries(),
+             "%s: The DTB is empty, there is nothing to take over.\n",
+             name());
+
+    mmu->switchOut();
+    switchTarget->takeOverFrom(mmu);
+    panic_if(tlb_state(switchTarget) != before,
+             "%s: The TLB entries or random ids of %s changed when %s took "
+             "over from it.\n", name(), mmu->name(), switchTarget->name());
+
+    inform("%s: %s took over the TLBs of %s.\n", name(),
+           switchTarget->name(), mmu->name());
+    mmu = switchTarget;
+    switchTarget = nullptr;
+    thread->mmu = mmu;
+    atomic = system->isAtomicMode();
+}
+
+void
+TLBTester::injectSfence()
+{
+    const uint16_t asid = random_mt.random<unsigned>(1, numAsids);
+    stats.sfences++;
+
+    switch (random_mt.random<unsigned>(0, 2)) {
+      case 0:
+        {
+            // Move a page to a new frame, which the TLB must not keep
+            // translating to the old one after the fence.
+            AddressSpace &space = spaces[asid - 1];
+            const Addr vaddr = space.leafAddrs[random_mt.random<size_t>(
+                0, space.leafAddrs.size() - 1)];
+            Mapping &m = space.leaves[vaddr];
+            m.ppn = allocFrames(m.logBytes) >> PageShift;
+            writePte(m.pteAddr, m.ppn, true);
+            stats.remaps++;
+            DPRINTF(TLBTester, "sfence.vma %#x, %d after remapping it to "
+                    "%#x\n", vaddr, asid, m.ppn << PageShift);
+            mmu->demap(vaddr, asid);
+        }
+        break;
+      case 1:
+        DPRINTF(TLBTester, "sfence.vma zero, %d\n", asid);
+        mmu->demap(0, asid);
+        break;
+      default:
+        DPRINTF(TLBTester, "sfence.vma\n");
+        mmu->demap(0, 0);
+        break;
+    }
+}
+
+void
+TLBTester::tick()
+{
+    if (exited)
+        return;
+
+    for (unsigned i = 0; i < maxOutstanding && !exited; i++) {
+        if (sfenceInterval && issued >= nextSfence) {
+            // Fence once the translations that may use the old mappings
+            // have finished
+            if (outstanding)
+                break;
+            injectSfence();
+            nextSfence += sfenceInterval;
+        }
+        if (outstanding >= maxOutstanding ||
+            (maxTranslations && issued >= maxTranslations)) {
+            break;
+        }
+        issue();
+    }
+
+    schedule(tickEvent, clockEdge(Cycles(1)));
+}
+
+TLBTester::TLBTesterStats::TLBTesterStats(TLBTester &tester)
+  : Stats::Group(&tester),
+    ADD_STAT(translations, UNIT_COUNT, "Translations checked"),
+    ADD_STAT(sfences, UNIT_COUNT, "sfence.vma instructions injected"),
+    ADD_STAT(remaps, UNIT_COUNT, "Pages remapped before a fence"),
+    ADD_STAT(latency, UNIT_TICK, "Translation latency"),
+    ADD_STAT(hostLookupRate,
+             UNIT_RATE(Stats::Units::Count, Stats::Units::Second),
+             "Translations per host second since startup")
+{
+    latency.init(16);
+    hostLookupRate
+        .functor([&tester] {
+            const std::chrono::duration<double> host_time =
+                std::chrono::steady_clock::now() - tester.hostStart;
+            return host_time.count() > 0 ?
+                tester.completed / host_time.count() : 0;
+        })
+        .precision(0);
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_TESTERS_TLB_TEST_TLB_TESTER_HH__
+#define __CPU_TESTERS_TLB_TEST_TLB_TESTER_HH__
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "arch/generic/tlb.hh"
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "enums/TLBTestPattern.hh"
+#include "params/TLBTester.hh"
+#include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
+
+class SimpleThread;
+class System;
+
+namespace RiscvISA
+{
+    class MMU;
+}
+
+/**
+ * The TLBTester drives a RISC-V MMU, its TLBs and page table walkers
+ * with virtual addresses, without a CPU or a guest.
+ *
+ * At init it builds an Sv39 page table per ASID in simulated memory,
+ * mapping the same virtual footprint to distinct frames, with a share of
+ * 2MiB pages. Every cycle it translates addresses drawn from a uniform,
+ * Zipfian or strided stream and checks the physical address against the
+ * golden map the page tables were built from. Like a core, it switches
+ * to a random ASID only when no translation is in flight. It
+ * periodically injects sfence.vma: after the outstanding translations
+ * have drained it remaps a page and demaps it, or drops an ASID or the
+ * whole TLB, so stale entries show up as mismatches.
+ *
+ * The translation rate in lookups per host second is reported as a
+ * statistic, so the tester doubles as a benchmark for TLB changes.
+ */
+class TLBTester : public ClockedObject
+{
+  public:
+    TLBTester(const TLBTesterParams &p);
+    ~TLBTester();
+
+    void init() override;
+    void startup() override;
+
+    /**
+     * Switch out mmu and let switch_mmu take over from it, as when
+     * switching CPUs, then continue translating with switch_mmu in the
+     * current memory mode. Panics unless the TLB entries, random ids and
+     * rerandomization counts survive the switch.
+     */
+    void switchMmu();
+
+  protected:
+    /** A timing translation in flight, deleted when it finishes. */
+    class Translation : public BaseTLB::Translation
+    {
+      public:
+        Translation(TLBTester &_tester, uint16_t _asid)
+          : tester(_tester), asid(_asid), issued(curTick())
+        {}
+
+        void markDelayed() override {}
+        void finish(const Fault &fault, const RequestPtr &req,
+                    ThreadContext *tc, BaseTLB::Mode mode) override;
+
+      private:
+        TLBTester &tester;
+        const uint16_t asid;
+        const Tick issued;
+    };
+
+    /** A leaf of the synthetic page tables. */
+    struct Mapping
+    {
+        Addr pteAddr;
+        Addr ppn;
+        unsigned logBytes;
+    };
+
+    /** Page table and golden map of an ASID. */
+    struct AddressSpace
+    {
+        Addr root;
+        std::unordered_map<Addr, Mapping> leaves;
+        // Virtual addresses of the leaves, to pick pages to remap
+        std::vector<Addr> leafAddrs;
+    };
+
+    void tick();
+    EventFunctionWrapper tickEvent;
+
+    /** Build the page table of asid in simulated memory. */
+    void buildAddressSpace(uint16_t asid);
+    Addr allocTable();
+    Addr allocFrames(unsigned log_bytes);
+    void writePte(Addr pte_addr, Addr ppn, bool leaf);
+    const Mapping &mappingOf(uint16_t asid, Addr vaddr) const;
+
+    Addr nextVaddr();
+    void setAddressSpace(uint16_t asid);
+    void issue();
+    void complete(const Fault &fault, const RequestPtr &req, uint16_t asid,
+                  BaseTLB::Mode mode, Tick issued);
+    void injectSfence();
+
+    RiscvISA::MMU *mmu;
+    RiscvISA::MMU *switchTarget;
+    System *system;
+    std::unique_ptr<SimpleThread> thread;
+    RequestorID requestorId;
+
+    const TLBTestPattern pattern;
+    const Addr vaBase;
+    const Addr footprint;
+    const Addr stride;
+    const unsigned numAsids;
+    const unsigned hugePercent;
+    const bool contiguous;
+    const unsigned percentWrites;
+    const unsigned percentFetches;
+    const unsigned maxOutstanding;
+    const Counter sfenceInterval;
+    const Counter maxTranslations;
+    const Counter switchAfter;
+    bool atomic;
+
+    // Bump allocators for page tables (in memory) and frames
+    const Addr tableBase;
+    const Addr tableLimit;
+    Addr nextTable;
+    Addr nextFrame;
+
+    std::vector<AddressSpace> spaces;
+    // Cumulative distribution of the Zipfian page ranks
+    std::vector<double> zipfCdf;
+    uint64_t strideSeq;
+
+    uint16_t currentAsid;
+    unsigned outstanding;
+    Counter issued;
+    Counter completed;
+    Counter nextSfence;
+    bool exited;
+
+    std::chrono::steady_clock::time_point hostStart;
+
+    struct TLBTesterStats : public Stats::Group
+    {
+        TLBTesterStats(TLBTester &tester);
+
+        Stats::Scalar translations;
+        Stats::Scalar sfences;
+        Stats::Scalar remaps;
+        Stats::Histogram latency;
+        Stats::Value hostLookupRate;
+    } stats;
+};
+
+#endif // __CPU_TESTERS_TLB_TEST_TLB_TESTER_HH__
@@ -37,6 +37,7 @@
 
 #include "dev/riscv/clint.hh"
 
+#include "cpu/base.hh"
 #include "debug/Clint.hh"
 #include "mem/packet.hh"
 #include "mem/packet_access.hh"
@@ -63,10 +64,13 @@ Clint::raiseInterruptPin(int id)
 
     for (int context_id = 0; context_id < nThread; context_id++) {
 
-        // Update misc reg file
-        ISA* isa = dynamic_cast<ISA*>(
-            system->threads[context_id]->getIsaPtr());
-        isa->setMiscRegNoEffect(MISCREG_TIME, mtime);
+        // Update misc reg file. The hart may be simulated by another
+        // event queue, which receives the time like an interrupt.
+        auto *tc = system->threads[context_id];
+        tc->getCpuPtr()->mailbox().post([tc, time = mtime]{
+            ISA* isa = dynamic_cast<ISA*>(tc->getIsaPtr());
+            isa->setMiscRegNoEffect(MISCREG_TIME, time);
+        });
 
         // Post timer interrupt
         uint64_t mtimecmp = registers.mtimecmp[context_id].get();
@@ -126,6 +130,10 @@ Clint::readMSIP(Register32& reg, const int thread_id)
 {
     // To avoid discrepancies if mip is externally set using remote_gdb etc.
     auto tc = system->threads[thread_id];
+    // A hart simulated by another event queue can't be read from here,
+    // the register holds what was last written to it
+    if (inParallelMode && tc->getCpuPtr()->eventQueue() != curEventQueue())
+        return reg.get();
     RegVal mip = tc->readMiscReg(MISCREG_IP);
     uint32_t msip = bits<uint32_t>(mip, ExceptionCode::INT_SOFTWARE_MACHINE);
     reg.update(msip);
@@ -148,6 +156,8 @@ Clint::writeMSIP(Register32& reg, const uint32_t& data, const int thread_id)
         intrctrl->clear(thread_id,
             ExceptionCode::INT_SOFTWARE_MACHINE, 0);
     }
+    if (ppIpi)
+        ppIpi->notify({thread_id, data > 0});
 };
 
 Tick
@@ -194,6 +204,12 @@ Clint::init()
     BasicPioDevice::init();
 }
 
+void
+Clint::regProbePoints()
+{
+    ppIpi.reset(new ProbePoints::Ipi(getProbeManager(), "Ipi"));
+}
+
 Port &
 Clint::getPort(const std::string &if_name, PortID idx)
 {
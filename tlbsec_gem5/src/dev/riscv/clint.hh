@@ -48,6 +48,7 @@
 #include "mem/packet.hh"
 #include "mem/packet_access.hh"
 #include "params/Clint.hh"
+#include "sim/probe/ipi.hh"
 #include "sim/system.hh"
 
 using namespace RiscvISA;
@@ -75,6 +76,9 @@ class Clint : public BasicPioDevice
     int nThread;
     IntSinkPin<Clint> signal;
 
+    /** Probe point notified for every write to an msip register. */
+    ProbePoints::IpiUPtr ppIpi;
+
   public:
     typedef ClintParams Params;
     Clint(const Params &params);
@@ -139,6 +143,7 @@ class Clint : public BasicPioDevice
      * SimObject functions
      */
     void init() override;
+    void regProbePoints() override;
     Port & getPort(const std::string &if_name,
                    PortID idx=InvalidPortID) override;
     void serialize(CheckpointOut &cp) const override;
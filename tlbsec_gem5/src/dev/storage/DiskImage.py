@@ -44,3 +44,12 @@ class CowDiskImage(DiskImage):
                             "child image")
     table_size = Param.Int(65536, "initial table size")
     image_file = ""
+
+class MmapCowDiskImage(DiskImage):
+    type = 'MmapCowDiskImage'
+    cxx_header = "dev/storage/disk_image.hh"
+    base_file = Param.String("raw base image, mapped read only and shared "
+                             "with all other simulators using it")
+    image_file = Param.String("", "file with the written sectors, loaded at "
+                              "startup and saved at exit (unless read_only),"
+                              " empty to discard writes at exit")
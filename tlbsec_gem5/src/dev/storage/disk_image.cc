@@ -32,6 +32,9 @@
 
 #include "dev/storage/disk_image.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/uio.h>
 #include <unistd.h>
@@ -204,7 +207,7 @@ CowDiskImage::notifyFork()
 }
 
 void
-SafeRead(std::ifstream &stream, void *data, int count)
+SafeRead(std::ifstream &stream, void *data, std::streamsize count)
 {
     stream.read((char *)data, count);
     if (!stream.is_open())
@@ -287,7 +290,7 @@ CowDiskImage::initSectorTable(int hash_size)
 }
 
 void
-SafeWrite(std::ofstream &stream, const void *data, int count)
+SafeWrite(std::ofstream &stream, const void *data, std::streamsize count)
 {
     stream.write((const char *)data, count);
     if (!stream.is_open())
@@ -434,3 +437,231 @@ CowDiskImage::unserialize(CheckpointIn &cp)
     cowFilename = cp.getCptDir() + "/" + cowFilename;
     open(cowFilename);
 }
+
+////////////////////////////////////////////////////////////////////////
+//
+// Memory mapped copy on write disk image
+//
+const uint32_t MmapCowDiskImage::VersionMajor = 1;
+const uint32_t MmapCowDiskImage::VersionMinor = 0;
+
+MmapCowDiskImage::MmapCowDiskImage(const Params &p)
+    : DiskImage(p), filename(p.image_file), baseFile(p.base_file),
+      numSectors(0), mapSize(0), base(nullptr), overlay(nullptr)
+{
+    mapBase(baseFile);
+
+    // Only the written parts of the overlay are ever backed by memory
+    overlay = (uint8_t *)mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                              -1, 0);
+    if (overlay == (uint8_t *)MAP_FAILED)
+        fatal("Could not mmap %d bytes for the overlay of %s: %s\n",
+              mapSize, baseFile, strerror(errno));
+
+    dirty.assign((numSectors + 63) / 64, 0);
+    initialized = true;
+
+    if (!filename.empty()) {
+        if (!open(filename) && p.read_only)
+            fatal("could not open read-only file");
+
+        if (!p.read_only)
+            registerExitCallback([this]() { save(); });
+    }
+}
+
+MmapCowDiskImage::~MmapCowDiskImage()
+{
+    if (overlay)
+        munmap(overlay, mapSize);
+    if (base)
+        munmap(const_cast<uint8_t *>(base), mapSize);
+}
+
+void
+MmapCowDiskImage::mapBase(const std::string &file)
+{
+    int fd = ::open(file.c_str(), O_RDONLY);
+    if (fd < 0)
+        panic("Error opening %s: %s", file, strerror(errno));
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0)
+        panic("Could not stat %s: %s", file, strerror(errno));
+
+    numSectors = sb.st_size / SectorSize;
+    mapSize = numSectors * SectorSize;
+    fatal_if(numSectors == 0, "Disk image %s is empty.\n", file);
+
+    // A shared read-only mapping lets all simulators of the same image
+    // use the same page cache pages
+    base = (const uint8_t *)mmap(NULL, mapSize, PROT_READ, MAP_SHARED,
+                                 fd, 0);
+    ::close(fd);
+    if (base == (const uint8_t *)MAP_FAILED)
+        panic("Could not mmap %s: %s", file, strerror(errno));
+}
+
+void
+MmapCowDiskImage::notifyFork()
+{
+    if (!dynamic_cast<const Params &>(params()).read_only &&
+        !filename.empty()) {
+        inform("Disabling saving of COW overlay in forked child process.\n");
+        filename = "";
+    }
+}
+
+bool
+MmapCowDiskImage::open(const std::string &file)
+{
+    std::ifstream stream(file.c_str());
+    if (!stream.is_open())
+        return false;
+
+    uint64_t magic;
+    SafeRead(stream, magic);
+
+    if (memcmp(&magic, "MMAPCOW!", sizeof(magic)) != 0)
+        panic("Could not open %s: Invalid magic", file);
+
+    uint32_t major, minor;
+    SafeReadSwap(stream, major);
+    SafeReadSwap(stream, minor);
+
+    if (major != VersionMajor)
+        panic("Could not open %s: invalid version %d.%d != %d.%d",
+              file, major, minor, VersionMajor, VersionMinor);
+
+    uint64_t sector_count, extent_count;
+    SafeReadSwap(stream, sector_count);
+    SafeReadSwap(stream, extent_count);
+    if (sector_count != numSectors)
+        panic("Could not open %s: it has %d sectors, but %s has %d",
+              file, sector_count, baseFile, numSectors);
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+    for (uint64_t i = 0; i < extent_count; i++) {
+        uint64_t start, count;
+        SafeReadSwap(stream, start);
+        SafeReadSwap(stream, count);
+        if (start + count > numSectors || start + count < start)
+            panic("Could not open %s: extent %d is out of bounds", file, i);
+
+        SafeRead(stream, overlay + start * SectorSize, count * SectorSize);
+        for (uint64_t s = start; s < start + count; s++)
+            markDirty(s);
+    }
+
+    stream.close();
+    return true;
+}
+
+void
+MmapCowDiskImage::save() const
+{
+    // See CowDiskImage::save(), the filename is cleared in forked
+    // children
+    if (!filename.empty())
+        save(filename);
+}
+
+void
+MmapCowDiskImage::save(const std::string &file) const
+{
+    std::ofstream stream(file.c_str());
+    if (!stream.is_open() || stream.fail() || stream.bad())
+        panic("Error opening %s", file);
+
+    // Collect the runs of consecutive dirty sectors
+    std::vector<std::pair<uint64_t, uint64_t>> extents;
+    for (uint64_t s = 0; s < numSectors; ) {
+        if (!dirty[s / 64]) {
+            s = (s / 64 + 1) * 64;
+            continue;
+        }
+        if (!isDirty(s)) {
+            s++;
+            continue;
+        }
+        uint64_t start = s;
+        while (s < numSectors && isDirty(s))
+            s++;
+        extents.emplace_back(start, s - start);
+    }
+
+    uint64_t magic;
+    memcpy(&magic, "MMAPCOW!", sizeof(magic));
+    SafeWrite(stream, magic);
+
+    SafeWriteSwap(stream, (uint32_t)VersionMajor);
+    SafeWriteSwap(stream, (uint32_t)VersionMinor);
+    SafeWriteSwap(stream, numSectors);
+    SafeWriteSwap(stream, (uint64_t)extents.size());
+
+    for (const auto &extent : extents) {
+        SafeWriteSwap(stream, extent.first);
+        SafeWriteSwap(stream, extent.second);
+        SafeWrite(stream, overlay + extent.first * SectorSize,
+                  extent.second * SectorSize);
+    }
+
+    stream.close();
+}
+
+std::streampos
+MmapCowDiskImage::size() const
+{
+    return numSectors;
+}
+
+std::streampos
+MmapCowDiskImage::read(uint8_t *data, std::streampos offset) const
+{
+    uint64_t sector = offset;
+    if (sector >= numSectors)
+        panic("access out of bounds");
+
+    const uint8_t *src = isDirty(sector) ? overlay : base;
+    memcpy(data, src + sector * SectorSize, SectorSize);
+
+    DPRINTF(DiskImageRead, "read: offset=%d\n", sector);
+    DDUMP(DiskImageRead, data, SectorSize);
+
+    return SectorSize;
+}
+
+std::streampos
+MmapCowDiskImage::write(const uint8_t *data, std::streampos offset)
+{
+    uint64_t sector = offset;
+    if (sector >= numSectors)
+        panic("access out of bounds");
+
+    memcpy(overlay + sector * SectorSize, data, SectorSize);
+    markDirty(sector);
+
+    DPRINTF(DiskImageWrite, "write: offset=%d\n", sector);
+    DDUMP(DiskImageWrite, data, SectorSize);
+
+    return SectorSize;
+}
+
+void
+MmapCowDiskImage::serialize(CheckpointOut &cp) const
+{
+    std::string cowFilename = name() + ".mcow";
+    SERIALIZE_SCALAR(cowFilename);
+    save(CheckpointIn::dir() + "/" + cowFilename);
+}
+
+void
+MmapCowDiskImage::unserialize(CheckpointIn &cp)
+{
+    std::string cowFilename;
+    UNSERIALIZE_SCALAR(cowFilename);
+    cowFilename = cp.getCptDir() + "/" + cowFilename;
+    if (!open(cowFilename))
+        fatal("Could not open COW overlay %s\n", cowFilename);
+}
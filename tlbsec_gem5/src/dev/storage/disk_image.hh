@@ -35,9 +35,11 @@
 
 #include <fstream>
 #include <unordered_map>
+#include <vector>
 
 #include "params/CowDiskImage.hh"
 #include "params/DiskImage.hh"
+#include "params/MmapCowDiskImage.hh"
 #include "params/RawDiskImage.hh"
 #include "sim/sim_object.hh"
 
@@ -140,7 +142,76 @@ class CowDiskImage : public DiskImage
     std::streampos write(const uint8_t *data, std::streampos offset) override;
 };
 
-void SafeRead(std::ifstream &stream, void *data, int count);
+/**
+ * Copy-on-write image that maps the base image read-only instead of
+ * reading it through a stream. The mapping is shared with every other
+ * simulator using the same image, so starting a run costs no I/O and
+ * no memory until sectors are actually read.
+ *
+ * Written sectors go to an anonymous overlay mapping of the same size
+ * that is only backed by memory where it has been written to, and a
+ * bitmap records which sectors live in the overlay. A forked simulator
+ * gets a private copy of the overlay from the kernel for free.
+ *
+ * The overlay file (image_file) holds the dirty extents only. It is
+ * loaded at startup, written at exit unless the image is read only, and
+ * checkpoints use the same format.
+ */
+class MmapCowDiskImage : public DiskImage
+{
+  public:
+    static const uint32_t VersionMajor;
+    static const uint32_t VersionMinor;
+
+  protected:
+    std::string filename;
+    std::string baseFile;
+
+    /** Number of sectors of the base image. */
+    uint64_t numSectors;
+    uint64_t mapSize;
+
+    const uint8_t *base;
+    uint8_t *overlay;
+
+    /** One bit per sector, set if the sector lives in the overlay. */
+    std::vector<uint64_t> dirty;
+
+    bool
+    isDirty(uint64_t sector) const
+    {
+        return dirty[sector / 64] & (1ULL << (sector % 64));
+    }
+
+    void
+    markDirty(uint64_t sector)
+    {
+        dirty[sector / 64] |= 1ULL << (sector % 64);
+    }
+
+    void mapBase(const std::string &file);
+
+  public:
+    typedef MmapCowDiskImageParams Params;
+    MmapCowDiskImage(const Params &p);
+    ~MmapCowDiskImage();
+
+    void notifyFork() override;
+
+    bool open(const std::string &file);
+    void save() const;
+    void save(const std::string &file) const;
+
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
+    std::streampos size() const override;
+
+    std::streampos read(uint8_t *data, std::streampos offset) const override;
+    std::streampos write(const uint8_t *data, std::streampos offset) override;
+};
+
+void SafeRead(std::ifstream &stream, void *data, std::streamsize count);
 
 template<class T>
 void SafeRead(std::ifstream &stream, T &data);
@@ -148,7 +219,7 @@ void SafeRead(std::ifstream &stream, T &data);
 template<class T>
 void SafeReadSwap(std::ifstream &stream, T &data);
 
-void SafeWrite(std::ofstream &stream, const void *data, int count);
+void SafeWrite(std::ofstream &stream, const void *data, std::streamsize count);
 
 template<class T>
 void SafeWrite(std::ofstream &stream, const T &data);
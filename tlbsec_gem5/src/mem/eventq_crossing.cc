@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/eventq_crossing.hh"
+
+#include "base/logging.hh"
+
+EventqCrossing::EventqCrossing(const Params &p)
+    : SimObject(p),
+      memSideQueue(getEventQueue(p.mem_side_eventq_index)),
+      memSidePort(name() + ".mem_side_port", *this),
+      cpuSidePort(name() + ".cpu_side_port", *this),
+      toCpuSide(eventQueue(), name() + ".to_cpu_side"),
+      toMemSide(memSideQueue, name() + ".to_mem_side"),
+      waitingForReqRetry(false), waitingForRespRetry(false),
+      waitingForSnoopRespRetry(false)
+{
+}
+
+void
+EventqCrossing::init()
+{
+    if (!cpuSidePort.isConnected() || !memSidePort.isConnected())
+        fatal("%s is not connected on both sides.\n", name());
+}
+
+Port &
+EventqCrossing::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "mem_side_port") {
+        return memSidePort;
+    } else if (if_name == "cpu_side_port") {
+        return cpuSidePort;
+    } else {
+        return SimObject::getPort(if_name, idx);
+    }
+}
+
+void
+EventqCrossing::sendRequests()
+{
+    while (!requests.empty() && !waitingForReqRetry) {
+        if (memSidePort.sendTimingReq(requests.front()))
+            requests.pop_front();
+        else
+            waitingForReqRetry = true;
+    }
+}
+
+void
+EventqCrossing::sendResponses()
+{
+    while (!responses.empty() && !waitingForRespRetry) {
+        if (cpuSidePort.sendTimingResp(responses.front()))
+            responses.pop_front();
+        else
+            waitingForRespRetry = true;
+    }
+}
+
+void
+EventqCrossing::sendSnoopResponses()
+{
+    while (!snoopResponses.empty() && !waitingForSnoopRespRetry) {
+        if (memSidePort.sendTimingSnoopResp(snoopResponses.front()))
+            snoopResponses.pop_front();
+        else
+            waitingForSnoopRespRetry = true;
+    }
+}
+
+// Calls from the memory side
+
+void
+EventqCrossing::CrossingRequestPort::recvFunctionalSnoop(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(xing.eventQueue(), inParallelMode);
+    xing.cpuSidePort.sendFunctionalSnoop(pkt);
+}
+
+Tick
+EventqCrossing::CrossingRequestPort::recvAtomicSnoop(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(xing.eventQueue(), inParallelMode);
+    return xing.cpuSidePort.sendAtomicSnoop(pkt);
+}
+
+bool
+EventqCrossing::CrossingRequestPort::recvTimingResp(PacketPtr pkt)
+{
+    if (!inParallelMode)
+        return xing.cpuSidePort.sendTimingResp(pkt);
+    xing.toCpuSide.post([this, pkt]{
+        xing.responses.push_back(pkt);
+        xing.sendResponses();
+    });
+    return true;
+}
+
+void
+EventqCrossing::CrossingRequestPort::recvTimingSnoopReq(PacketPtr pkt)
+{
+    // The caches have to decide whether they respond before the snoop
+    // returns, their responses cross later
+    EventQueue::ScopedMigration migrate(xing.eventQueue(), inParallelMode);
+    xing.cpuSidePort.sendTimingSnoopReq(pkt);
+}
+
+void
+EventqCrossing::CrossingRequestPort::recvRangeChange()
+{
+    xing.cpuSidePort.sendRangeChange();
+}
+
+bool
+EventqCrossing::CrossingRequestPort::isSnooping() const
+{
+    return xing.cpuSidePort.isSnooping();
+}
+
+void
+EventqCrossing::CrossingRequestPort::recvReqRetry()
+{
+    if (!inParallelMode) {
+        xing.cpuSidePort.sendRetryReq();
+        return;
+    }
+    xing.waitingForReqRetry = false;
+    xing.sendRequests();
+}
+
+void
+EventqCrossing::CrossingRequestPort::recvRetrySnoopResp()
+{
+    if (!inParallelMode) {
+        xing.cpuSidePort.sendRetrySnoopResp();
+        return;
+    }
+    xing.waitingForSnoopRespRetry = false;
+    xing.sendSnoopResponses();
+}
+
+// Calls from the CPU side
+
+void
+EventqCrossing::CrossingResponsePort::recvFunctional(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(xing.memSideQueue, inParallelMode);
+    xing.memSidePort.sendFunctional(pkt);
+}
+
+Tick
+EventqCrossing::CrossingResponsePort::recvAtomic(PacketPtr pkt)
+{
+    EventQueue::ScopedMigration migrate(xing.memSideQueue, inParallelMode);
+    return xing.memSidePort.sendAtomic(pkt);
+}
+
+bool
+EventqCrossing::CrossingResponsePort::recvTimingReq(PacketPtr pkt)
+{
+    if (!inParallelMode)
+        return xing.memSidePort.sendTimingReq(pkt);
+    xing.toMemSide.post([this, pkt]{
+        xing.requests.push_back(pkt);
+        xing.sendRequests();
+    });
+    return true;
+}
+
+bool
+EventqCrossing::CrossingResponsePort::recvTimingSnoopResp(PacketPtr pkt)
+{
+    if (!inParallelMode)
+        return xing.memSidePort.sendTimingSnoopResp(pkt);
+    xing.toMemSide.post([this, pkt]{
+        xing.snoopResponses.push_back(pkt);
+        xing.sendSnoopResponses();
+    });
+    return true;
+}
+
+AddrRangeList
+EventqCrossing::CrossingResponsePort::getAddrRanges() const
+{
+    return xing.memSidePort.getAddrRanges();
+}
+
+void
+EventqCrossing::CrossingResponsePort::recvRespRetry()
+{
+    if (!inParallelMode) {
+        xing.memSidePort.sendRetryResp();
+        return;
+    }
+    xing.waitingForRespRetry = false;
+    xing.sendResponses();
+}
+
+bool
+EventqCrossing::CrossingResponsePort::tryTiming(PacketPtr pkt)
+{
+    return inParallelMode || xing.memSidePort.tryTiming(pkt);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_EVENTQ_CROSSING_HH__
+#define __MEM_EVENTQ_CROSSING_HH__
+
+#include <deque>
+
+#include "mem/port.hh"
+#include "params/EventqCrossing.hh"
+#include "sim/eventq_mailbox.hh"
+#include "sim/sim_object.hh"
+
+/**
+ * A transparent link between a CPU with its private caches and the
+ * shared memory system behind them (the L2 bus or the membus) when the
+ * two are simulated by different event queues (i.e., host threads).
+ *
+ * In parallel simulation, timing requests and responses are handed over
+ * to the other queue through an EventqMailbox and arrive one simulation
+ * quantum after they were sent, so only misses of the private caches
+ * pay for the crossing. The link always accepts packets and keeps those
+ * refused by the receiver until it retries. Snoop responses of the
+ * caches cross the same way.
+ *
+ * Snoops have to be answered while the sender waits, so they enter the
+ * queue of the CPU side, and functional and atomic requests of the CPU
+ * side enter the queue of the memory side (see
+ * EventQueue::ScopedMigration). Either happens between the events of
+ * the entered queue, and a migration releases the queue it leaves, so
+ * the two sides can never wait for each other. A snoop may still enter
+ * a CPU whose event is suspended in a functional access of the memory
+ * side; that access has already passed the caches, so they see the
+ * snoop as if it came after it.
+ *
+ * The CPU side belongs to the event queue of this object, the memory
+ * side to mem_side_eventq_index. Outside of parallel simulation the
+ * link does nothing but forward.
+ */
+class EventqCrossing : public SimObject
+{
+  public:
+    typedef EventqCrossingParams Params;
+    EventqCrossing(const Params &p);
+
+    void init() override;
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+  private:
+    class CrossingRequestPort : public RequestPort
+    {
+      public:
+        CrossingRequestPort(const std::string &_name, EventqCrossing &_xing)
+            : RequestPort(_name, &_xing), xing(_xing)
+        { }
+
+      protected:
+        void recvFunctionalSnoop(PacketPtr pkt) override;
+        Tick recvAtomicSnoop(PacketPtr pkt) override;
+        bool recvTimingResp(PacketPtr pkt) override;
+        void recvTimingSnoopReq(PacketPtr pkt) override;
+        void recvRangeChange() override;
+        bool isSnooping() const override;
+        void recvReqRetry() override;
+        void recvRetrySnoopResp() override;
+
+      private:
+        EventqCrossing &xing;
+    };
+
+    class CrossingResponsePort : public ResponsePort
+    {
+      public:
+        CrossingResponsePort(const std::string &_name, EventqCrossing &_xing)
+            : ResponsePort(_name, &_xing), xing(_xing)
+        { }
+
+      protected:
+        void recvFunctional(PacketPtr pkt) override;
+        Tick recvAtomic(PacketPtr pkt) override;
+        bool recvTimingReq(PacketPtr pkt) override;
+        bool recvTimingSnoopResp(PacketPtr pkt) override;
+        AddrRangeList getAddrRanges() const override;
+        void recvRespRetry() override;
+        bool tryTiming(PacketPtr pkt) override;
+
+      private:
+        EventqCrossing &xing;
+    };
+
+    /** Send the requests that arrived in the memory side queue. */
+    void sendRequests();
+
+    /** Send the responses that arrived in the CPU side queue. */
+    void sendResponses();
+
+    /** Send the snoop responses that arrived in the memory side queue. */
+    void sendSnoopResponses();
+
+    /** Event queue of the memory side. */
+    EventQueue *memSideQueue;
+
+    CrossingRequestPort memSidePort;
+    CrossingResponsePort cpuSidePort;
+
+    /** Hand packets to the queue of the CPU and the memory side. */
+    EventqMailbox toCpuSide;
+    EventqMailbox toMemSide;
+
+    /**
+     * Packets that arrived but were not accepted yet, only accessed by
+     * the queue of the receiving side.
+     */
+    std::deque<PacketPtr> requests;
+    std::deque<PacketPtr> responses;
+    std::deque<PacketPtr> snoopResponses;
+
+    /** The receiving side refused a packet and will send a retry. */
+    bool waitingForReqRetry;
+    bool waitingForRespRetry;
+    bool waitingForSnoopRespRetry;
+};
+
+#endif //__MEM_EVENTQ_CROSSING_HH__
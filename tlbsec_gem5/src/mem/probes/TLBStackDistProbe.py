@@ -0,0 +1,51 @@
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.params import *
+from m5.proxy import *
+from m5.SimObject import SimObject
+
+class TLBStackDistProbe(SimObject):
+    type = 'TLBStackDistProbe'
+    cxx_header = "mem/probes/tlb_stack_dist.hh"
+
+    manager = Param.SimObject(Parent.any, "TLB to profile")
+    probe_name = Param.String("TlbAccess", "TLB access probe to use")
+
+    max_entries = Param.Unsigned(1024,
+                                 "Largest TLB size of the miss-ratio curves")
+    max_asids = Param.Unsigned(64, "ASIDs with their own miss-ratio curve, "
+                               "later ones are merged into 'other'")
+
+    # TLB organizations to estimate set conflicts for, as ways x sets
+    geometry_ways = VectorParam.Unsigned([4, 8, 8],
+                                         "Associativity of each geometry")
+    geometry_sets = VectorParam.Unsigned([16, 16, 128],
+                                         "Number of sets of each geometry")
+
+    # full curves, relative to the output directory
+    mrc_file = Param.String("", "Miss-ratio curve output file "
+                            "(empty to disable)")
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/probes/tlb_stack_dist.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/bitfield.hh"
+#include "base/callback.hh"
+#include "base/cprintf.hh"
+#include "base/intmath.hh"
+#include "base/output.hh"
+#include "params/TLBStackDistProbe.hh"
+
+namespace
+{
+
+// Page sizes supported by Sv39/Sv48, in address bits
+const unsigned PageSizeShift = 12;
+const unsigned PageSizeLevelBits = 9;
+const char *const pageSizeNames[] = {"4KiB", "2MiB", "1GiB"};
+const unsigned NumPageSizes = 3;
+
+// Sv39 and Sv48 page numbers have at most 36 bits, leaving room for the
+// page size and the ASID in a stream key
+const unsigned PageNumberBits = 36;
+
+} // anonymous namespace
+
+void
+TLBStackDistProbe::Stream::access(uint64_t page, size_t max_dist)
+{
+    accesses++;
+    auto it = lastAccess.find(page);
+    if (it == lastAccess.end()) {
+        coldMisses++;
+        lastAccess.emplace(page, clock);
+    } else {
+        // Every page accessed after the last access of this one is
+        // above it on the LRU stack
+        const size_t dist = stack.countGreater(it->second);
+        if (dist >= max_dist) {
+            farAccesses++;
+        } else {
+            if (dist >= distHist.size())
+                distHist.resize(dist + 1, 0);
+            distHist[dist]++;
+        }
+        stack.erase(it->second);
+        it->second = clock;
+    }
+    stack.insert(clock);
+    clock++;
+}
+
+void
+TLBStackDistProbe::Stream::resetHist()
+{
+    accesses = 0;
+    coldMisses = 0;
+    farAccesses = 0;
+    std::fill(distHist.begin(), distHist.end(), 0);
+}
+
+std::vector<uint64_t>
+TLBStackDistProbe::Stream::faMisses(size_t max_entries) const
+{
+    // A fully associative LRU TLB of n entries hits iff the stack
+    // distance is smaller than n
+    std::vector<uint64_t> misses(max_entries);
+    uint64_t hits = 0;
+    for (size_t n = 1; n <= max_entries; n++) {
+        if (n - 1 < distHist.size())
+            hits += distHist[n - 1];
+        misses[n - 1] = accesses - hits;
+    }
+    return misses;
+}
+
+double
+TLBStackDistProbe::Stream::estimateMisses(
+    const std::vector<double> &hit_prob) const
+{
+    double misses = coldMisses + farAccesses;
+    for (size_t d = 0; d < distHist.size(); d++)
+        misses += distHist[d] * (1.0 - hit_prob[d]);
+    return misses;
+}
+
+TLBStackDistProbe::TLBStackDistProbe(const TLBStackDistProbeParams &p)
+    : SimObject(p),
+      maxEntries(p.max_entries),
+      maxDistance(8 * (size_t)p.max_entries),
+      maxAsids(p.max_asids),
+      mrcFile(p.mrc_file),
+      allStream("all"),
+      otherAsids("other"),
+      stats(this)
+{
+    fatal_if(p.geometry_ways.size() != p.geometry_sets.size(),
+             "%s: geometry_ways and geometry_sets must have the same "
+             "length.\n", name());
+
+    for (int i = 0; i < p.geometry_ways.size(); i++) {
+        Geometry geom;
+        geom.ways = p.geometry_ways[i];
+        geom.sets = p.geometry_sets[i];
+        const uint64_t entries = (uint64_t)geom.ways * geom.sets;
+        fatal_if(entries == 0 || entries > maxEntries,
+                 "%s: Geometry %dx%d must have 1 to max_entries (%d) "
+                 "entries.\n", name(), geom.ways, geom.sets, maxEntries);
+
+        // Set associative LRU: a page hits if fewer than ways of the
+        // pages above it on the stack map to its set.
+        const double q = 1.0 / geom.sets;
+        geom.setAssocHit.resize(maxDistance);
+        for (size_t d = 0; d < maxDistance; d++) {
+            if (geom.sets == 1) {
+                geom.setAssocHit[d] = d < geom.ways ? 1.0 : 0.0;
+                continue;
+            }
+            double term = std::exp(d * std::log1p(-q));
+            double prob = 0;
+            for (unsigned k = 0; k < geom.ways && k <= d; k++) {
+                prob += term;
+                term *= (double)(d - k) / (k + 1) * q / (1 - q);
+            }
+            geom.setAssocHit[d] = std::min(prob, 1.0);
+        }
+
+        // PRINCE-skewed: the indices behave like independent random
+        // numbers per way. The j-th page inserted after our page picks
+        // our slot in our way with probability 1/sets and evicts it if
+        // our page is the oldest of its candidates, which with LRU-like
+        // replacement happens with about (j/entries)^(ways-1).
+        geom.skewedHit.resize(maxDistance);
+        double survive = 1.0;
+        for (size_t d = 0; d < maxDistance; d++) {
+            geom.skewedHit[d] = survive;
+            const double age = std::min<double>(d + 1, entries) / entries;
+            survive *= 1.0 - q * std::pow(age, geom.ways - 1);
+        }
+
+        geometries.push_back(std::move(geom));
+    }
+
+    for (unsigned i = 0; i < NumPageSizes; i++)
+        pageSizeStreams.emplace_back(pageSizeNames[i]);
+
+    stats.faMisses.init(floorLog2(maxEntries) + 1);
+    for (unsigned i = 0; i < stats.faMisses.size(); i++)
+        stats.faMisses.subname(i, std::to_string(1 << i));
+    stats.setAssocMisses.init(geometries.size());
+    stats.skewedMisses.init(geometries.size());
+    for (unsigned i = 0; i < geometries.size(); i++) {
+        const std::string geom_name = csprintf("%dx%d", geometries[i].ways,
+                                               geometries[i].sets);
+        stats.setAssocMisses.subname(i, geom_name);
+        stats.skewedMisses.subname(i, geom_name);
+    }
+
+    if (!mrcFile.empty())
+        registerExitCallback([this]() { dumpCurves(); });
+}
+
+TLBStackDistProbe::
+TLBStackDistProbeStats::TLBStackDistProbeStats(TLBStackDistProbe *parent)
+    : Stats::Group(parent),
+      ADD_STAT(accesses, UNIT_COUNT, "Number of profiled translations"),
+      ADD_STAT(coldMisses, UNIT_COUNT,
+               "Translations of pages that were not used before"),
+      ADD_STAT(pageSizeAccesses, UNIT_COUNT,
+               "Number of profiled translations per page size"),
+      ADD_STAT(faMisses, UNIT_COUNT,
+               "Misses of a fully associative LRU TLB per number of "
+               "entries"),
+      ADD_STAT(faMissRate, UNIT_RATIO,
+               "Miss rate of a fully associative LRU TLB per number of "
+               "entries", faMisses / accesses),
+      ADD_STAT(setAssocMisses, UNIT_COUNT,
+               "Estimated misses of a set associative LRU TLB per "
+               "geometry (ways x sets)"),
+      ADD_STAT(setAssocMissRate, UNIT_RATIO,
+               "Estimated miss rate of a set associative LRU TLB per "
+               "geometry (ways x sets)", setAssocMisses / accesses),
+      ADD_STAT(skewedMisses, UNIT_COUNT,
+               "Estimated misses of a PRINCE-skewed TLB per geometry "
+               "(ways x sets)"),
+      ADD_STAT(skewedMissRate, UNIT_RATIO,
+               "Estimated miss rate of a PRINCE-skewed TLB per geometry "
+               "(ways x sets)", skewedMisses / accesses)
+{
+    pageSizeAccesses.init(NumPageSizes);
+    for (unsigned i = 0; i < NumPageSizes; i++)
+        pageSizeAccesses.subname(i, pageSizeNames[i]);
+}
+
+void
+TLBStackDistProbe::regProbeListeners()
+{
+    const TLBStackDistProbeParams &p =
+        dynamic_cast<const TLBStackDistProbeParams &>(params());
+
+    listener.reset(new AccessListener(*this,
+                                      p.manager->getProbeManager(),
+                                      p.probe_name));
+}
+
+void
+TLBStackDistProbe::handleAccess(const ProbePoints::TlbAccessInfo &info)
+{
+    // Faulting translations did not map a page
+    if (info.logBytes < PageSizeShift)
+        return;
+
+    const unsigned size_idx = std::min(
+        (info.logBytes - PageSizeShift) / PageSizeLevelBits,
+        NumPageSizes - 1);
+    const uint64_t page = ((info.vaddr >> info.logBytes) &
+                           mask(PageNumberBits)) |
+        ((uint64_t)size_idx << PageNumberBits) |
+        ((uint64_t)info.asid << (PageNumberBits + 2));
+
+    allStream.access(page, maxDistance);
+    pageSizeStreams[size_idx].access(page, maxDistance);
+
+    auto it = asidStream.find(info.asid);
+    if (it == asidStream.end() && asidStreams.size() < maxAsids) {
+        it = asidStream.emplace(info.asid, asidStreams.size()).first;
+        asidStreams.emplace_back(csprintf("asid%d", info.asid));
+    }
+    Stream &asid_stream = it != asidStream.end() ?
+        asidStreams[it->second] : otherAsids;
+    asid_stream.access(page, maxDistance);
+}
+
+void
+TLBStackDistProbe::resetStats()
+{
+    SimObject::resetStats();
+
+    // Keep the stacks, so the profile continues from a warm state
+    allStream.resetHist();
+    for (auto &stream : pageSizeStreams)
+        stream.resetHist();
+    for (auto &stream : asidStreams)
+        stream.resetHist();
+    otherAsids.resetHist();
+}
+
+void
+TLBStackDistProbe::preDumpStats()
+{
+    SimObject::preDumpStats();
+
+    stats.accesses = allStream.accesses;
+    stats.coldMisses = allStream.coldMisses;
+    for (unsigned i = 0; i < NumPageSizes; i++)
+        stats.pageSizeAccesses[i] = pageSizeStreams[i].accesses;
+
+    const std::vector<uint64_t> misses = allStream.faMisses(maxEntries);
+    for (unsigned i = 0; i < stats.faMisses.size(); i++)
+        stats.faMisses[i] = misses[(1 << i) - 1];
+
+    for (unsigned i = 0; i < geometries.size(); i++) {
+        stats.setAssocMisses[i] =
+            allStream.estimateMisses(geometries[i].setAssocHit);
+        stats.skewedMisses[i] =
+            allStream.estimateMisses(geometries[i].skewedHit);
+    }
+}
+
+void
+TLBStackDistProbe::dumpCurves()
+{
+    std::vector<const Stream *> streams;
+    streams.push_back(&allStream);
+    for (const auto &stream : pageSizeStreams)
+        streams.push_back(&stream);
+    for (const auto &stream : asidStreams)
+        streams.push_back(&stream);
+    streams.push_back(&otherAsids);
+    streams.erase(std::remove_if(streams.begin(), streams.end(),
+                                 [](const Stream *s) {
+                                     return s->accesses == 0;
+                                 }), streams.end());
+
+    OutputStream *os = simout.create(mrcFile);
+    std::ostream &out = *os->stream();
+
+    ccprintf(out, "# TLB miss-ratio curves of %s\n",
+             dynamic_cast<const TLBStackDistProbeParams &>(
+                 params()).manager->name());
+    ccprintf(out, "# stream accesses cold_misses\n");
+    for (const Stream *stream : streams) {
+        ccprintf(out, "# %s %d %d\n", stream->name, stream->accesses,
+                 stream->coldMisses);
+    }
+
+    // Fully associative LRU miss ratio for every TLB size
+    std::vector<std::vector<uint64_t>> misses;
+    ccprintf(out, "entries");
+    for (const Stream *stream : streams) {
+        ccprintf(out, " %s", stream->name);
+        misses.push_back(stream->faMisses(maxEntries));
+    }
+    ccprintf(out, "\n");
+    for (unsigned n = 1; n <= maxEntries; n++) {
+        ccprintf(out, "%d", n);
+        for (unsigned i = 0; i < streams.size(); i++) {
+            ccprintf(out, " %.6f",
+                     (double)misses[i][n - 1] / streams[i]->accesses);
+        }
+        ccprintf(out, "\n");
+    }
+
+    // Set-conflict estimates
+    ccprintf(out, "\n# Estimated miss ratio per geometry\n");
+    ccprintf(out, "geometry stream fully_assoc set_assoc skewed\n");
+    for (const Geometry &geom : geometries) {
+        const unsigned entries = geom.ways * geom.sets;
+        for (unsigned i = 0; i < streams.size(); i++) {
+            const double accesses = streams[i]->accesses;
+            ccprintf(out, "%dx%d %s %.6f %.6f %.6f\n", geom.ways, geom.sets,
+                     streams[i]->name, misses[i][entries - 1] / accesses,
+                     streams[i]->estimateMisses(geom.setAssocHit) / accesses,
+                     streams[i]->estimateMisses(geom.skewedHit) / accesses);
+        }
+    }
+
+    simout.close(os);
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_PROBES_TLB_STACK_DIST_HH__
+#define __MEM_PROBES_TLB_STACK_DIST_HH__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/order_stat_tree.hh"
+#include "base/statistics.hh"
+#include "sim/probe/tlb.hh"
+#include "sim/sim_object.hh"
+
+struct TLBStackDistProbeParams;
+
+/**
+ * Page-granular LRU stack-distance profiler for a TLB. It listens to the
+ * TlbAccess probe point of the TLB and computes, for every translation,
+ * the number of distinct pages used since the last use of the same page.
+ * From the distance histogram it derives, in a single run, the miss
+ * ratio of a fully associative LRU TLB of every size up to max_entries,
+ * plus analytic estimates for set associative and PRINCE-skewed
+ * (randomized, per-way indexed) TLBs of the configured geometries.
+ *
+ * Separate stacks are kept for all translations, for each page size and
+ * for each ASID. Every stack is an order-statistics tree keyed by the
+ * time of the last access, so each translation costs O(log n) in the
+ * number of distinct pages. TLB flushes are not modeled.
+ */
+class TLBStackDistProbe : public SimObject
+{
+  public:
+    TLBStackDistProbe(const TLBStackDistProbeParams &params);
+
+    void regProbeListeners() override;
+
+    void resetStats() override;
+
+    void preDumpStats() override;
+
+  protected:
+    /** One LRU stack and its distance histogram. */
+    struct Stream
+    {
+        Stream(const std::string &_name) : name(_name) {}
+
+        /**
+         * Access a page and record its stack distance.
+         *
+         * @param max_dist Distances from here on are only counted
+         */
+        void access(uint64_t page, size_t max_dist);
+
+        /** Clear the histogram but keep the stack (warm state). */
+        void resetHist();
+
+        /** Misses of a fully associative LRU TLB of every size. */
+        std::vector<uint64_t> faMisses(size_t max_entries) const;
+
+        /** Estimated misses given the hit probability per distance. */
+        double estimateMisses(const std::vector<double> &hit_prob) const;
+
+        const std::string name;
+
+        /** Time of the last access of every page seen so far. */
+        std::unordered_map<uint64_t, uint64_t> lastAccess;
+        OrderStatTree<uint64_t> stack;
+        uint64_t clock = 0;
+
+        uint64_t accesses = 0;
+        /** First accesses of a page (infinite distance). */
+        uint64_t coldMisses = 0;
+        /** Accesses with a distance of at least max_dist. */
+        uint64_t farAccesses = 0;
+        std::vector<uint64_t> distHist;
+    };
+
+    /** A TLB organization for the set-conflict estimates. */
+    struct Geometry
+    {
+        unsigned ways;
+        unsigned sets;
+        /** Hit probability per stack distance, set associative LRU. */
+        std::vector<double> setAssocHit;
+        /** Hit probability per stack distance, PRINCE-skewed. */
+        std::vector<double> skewedHit;
+    };
+
+    void handleAccess(const ProbePoints::TlbAccessInfo &info);
+
+    /** Write the full curves to the output file. */
+    void dumpCurves();
+
+    /** Largest TLB size of the curves. */
+    const unsigned maxEntries;
+
+    /** Longest distance kept in the histograms. */
+    const size_t maxDistance;
+
+    /** Number of ASIDs with their own stack. */
+    const unsigned maxAsids;
+
+    const std::string mrcFile;
+
+    std::vector<Geometry> geometries;
+
+    Stream allStream;
+    /** One stream per page size (4KiB, 2MiB, 1GiB). */
+    std::vector<Stream> pageSizeStreams;
+    /** One stream per ASID in order of appearance. */
+    std::vector<Stream> asidStreams;
+    std::unordered_map<uint16_t, unsigned> asidStream;
+    /** All ASIDs beyond the first maxAsids ones. */
+    Stream otherAsids;
+
+    struct TLBStackDistProbeStats : public Stats::Group
+    {
+        TLBStackDistProbeStats(TLBStackDistProbe *parent);
+
+        Stats::Scalar accesses;
+        Stats::Scalar coldMisses;
+        Stats::Vector pageSizeAccesses;
+
+        /** Fully associative LRU misses, power of two sizes. */
+        Stats::Vector faMisses;
+        Stats::Formula faMissRate;
+
+        /** Estimated misses of the configured geometries. */
+        Stats::Vector setAssocMisses;
+        Stats::Formula setAssocMissRate;
+        Stats::Vector skewedMisses;
+        Stats::Formula skewedMissRate;
+    } stats;
+
+  private:
+    class AccessListener
+        : public ProbeListenerArgBase<ProbePoints::TlbAccessInfo>
+    {
+      public:
+        AccessListener(TLBStackDistProbe &_parent, ProbeManager *pm,
+                       const std::string &name)
+            : ProbeListenerArgBase(pm, name), parent(_parent) {}
+
+        void notify(const ProbePoints::TlbAccessInfo &info) override {
+            parent.handleAccess(info);
+        }
+
+      protected:
+        TLBStackDistProbe &parent;
+    };
+
+    std::unique_ptr<AccessListener> listener;
+};
+
+#endif //__MEM_PROBES_TLB_STACK_DIST_HH__
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/probes/tlb_trace.hh"
+
+#include "base/callback.hh"
+#include "base/output.hh"
+#include "params/TLBTraceProbe.hh"
+#include "proto/tlb_trace.pb.h"
+
+TLBTraceProbe::TLBTraceProbe(const TLBTraceProbeParams &p)
+    : SimObject(p),
+      traceStream(nullptr)
+{
+    std::string filename;
+    if (p.trace_file != "") {
+        // If the trace file is not specified as an absolute path,
+        // append the current simulation output directory
+        filename = simout.resolve(p.trace_file);
+
+        const std::string suffix = ".gz";
+        // If trace_compress has been set, check the suffix. Append
+        // accordingly.
+        if (p.trace_compress &&
+            filename.compare(filename.size() - suffix.size(), suffix.size(),
+                             suffix) != 0)
+            filename = filename + suffix;
+    } else {
+        // Generate a filename from the name of the SimObject. Append .trc
+        // and .gz if we want compression enabled.
+        filename = simout.resolve(name() + ".trc" +
+                                  (p.trace_compress ? ".gz" : ""));
+    }
+
+    traceStream = new ProtoOutputStream(filename);
+
+    // Register a callback to compensate for the destructor not
+    // being called. The callback forces the stream to flush and
+    // closes the output file.
+    registerExitCallback([this]() { closeStreams(); });
+}
+
+void
+TLBTraceProbe::regProbeListeners()
+{
+    const TLBTraceProbeParams &p =
+        dynamic_cast<const TLBTraceProbeParams &>(params());
+
+    listeners.resize(p.manager.size());
+    demapListeners.resize(p.manager.size());
+    for (int i = 0; i < p.manager.size(); i++) {
+        ProbeManager *const mgr(p.manager[i]->getProbeManager());
+        listeners[i].reset(new AccessListener(*this, i, mgr, p.probe_name));
+        demapListeners[i].reset(new DemapListener(*this, i, mgr,
+                                                  p.demap_probe_name));
+    }
+}
+
+void
+TLBTraceProbe::startup()
+{
+    const TLBTraceProbeParams &p =
+        dynamic_cast<const TLBTraceProbeParams &>(params());
+
+    // Create a protobuf message for the header and write it to
+    // the stream
+    ProtoMessage::TlbTraceHeader header_msg;
+    header_msg.set_obj_id(name());
+    header_msg.set_tick_freq(SimClock::Frequency);
+
+    for (int i = 0; i < p.manager.size(); i++) {
+        auto id_string = header_msg.add_id_strings();
+        id_string->set_key(i);
+        id_string->set_value(p.manager[i]->name());
+    }
+
+    traceStream->write(header_msg);
+}
+
+void
+TLBTraceProbe::closeStreams()
+{
+    if (traceStream != NULL)
+        delete traceStream;
+    traceStream = NULL;
+}
+
+void
+TLBTraceProbe::handleAccess(unsigned tlb_id,
+                            const ProbePoints::TlbAccessInfo &info)
+{
+    ProtoMessage::TlbAccess access_msg;
+
+    access_msg.set_tick(info.tick);
+    access_msg.set_vaddr(info.vaddr);
+    access_msg.set_asid(info.asid);
+    access_msg.set_mode(info.mode);
+    access_msg.set_hit(info.hit);
+    if (info.logBytes != 0)
+        access_msg.set_log_bytes(info.logBytes);
+    if (!info.hit)
+        access_msg.set_walk_latency(info.walkLatency);
+    if (tlb_id != 0)
+        access_msg.set_tlb_id(tlb_id);
+
+    traceStream->write(access_msg);
+}
+
+void
+TLBTraceProbe::handleDemap(unsigned tlb_id,
+                           const ProbePoints::TlbDemapInfo &info)
+{
+    ProtoMessage::TlbAccess demap_msg;
+
+    demap_msg.set_tick(info.tick);
+    demap_msg.set_vaddr(info.vaddr);
+    demap_msg.set_asid(info.asid);
+    demap_msg.set_mode(0);
+    demap_msg.set_hit(false);
+    demap_msg.set_demap(true);
+    if (tlb_id != 0)
+        demap_msg.set_tlb_id(tlb_id);
+
+    traceStream->write(demap_msg);
+}
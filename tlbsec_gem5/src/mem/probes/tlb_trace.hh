@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_PROBES_TLB_TRACE_HH__
+#define __MEM_PROBES_TLB_TRACE_HH__
+
+#include <memory>
+#include <vector>
+
+#include "proto/protoio.hh"
+#include "sim/probe/tlb.hh"
+#include "sim/sim_object.hh"
+
+struct TLBTraceProbeParams;
+
+/**
+ * Records every translation reported by one or more TLBs through their
+ * TlbAccess probe point, and every demap reported through TlbDemap, into
+ * a (gzipped) protobuf trace. The trace can be replayed offline against
+ * other TLB organizations.
+ */
+class TLBTraceProbe : public SimObject
+{
+  public:
+    TLBTraceProbe(const TLBTraceProbeParams &params);
+
+    void regProbeListeners() override;
+
+    void startup() override;
+
+  protected:
+    void handleAccess(unsigned tlb_id,
+                      const ProbePoints::TlbAccessInfo &info);
+    void handleDemap(unsigned tlb_id, const ProbePoints::TlbDemapInfo &info);
+
+    /**
+     * Callback to flush and close all open output streams on exit. If
+     * we were calling the destructor it could be done there.
+     */
+    void closeStreams();
+
+    /** Trace output stream */
+    ProtoOutputStream *traceStream;
+
+  private:
+    class AccessListener
+        : public ProbeListenerArgBase<ProbePoints::TlbAccessInfo>
+    {
+      public:
+        AccessListener(TLBTraceProbe &_parent, unsigned _tlbId,
+                       ProbeManager *pm, const std::string &name)
+            : ProbeListenerArgBase(pm, name),
+              parent(_parent), tlbId(_tlbId) {}
+
+        void notify(const ProbePoints::TlbAccessInfo &info) override {
+            parent.handleAccess(tlbId, info);
+        }
+
+      protected:
+        TLBTraceProbe &parent;
+        const unsigned tlbId;
+    };
+
+    class DemapListener
+        : public ProbeListenerArgBase<ProbePoints::TlbDemapInfo>
+    {
+      public:
+        DemapListener(TLBTraceProbe &_parent, unsigned _tlbId,
+                      ProbeManager *pm, const std::string &name)
+            : ProbeListenerArgBase(pm, name),
+              parent(_parent), tlbId(_tlbId) {}
+
+        void notify(const ProbePoints::TlbDemapInfo &info) override {
+            parent.handleDemap(tlbId, info);
+        }
+
+      protected:
+        TLBTraceProbe &parent;
+        const unsigned tlbId;
+    };
+
+    std::vector<std::unique_ptr<AccessListener>> listeners;
+    std::vector<std::unique_ptr<DemapListener>> demapListeners;
+};
+
+#endif //__MEM_PROBES_TLB_TRACE_HH__
@@ -61,6 +61,7 @@ class System(SimObject):
     cxx_exports = [
         PyBindMethod("getMemoryMode"),
         PyBindMethod("setMemoryMode"),
+        PyBindMethod("setReadfile"),
     ]
 
     memories = VectorParam.AbstractMemory(Self.all,
@@ -42,6 +42,7 @@
 #include "cpu/smt.hh"
 #include "debug/Checkpoint.hh"
 #include "sim/core.hh"
+#include "sim/host_profiler.hh"
 
 Tick simQuantum = 0;
 
@@ -218,7 +219,10 @@ EventQueue::serviceOne()
         setCurTick(event->when());
         if (DTRACE(Event))
             event->trace("executed");
-        event->process();
+        {
+            HostProfiler::EventScope profile(event);
+            event->process();
+        }
         if (event->isExitEvent()) {
             assert(!event->flags.isSet(Event::Managed) ||
                    !event->flags.isSet(Event::IsMainQueue)); // would be silly
@@ -54,6 +54,7 @@
 
 class EventQueue;       // forward declaration
 class BaseGlobalEvent;
+struct HostProfileNode;
 
 //! Simulation Quantum for multiple eventq simulation.
 //! The quantum value is the period length after which the queues
@@ -248,6 +249,7 @@ class EventBase
 class Event : public EventBase, public Serializable
 {
     friend class EventQueue;
+    friend class HostProfiler;
 
   private:
     // The event queue is now a linked list of linked lists.  The
@@ -269,6 +271,10 @@ class Event : public EventBase, public Serializable
     Priority _priority; //!< event priority
     Flags flags;
 
+    /// Host time counters of this event, set when it first runs while
+    /// a HostProfiler is active
+    HostProfileNode *profileNode;
+
 #ifndef NDEBUG
     /// Global counter to generate unique IDs for Event instances
     static Counter instanceCounter;
@@ -410,7 +416,7 @@ class Event : public EventBase, public Serializable
      */
     Event(Priority p = Default_Pri, Flags f = 0)
         : nextBin(nullptr), nextInBin(nullptr), _when(0), _priority(p),
-          flags(Initialized | f)
+          flags(Initialized | f), profileNode(nullptr)
     {
         assert(f.noneSet(~PublicWrite));
 #ifndef NDEBUG
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "sim/eventq_mailbox.hh"
+
+#include <utility>
+#include <vector>
+
+EventqMailbox::EventqMailbox(EventQueue *target, const std::string &name)
+    : _target(target), _name(name)
+{
+}
+
+void
+EventqMailbox::post(std::function<void()> work)
+{
+    if (!inParallelMode || curEventQueue() == _target) {
+        work();
+        return;
+    }
+
+    // The target is less than one quantum ahead of this queue, so the
+    // work is due after the next barrier, which inserts the event.
+    // Equal ticks keep the order of posting.
+    const Tick when = curTick() + simQuantum;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        mail.emplace(when, std::move(work));
+    }
+    _target->schedule(new EventFunctionWrapper([this]{ deliver(); },
+                                               _name, true),
+                      when, true);
+}
+
+void
+EventqMailbox::deliver()
+{
+    std::vector<std::function<void()>> due;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto end = mail.upper_bound(curTick());
+        for (auto it = mail.begin(); it != end; ++it)
+            due.push_back(std::move(it->second));
+        mail.erase(mail.begin(), end);
+    }
+    // Every post schedules an event, the first one of a tick runs the
+    // work of all of them
+    for (auto &work : due)
+        work();
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __SIM_EVENTQ_MAILBOX_HH__
+#define __SIM_EVENTQ_MAILBOX_HH__
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+/**
+ * Hands work from other event queues (host threads) to one target event
+ * queue in parallel simulation.
+ *
+ * Work posted by another queue runs in the target queue one simulation
+ * quantum after it was posted. That is after the next barrier, so the
+ * poster never touches state of the target queue, and neither queue
+ * has to enter the other one (see EventQueue::ScopedMigration). Work
+ * posted by one queue runs in the order it was posted. Work posted by
+ * the target queue itself, or outside of parallel simulation, runs
+ * right away.
+ */
+class EventqMailbox
+{
+  public:
+    EventqMailbox(EventQueue *target, const std::string &name);
+
+    /** Run work in the target queue. Safe to call from any queue. */
+    void post(std::function<void()> work);
+
+    EventQueue *target() const { return _target; }
+
+  private:
+    /** Run the work that is due in the target queue. */
+    void deliver();
+
+    EventQueue *_target;
+    const std::string _name;
+
+    std::mutex mutex;
+    /** Posted work by the tick it is due. */
+    std::multimap<Tick, std::function<void()>> mail;
+};
+
+#endif // __SIM_EVENTQ_MAILBOX_HH__
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "sim/host_profiler.hh"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "params/HostProfiler.hh"
+#include "sim/core.hh"
+#include "sim/eventq.hh"
+
+struct HostProfile;
+
+/**
+ * Host time of an event or a scope, in the stack of events and scopes
+ * it ran in. Nodes belong to the profile of one thread and are only
+ * freed at exit, so events can keep a pointer to theirs.
+ */
+struct HostProfileNode
+{
+    HostProfileNode(HostProfile *profile, HostProfileNode *parent,
+                    const void *key, const std::string &object,
+                    const std::string &frame, bool is_event)
+        : profile(profile), parent(parent), key(key), object(object),
+          frame(frame), isEvent(is_event)
+    {}
+
+    HostProfileNode *
+    child(const HostProfiler::Label &label, bool is_event)
+    {
+        for (auto &c : children) {
+            if (c->key == &label)
+                return c.get();
+        }
+        children.emplace_back(new HostProfileNode(profile, this, &label,
+                                                  label.object,
+                                                  label.frame, is_event));
+        return children.back().get();
+    }
+
+    HostProfile *const profile;
+    HostProfileNode *const parent;
+    const void *const key;
+    const std::string object;
+    const std::string frame;
+    const bool isEvent;
+
+    // Including the children
+    uint64_t cycles = 0;
+    uint64_t count = 0;
+    std::vector<std::unique_ptr<HostProfileNode>> children;
+};
+
+/** Counters of one event queue thread. */
+struct HostProfile
+{
+    HostProfile()
+        : root(this, nullptr, nullptr, "", "", false), current(&root)
+    {}
+
+    HostProfileNode root;
+    HostProfileNode *current;
+    /** Nodes of events by name, for events that are created often. */
+    std::unordered_map<std::string, HostProfileNode *> byName;
+};
+
+bool HostProfiler::eventsOn = false;
+bool HostProfiler::scopesOn = false;
+
+namespace
+{
+
+const std::string unknownObject = "(unknown)";
+
+HostProfiler *instance = nullptr;
+
+std::mutex profilesMutex;
+std::vector<std::unique_ptr<HostProfile>> profiles;
+thread_local HostProfile *threadProfile = nullptr;
+
+std::mutex labelsMutex;
+std::unordered_map<std::string, std::unique_ptr<HostProfiler::Label>>
+    eventLabels;
+
+HostProfile &
+currentProfile()
+{
+    if (!threadProfile) {
+        std::lock_guard<std::mutex> lock(profilesMutex);
+        profiles.emplace_back(new HostProfile);
+        threadProfile = profiles.back().get();
+    }
+    return *threadProfile;
+}
+
+bool
+stripSuffix(std::string &s, const std::string &suffix)
+{
+    if (s.size() < suffix.size() ||
+        s.compare(s.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return false;
+    }
+    s.resize(s.size() - suffix.size());
+    return true;
+}
+
+/**
+ * The owner of an event is the longest prefix of its name that names a
+ * SimObject, the rest of the name is the call. Events without a name
+ * are charged to an unknown object by their description.
+ */
+const HostProfiler::Label &
+eventLabel(const std::string &event_name, const char *description)
+{
+    std::string name = event_name;
+    if (!stripSuffix(name, ".wrapped_function_event"))
+        stripSuffix(name, ".wrapped_event");
+
+    std::string object = unknownObject;
+    std::string call = description;
+    // Event_<n> is the default name of an Event
+    if (name.compare(0, 6, "Event_") != 0) {
+        size_t dot = name.size();
+        while (true) {
+            const std::string prefix = name.substr(0, dot);
+            if (SimObject::find(prefix.c_str())) {
+                object = prefix;
+                if (dot != name.size())
+                    call = name.substr(dot + 1);
+                break;
+            }
+            if (dot == 0 ||
+                (dot = name.rfind('.', dot - 1)) == std::string::npos) {
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(labelsMutex);
+    auto &label = eventLabels[object + "::" + call];
+    if (!label)
+        label.reset(new HostProfiler::Label(object, call));
+    return *label;
+}
+
+struct Row
+{
+    uint64_t events = 0;
+    uint64_t calls = 0;
+    uint64_t cycles = 0;
+};
+
+/** Add the self time of a node and its children to the output. */
+void
+collect(const HostProfileNode &node, const std::string &stack,
+        std::map<std::string, uint64_t> &folded,
+        std::map<std::string, Row> &rows, uint64_t &reads)
+{
+    uint64_t child_cycles = 0;
+    for (const auto &c : node.children)
+        child_cycles += c->cycles;
+    const uint64_t self =
+        node.cycles > child_cycles ? node.cycles - child_cycles : 0;
+
+    Row &row = rows[node.object];
+    if (node.isEvent)
+        row.events += node.count;
+    else
+        row.calls += node.count;
+    row.cycles += self;
+    folded[stack] += self;
+    reads += 2 * node.count;
+
+    for (const auto &c : node.children)
+        collect(*c, stack + ";" + c->frame, folded, rows, reads);
+}
+
+} // anonymous namespace
+
+HostProfiler::HostProfiler(const HostProfilerParams &p)
+    : SimObject(p), fileName(p.file), profileScopes(p.scopes),
+      started(false), startCycles(0), readCycles(0)
+{
+    fatal_if(instance, "%s: Only one HostProfiler is supported, %s "
+             "already exists\n", name(), instance->name());
+    instance = this;
+
+    registerExitCallback([this]() {
+        if (started)
+            dump();
+    });
+}
+
+void
+HostProfiler::startup()
+{
+    // Cost of a counter read, to estimate the overhead
+    const unsigned reads = 4096;
+    uint64_t begin = now();
+    for (unsigned i = 0; i < reads; i++)
+        now();
+    readCycles = double(now() - begin) / (reads + 1);
+
+    startCycles = now();
+    startTime = std::chrono::steady_clock::now();
+    started = true;
+    eventsOn = true;
+    scopesOn = profileScopes;
+}
+
+void
+HostProfiler::notifyFork()
+{
+    // The child reports only its own run
+    reset();
+    startCycles = now();
+    startTime = std::chrono::steady_clock::now();
+}
+
+HostProfileNode *
+HostProfiler::enter(const Label &label)
+{
+    HostProfile &profile = currentProfile();
+    HostProfileNode *node = profile.current->child(label, false);
+    profile.current = node;
+    return node;
+}
+
+HostProfileNode *
+HostProfiler::enter(Event *event)
+{
+    HostProfile &profile = currentProfile();
+    HostProfileNode *node = event->profileNode;
+    if (!node || node->profile != &profile) {
+        const std::string name = event->name();
+        auto it = profile.byName.find(name);
+        if (it != profile.byName.end()) {
+            node = it->second;
+        } else {
+            const Label &label = eventLabel(name, event->description());
+            node = profile.root.child(label, true);
+            // Unnamed events all share a node, do not cache their names
+            if (label.object != unknownObject)
+                profile.byName[name] = node;
+        }
+        event->profileNode = node;
+    }
+    profile.current = node;
+    return node;
+}
+
+void
+HostProfiler::leave(HostProfileNode *node, uint64_t start)
+{
+    node->cycles += now() - start;
+    node->count++;
+    node->profile->current = node->parent;
+}
+
+void
+HostProfiler::reset()
+{
+    std::lock_guard<std::mutex> lock(profilesMutex);
+    std::vector<HostProfileNode *> nodes;
+    for (auto &profile : profiles)
+        nodes.push_back(&profile->root);
+    while (!nodes.empty()) {
+        HostProfileNode *node = nodes.back();
+        nodes.pop_back();
+        node->cycles = 0;
+        node->count = 0;
+        for (auto &c : node->children)
+            nodes.push_back(c.get());
+    }
+}
+
+void
+HostProfiler::dump()
+{
+    const uint64_t elapsed_cycles = now() - startCycles;
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - startTime;
+    const double cycles_per_sec =
+        elapsed.count() > 0 ? elapsed_cycles / elapsed.count() : 1;
+
+    std::map<std::string, uint64_t> folded;
+    std::map<std::string, Row> rows;
+    uint64_t reads = 0;
+    size_t threads;
+    {
+        std::lock_guard<std::mutex> lock(profilesMutex);
+        threads = profiles.size();
+        for (const auto &profile : profiles) {
+            for (const auto &c : profile->root.children)
+                collect(*c, c->frame, folded, rows, reads);
+        }
+    }
+
+    uint64_t profiled = 0;
+    std::vector<std::pair<std::string, Row>> sorted(rows.begin(),
+                                                    rows.end());
+    for (const auto &r : sorted)
+        profiled += r.second.cycles;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<std::string, Row> &a,
+                 const std::pair<std::string, Row> &b) {
+                  return a.second.cycles > b.second.cycles;
+              });
+
+    OutputStream *table = simout.create(fileName + ".txt");
+    std::ostream &os = *table->stream();
+    ccprintf(os, "Host profile of %.2f s (%d counter cycles at %.3f GHz) "
+             "in %d event queue thread(s)\n", elapsed.count(),
+             elapsed_cycles, cycles_per_sec / 1e9, threads);
+    ccprintf(os, "Events and scopes: %.2f s (%.1f%% of the elapsed time "
+             "of all threads), the rest went to Python, statistics and "
+             "the event queues\n", profiled / cycles_per_sec,
+             elapsed_cycles && threads ?
+             100.0 * profiled / (elapsed_cycles * threads) : 0.0);
+    ccprintf(os, "Counter reads: %d, about %.2f%% of the profiled time\n\n",
+             reads, profiled ? 100.0 * reads * readCycles / profiled : 0.0);
+    ccprintf(os, "%-48s %14s %14s %12s %8s\n", "object", "events",
+             "calls", "self_s", "self_%");
+    for (const auto &r : sorted) {
+        ccprintf(os, "%-48s %14d %14d %12.4f %8.2f\n", r.first,
+                 r.second.events, r.second.calls,
+                 r.second.cycles / cycles_per_sec,
+                 profiled ? 100.0 * r.second.cycles / profiled : 0.0);
+    }
+    simout.close(table);
+
+    OutputStream *stacks = simout.create(fileName + ".folded");
+    for (const auto &f : folded) {
+        if (f.second)
+            ccprintf(*stacks->stream(), "%s %d\n", f.first, f.second);
+    }
+    simout.close(stacks);
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __SIM_HOST_PROFILER_HH__
+#define __SIM_HOST_PROFILER_HH__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "sim/sim_object.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class Event;
+struct HostProfileNode;
+struct HostProfilerParams;
+
+/**
+ * Attributes host time to the SimObjects that spend it.
+ *
+ * While a HostProfiler exists, EventQueue::serviceOne() reads the host
+ * cycle counter (rdtsc, or cntvct_el0 on Arm hosts) around every event
+ * and charges the difference to the object the event belongs to, found
+ * once per event from its name. Hot calls that are not events of their
+ * own, such as the lookups of a TLB, are timed with a Scope: they are
+ * charged to the object of their Label and not to the event they run
+ * in.
+ *
+ * At exit, <file>.txt gets a table of the self time of every object and
+ * <file>.folded the event and scope stacks in the folded format read by
+ * flamegraph.pl. Every event queue thread keeps its own counters, which
+ * are merged in the output.
+ */
+class HostProfiler : public SimObject
+{
+  public:
+    /** A hot call of an object, e.g. the lookup of a TLB. */
+    class Label
+    {
+      public:
+        Label(const std::string &object, const std::string &call)
+            : object(object), frame(object + "::" + call)
+        {}
+
+        const std::string object;
+        const std::string frame;
+    };
+
+    /** Charges the host time of its lifetime to a Label. */
+    class Scope
+    {
+      public:
+        Scope(const Label &label)
+            : node(scopesOn ? enter(label) : nullptr),
+              start(node ? now() : 0)
+        {}
+
+        ~Scope()
+        {
+            if (node)
+                leave(node, start);
+        }
+
+      private:
+        HostProfileNode *node;
+        uint64_t start;
+    };
+
+    /** Charges the host time of processing an event to its owner. */
+    class EventScope
+    {
+      public:
+        EventScope(Event *event)
+            : node(eventsOn ? enter(event) : nullptr),
+              start(node ? now() : 0)
+        {}
+
+        ~EventScope()
+        {
+            if (node)
+                leave(node, start);
+        }
+
+      private:
+        HostProfileNode *node;
+        uint64_t start;
+    };
+
+    /** Read the host cycle counter. */
+    static uint64_t
+    now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t val;
+        asm volatile("mrs %0, cntvct_el0" : "=r" (val));
+        return val;
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    HostProfiler(const HostProfilerParams &p);
+
+    void startup() override;
+    void notifyFork() override;
+
+    /** Write the table and the folded stacks. */
+    void dump();
+
+  protected:
+    static HostProfileNode *enter(const Label &label);
+    static HostProfileNode *enter(Event *event);
+    static void leave(HostProfileNode *node, uint64_t start);
+
+    /** Zero the counters of all threads. */
+    static void reset();
+
+    static bool eventsOn;
+    static bool scopesOn;
+
+    const std::string fileName;
+    const bool profileScopes;
+    bool started;
+
+    /** Counter and wall clock at startup, to convert to seconds. */
+    uint64_t startCycles;
+    std::chrono::steady_clock::time_point startTime;
+    /** Counter cycles taken by one counter read. */
+    double readCycles;
+};
+
+#endif // __SIM_HOST_PROFILER_HH__
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIM_PROBE_TLB_HH__
+#define __SIM_PROBE_TLB_HH__
+
+#include <memory>
+
+#include "arch/generic/tlb.hh"
+#include "base/types.hh"
+#include "sim/probe/probe.hh"
+
+namespace ProbePoints {
+
+/**
+ * A single address translation as seen by a TLB. Hits are reported when
+ * the lookup happens. Misses are reported once the page table walk has
+ * finished, with the tick of the original lookup and the time the walk
+ * took, so records of a timing-mode trace are not strictly tick ordered.
+ */
+struct TlbAccessInfo {
+    Tick tick;
+    Addr vaddr;
+    uint16_t asid;
+    BaseTLB::Mode mode;
+    /** Size of the translated page in address bits, 0 on a fault. */
+    unsigned logBytes;
+    bool hit;
+    Tick walkLatency;
+};
+
+/**
+ * TLB access probe point
+ *
+ * TLBs should use the name TlbAccess for this probe point and notify it
+ * once for each translation requested by the CPU.
+ */
+typedef ProbePointArg<TlbAccessInfo> TlbAccess;
+typedef std::unique_ptr<TlbAccess> TlbAccessUPtr;
+
+/**
+ * Entries dropped from a TLB, with sfence.vma semantics: a vaddr or
+ * asid of 0 matches every address or ASID, so a flush of the whole TLB
+ * has both 0.
+ */
+struct TlbDemapInfo {
+    Tick tick;
+    Addr vaddr;
+    uint16_t asid;
+};
+
+/**
+ * TLB demap probe point
+ *
+ * TLBs should use the name TlbDemap for this probe point and notify it
+ * for each demap or flush, so traces can be replayed with them.
+ */
+typedef ProbePointArg<TlbDemapInfo> TlbDemap;
+typedef std::unique_ptr<TlbDemap> TlbDemapUPtr;
+
+}
+
+#endif //__SIM_PROBE_TLB_HH__
@@ -358,7 +358,7 @@ readfile(ThreadContext *tc, Addr vaddr, uint64_t len, uint64_t offset)
     DPRINTF(PseudoInst, "PseudoInst::readfile(0x%x, 0x%x, 0x%x)\n",
             vaddr, len, offset);
 
-    const std::string &file = tc->getSystemPtr()->params().readfile;
+    const std::string &file = tc->getSystemPtr()->getReadfile();
     if (file.empty()) {
         return ULL(0);
     }
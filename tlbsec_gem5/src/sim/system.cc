@@ -217,6 +217,7 @@ System::System(const Params &p)
       physmem(name() + ".physmem", p.memories, p.mmap_using_noreserve,
               p.shared_backstore),
       memoryMode(p.mem_mode),
+      readfile(p.readfile),
       _cacheLineSize(p.cache_line_size),
       workItemsBegin(0),
       workItemsEnd(0),
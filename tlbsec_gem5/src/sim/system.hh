@@ -296,6 +296,16 @@ class System : public SimObject, public PCEventScope
     void setMemoryMode(Enums::MemoryMode mode);
     /** @} */
 
+    /** @{ */
+    /**
+     * Host file returned by the readfile pseudo instruction. It starts
+     * out as the readfile parameter and can be replaced from Python,
+     * e.g. by a forked simulator that runs a different script.
+     */
+    const std::string &getReadfile() const { return readfile; }
+    void setReadfile(const std::string &file) { readfile = file; }
+    /** @} */
+
     /**
      * Get the cache line size of the system.
      */
@@ -408,6 +418,8 @@ class System : public SimObject, public PCEventScope
 
     Enums::MemoryMode memoryMode;
 
+    std::string readfile;
+
     const unsigned int _cacheLineSize;
 
     uint64_t workItemsBegin;
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/telemetry.hh"
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "params/Telemetry.hh"
+#include "sim/core.hh"
+#include "sim/sim_exit.hh"
+
+namespace
+{
+
+const char magic[8] = {'G', '5', 'T', 'E', 'L', 'E', 'M', '\0'};
+const uint32_t version = 1;
+
+bool
+endsWith(const std::string &s, const std::string &suffix)
+{
+    return s.size() >= suffix.size() &&
+        s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // anonymous namespace
+
+Telemetry::Telemetry(const TelemetryParams &p)
+    : SimObject(p), fileName(p.file), intervalTicks(p.interval),
+      intervalInsts(p.interval_insts), bufferRows(p.buffer_rows),
+      columns{"tick", "insts"}, rows(0), insts(0),
+      nextInstSample(p.interval_insts), started(false),
+      sampleEvent([this]{
+                      sample();
+                      schedule(sampleEvent, curTick() + intervalTicks);
+                  }, name() + ".sample"),
+      stream(nullptr), headerWritten(false)
+#if USE_HDF5
+      , useHdf5(endsWith(p.file, ".h5")), h5Rows(0)
+#endif
+{
+    fatal_if(bufferRows == 0, "%s: buffer_rows must not be 0\n", name());
+    fatal_if(intervalTicks == 0 && intervalInsts == 0,
+             "%s: Either interval or interval_insts must be set\n",
+             name());
+    fatal_if(intervalInsts != 0 && p.cpus.empty(),
+             "%s: interval_insts requires at least one CPU\n", name());
+#if !USE_HDF5
+    fatal_if(endsWith(p.file, ".h5"),
+             "%s: gem5 was built without HDF5 support\n", name());
+#endif
+
+    readers.push_back([] { return curTick(); });
+    readers.push_back([this] { return insts; });
+
+    registerExitCallback([this]() {
+        if (started) {
+            sample();
+            flush();
+        }
+    });
+}
+
+void
+Telemetry::addCounter(const std::string &name, Reader reader)
+{
+    fatal_if(started, "%s: Counter %s registered after startup\n",
+             this->name(), name);
+    columns.push_back(name);
+    readers.push_back(reader);
+}
+
+void
+Telemetry::regProbeListeners()
+{
+    const TelemetryParams &p =
+        dynamic_cast<const TelemetryParams &>(params());
+
+    for (auto *cpu : p.cpus) {
+        // The instruction count is not synchronized between threads
+        fatal_if(intervalInsts != 0 &&
+                 cpu->eventQueue() != p.cpus[0]->eventQueue(),
+                 "%s: interval_insts requires all CPUs to share one event "
+                 "queue\n", name());
+        listeners.emplace_back(new RetiredListener(
+            *this, cpu->getProbeManager(), "RetiredInsts"));
+    }
+}
+
+void
+Telemetry::startup()
+{
+    buffer.resize(bufferRows * columns.size());
+    started = true;
+    if (intervalTicks != 0)
+        schedule(sampleEvent, curTick() + intervalTicks);
+}
+
+void
+Telemetry::notifyFork()
+{
+    // The output directory changes after a fork, the child writes its
+    // own file from the start
+    headerWritten = false;
+#if USE_HDF5
+    if (useHdf5) {
+        h5Table = H5::DataSet();
+        h5File = H5::H5File();
+        h5Rows = 0;
+    }
+#endif
+}
+
+void
+Telemetry::retired(uint64_t n)
+{
+    insts += n;
+    if (intervalInsts != 0 && insts >= nextInstSample) {
+        nextInstSample = insts + intervalInsts;
+        sample();
+    }
+}
+
+void
+Telemetry::sample()
+{
+    // Counters of CPUs in other event queues are read without
+    // synchronization and may lag by up to one quantum
+    uint64_t *row = &buffer[rows * columns.size()];
+    for (size_t i = 0; i < readers.size(); i++)
+        row[i] = readers[i]();
+
+    if (++rows == bufferRows)
+        flush();
+}
+
+void
+Telemetry::writeHeader()
+{
+#if USE_HDF5
+    if (useHdf5) {
+        H5::Exception::dontPrint();
+        h5File = H5::H5File(simout.resolve(fileName), H5F_ACC_TRUNC);
+
+        const hsize_t ncols = columns.size();
+        hsize_t dims[2] = { 0, ncols };
+        hsize_t max_dims[2] = { H5S_UNLIMITED, ncols };
+        hsize_t chunk_dims[2] = { bufferRows, ncols };
+        H5::DSetCreatPropList props;
+        props.setChunk(2, chunk_dims);
+        props.setDeflate(1);
+        H5::DataSpace space(2, dims, max_dims);
+        h5Table = h5File.createDataSet("telemetry",
+                                       H5::PredType::NATIVE_UINT64,
+                                       space, props);
+
+        std::vector<const char *> names;
+        for (const auto &c : columns)
+            names.push_back(c.c_str());
+        H5::StrType str_type(H5::PredType::C_S1, H5T_VARIABLE);
+        hsize_t names_dims[1] = { ncols };
+        H5::DataSpace names_space(1, names_dims);
+        h5Table.createAttribute("columns", str_type, names_space)
+            .write(str_type, names.data());
+
+        const uint64_t freq = SimClock::Frequency;
+        H5::DataSpace freq_space(H5S_SCALAR);
+        h5Table.createAttribute("tick_freq", H5::PredType::NATIVE_UINT64,
+                                freq_space)
+            .write(H5::PredType::NATIVE_UINT64, &freq);
+        h5Rows = 0;
+        headerWritten = true;
+        return;
+    }
+#endif
+
+    if (stream)
+        simout.close(stream);
+    stream = simout.create(fileName, true);
+    std::ostream &os = *stream->stream();
+
+    const uint64_t freq = SimClock::Frequency;
+    const uint32_t ncols = columns.size();
+    os.write(magic, sizeof(magic));
+    os.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    os.write(reinterpret_cast<const char *>(&freq), sizeof(freq));
+    os.write(reinterpret_cast<const char *>(&ncols), sizeof(ncols));
+    for (const auto &c : columns) {
+        const uint32_t len = c.size();
+        os.write(reinterpret_cast<const char *>(&len), sizeof(len));
+        os.write(c.data(), len);
+    }
+    headerWritten = true;
+}
+
+void
+Telemetry::flush()
+{
+    if (!headerWritten)
+        writeHeader();
+    if (rows == 0)
+        return;
+
+#if USE_HDF5
+    if (useHdf5) {
+        hsize_t dims[2] = { h5Rows + rows, columns.size() };
+        h5Table.extend(dims);
+        H5::DataSpace fspace = h5Table.getSpace();
+        hsize_t count[2] = { rows, columns.size() };
+        hsize_t offset[2] = { h5Rows, 0 };
+        fspace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        H5::DataSpace mspace(2, count);
+        h5Table.write(buffer.data(), H5::PredType::NATIVE_UINT64,
+                      mspace, fspace);
+        h5File.flush(H5F_SCOPE_LOCAL);
+        h5Rows += rows;
+        rows = 0;
+        return;
+    }
+#endif
+
+    std::ostream &os = *stream->stream();
+    os.write(reinterpret_cast<const char *>(buffer.data()),
+             rows * columns.size() * sizeof(uint64_t));
+    os.flush();
+    rows = 0;
+}
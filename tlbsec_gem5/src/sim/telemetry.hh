@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 The TLBCoat Authors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIM_TELEMETRY_HH__
+#define __SIM_TELEMETRY_HH__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config/use_hdf5.hh"
+#include "sim/eventq.hh"
+#include "sim/probe/pmu.hh"
+#include "sim/sim_object.hh"
+
+#if USE_HDF5
+#include "H5Cpp.h"
+#endif
+
+class OutputStream;
+struct TelemetryParams;
+
+/**
+ * Time series of a few hot counters.
+ *
+ * Dumping the statistics at short intervals walks and formats the whole
+ * stats tree every time. Instead, objects register a small number of
+ * monotonic counters here, and every interval (in ticks or in
+ * instructions retired by a set of CPUs) one row with their current
+ * values is copied into a ring buffer. Full buffers are appended to a
+ * compact binary file, or to an HDF5 table if the file name ends in .h5.
+ * util/telemetry.py reads both formats.
+ *
+ * Each row holds the tick, the number of instructions retired by the
+ * listed CPUs and then one value per registered counter, all as 64-bit
+ * integers. The binary file starts with the magic "G5TELEM\0", a 32-bit
+ * version, the tick frequency, the number of columns and their names,
+ * each prefixed with its 32-bit length. Rows follow in host byte order.
+ */
+class Telemetry : public SimObject
+{
+  public:
+    typedef std::function<uint64_t()> Reader;
+
+    Telemetry(const TelemetryParams &p);
+
+    /**
+     * Register a counter to be sampled. Must be called before startup(),
+     * e.g. from the constructor of the object owning the counter.
+     */
+    void addCounter(const std::string &name, Reader reader);
+
+    void regProbeListeners() override;
+    void startup() override;
+    void notifyFork() override;
+
+    /** Copy the current value of all counters into the ring buffer. */
+    void sample();
+
+    /** Write all buffered rows to the output file. */
+    void flush();
+
+  protected:
+    void retired(uint64_t insts);
+    void writeHeader();
+
+    const std::string fileName;
+    const Tick intervalTicks;
+    const uint64_t intervalInsts;
+    const size_t bufferRows;
+
+    std::vector<std::string> columns;
+    std::vector<Reader> readers;
+
+    /** Room for bufferRows rows of columns.size() values. */
+    std::vector<uint64_t> buffer;
+    size_t rows;
+
+    uint64_t insts;
+    uint64_t nextInstSample;
+    bool started;
+
+    EventFunctionWrapper sampleEvent;
+
+    OutputStream *stream;
+    bool headerWritten;
+#if USE_HDF5
+    bool useHdf5;
+    H5::H5File h5File;
+    H5::DataSet h5Table;
+    hsize_t h5Rows;
+#endif
+
+    class RetiredListener : public ProbeListenerArgBase<uint64_t>
+    {
+      public:
+        RetiredListener(Telemetry &_parent, ProbeManager *pm,
+                        const std::string &name)
+            : ProbeListenerArgBase(pm, name), parent(_parent) {}
+
+        void notify(const uint64_t &insts) override {
+            parent.retired(insts);
+        }
+
+      protected:
+        Telemetry &parent;
+    };
+
+    std::vector<std::unique_ptr<RetiredListener>> listeners;
+};
+
+#endif // __SIM_TELEMETRY_HH__
@@ -67,6 +67,14 @@ gem5_verify_config(
     valid_isas=(constants.null_tag,),
 )
 
+gem5_verify_config(
+    name='memtest_parallel',
+    verifiers=(), # No need for verfiers this will return non-zero on fail
+    config=joinpath(getcwd(), 'memtest-parallel-run.py'),
+    config_args = [],
+    valid_isas=(constants.null_tag,),
+)
+
 null_tests = [
     ('garnet_synth_traffic', ['--sim-cycles', '5000000']),
     ('memcheck', ['--maxtick', '2000000000', '--prefetchers']),
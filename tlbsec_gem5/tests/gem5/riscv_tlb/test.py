@@ -0,0 +1,56 @@
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+'''
+Tests of the RISC-V TLB and its walker driven by the TLB tester, which
+panics on a wrong translation. tlb_test.py also fails unless every
+translation looked up the TLB exactly once.
+'''
+from testlib import *
+
+config_path = joinpath(config.base_dir, 'configs', 'example', 'riscv',
+                       'tlb_test.py')
+
+# Strided accesses put four translations into a page, which merge into its
+# MSHR, and sixteen of them in flight keep both MSHRs taken. A single
+# lookup port delays the lookups released after a walk.
+tlb_test_params = [
+    ('atomic', ['--atomic']),
+    ('timing', []),
+    ('mshr_merge', ['--mshrs=2', '--pattern=Strided', '--stride=1KiB',
+                    '--outstanding=16']),
+    ('mshr_ports', ['--mshrs=2', '--pattern=Strided', '--stride=1KiB',
+                    '--outstanding=16', '--lookup-ports=1']),
+]
+
+for name, args in tlb_test_params:
+    gem5_verify_config(
+        name='riscv_tlb_' + name,
+        verifiers=(), # No need for verfiers this will return non-zero on fail
+        config=config_path,
+        config_args=['--translations=20000'] + args,
+        valid_isas=(constants.riscv_tag,),
+    )
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# This script is used to dump protobuf TLB translation traces recorded
+# by the TLBTraceProbe to ASCII format. Each line holds
+# tick,tlb_id,mode,vaddr,asid,hit,log_bytes,walk_latency where mode is
+# r, w or x. Demaps are written as tick,tlb_id,d,vaddr,asid with 0 for
+# every address or ASID.
+
+import os
+import protolib
+import subprocess
+import sys
+
+util_dir = os.path.dirname(os.path.realpath(__file__))
+# Make sure the proto definitions are up to date.
+subprocess.check_call(['make', '--quiet', '-C', util_dir, 'tlb_trace_pb2.py'])
+import tlb_trace_pb2
+
+def main():
+    if len(sys.argv) != 3:
+        print("Usage: ", sys.argv[0], " <protobuf input> <ASCII output>")
+        exit(-1)
+
+    # Open the file in read mode
+    proto_in = protolib.openFileRd(sys.argv[1])
+
+    try:
+        ascii_out = open(sys.argv[2], 'w')
+    except IOError:
+        print("Failed to open ", sys.argv[2], " for writing")
+        exit(-1)
+
+    # Read the magic number in 4-byte Little Endian
+    magic_number = proto_in.read(4).decode()
+
+    if magic_number != "gem5":
+        print("Unrecognized file", sys.argv[1])
+        exit(-1)
+
+    print("Parsing trace header")
+
+    header = tlb_trace_pb2.TlbTraceHeader()
+    protolib.decodeMessage(proto_in, header)
+
+    print("Object id:", header.obj_id)
+    print("Tick frequency:", header.tick_freq)
+
+    for id_string in header.id_strings:
+        print('TLB id %d: %s' % (id_string.key, id_string.value))
+
+    print("Parsing translations")
+
+    num_accesses = 0
+    num_misses = 0
+    num_demaps = 0
+    access = tlb_trace_pb2.TlbAccess()
+    modes = ['r', 'w', 'x']
+
+    # Decode the messages until we hit the end of the file
+    while protolib.decodeMessage(proto_in, access):
+        if access.demap:
+            num_demaps += 1
+            ascii_out.write('%s,%s,d,%#x,%s\n' % (
+                access.tick, access.tlb_id, access.vaddr, access.asid))
+            continue
+        num_accesses += 1
+        if not access.hit:
+            num_misses += 1
+        ascii_out.write('%s,%s,%s,%#x,%s,%d,%s,%s\n' % (
+            access.tick, access.tlb_id, modes[access.mode], access.vaddr,
+            access.asid, access.hit, access.log_bytes, access.walk_latency))
+
+    print("Parsed translations:", num_accesses)
+    print("Misses:", num_misses)
+    print("Demaps:", num_demaps)
+
+    # We're done
+    ascii_out.close()
+    proto_in.close()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Compare the host time of RISC-V full-system runs with all cores in one
+# event queue and with one event queue (host thread) per core
+# (fs_linux.py --parallel-cpus) for a list of core counts.
+#
+# Every configuration boots Linux for the same number of simulated
+# ticks. The host time, the simulated instructions and the ratio of the
+# serial to the parallel host time are read from the stats of each run.
+#
+# Example:
+#   util/riscv-parallel-scaling.py build/RISCV/gem5.opt -n 1,2,4,8 -- \
+#       --kernel=bbl --disk-image=riscv_parsec_disk --caches \
+#       --cpu-type=TimingSimpleCPU
+
+import optparse
+import os
+import subprocess
+import sys
+
+parser = optparse.OptionParser(
+    usage="%prog [options] <gem5 binary> [-- <fs_linux.py options>]")
+parser.add_option("-n", "--cpus", type="string", default="1,2,4,8,16",
+                  help="Comma separated core counts (default: %default)")
+parser.add_option("-t", "--ticks", type="int", default=10**10,
+                  help="Simulated ticks per run (default: %default)")
+parser.add_option("-q", "--sim-quantum", type="string", default="1ns",
+                  help="Quantum of the parallel runs, as for fs_linux.py "
+                       "(default: %default)")
+parser.add_option("-o", "--outdir", type="string", default="scaling",
+                  help="Directory for the outputs of all runs "
+                       "(default: %default)")
+
+(options, args) = parser.parse_args()
+
+if len(args) < 1:
+    parser.error("Expecting the gem5 binary")
+
+gem5_binary = args[0]
+fs_args = args[1:]
+config = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      os.pardir, "configs", "example", "riscv",
+                      "fs_linux.py")
+
+def readStats(filename):
+    stats = {}
+    with open(filename) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) >= 2 and fields[0] in \
+                    ("hostSeconds", "simInsts", "simTicks"):
+                # Keep the first dump
+                stats.setdefault(fields[0], float(fields[1]))
+    return stats
+
+def run(num_cpus, parallel):
+    outdir = os.path.join(options.outdir, "%s-n%d" %
+                          ("parallel" if parallel else "serial", num_cpus))
+    cmd = [gem5_binary, "-d", outdir, config, "-n", str(num_cpus),
+           "--rel-max-tick", str(options.ticks)] + fs_args
+    if parallel:
+        cmd += ["--parallel-cpus", "--sim-quantum", options.sim_quantum]
+
+    with open(os.path.join(options.outdir, os.path.basename(outdir) +
+                           ".log"), "w") as log:
+        status = subprocess.call(cmd, stdout=log, stderr=subprocess.STDOUT)
+    if status != 0:
+        print("Error: run in %s failed with status %d" % (outdir, status))
+        sys.exit(1)
+    return readStats(os.path.join(outdir, "stats.txt"))
+
+os.makedirs(options.outdir, exist_ok=True)
+
+print("%5s %12s %12s %12s %12s %8s" % ("cpus", "serial_s", "parallel_s",
+                                      "serial_MIPS", "parallel_MIPS",
+                                      "speedup"))
+for num_cpus in [int(n) for n in options.cpus.split(",")]:
+    serial = run(num_cpus, False)
+    # A single core has nothing to run in parallel
+    parallel = run(num_cpus, True) if num_cpus > 1 else serial
+
+    def mips(stats):
+        return stats["simInsts"] / stats["hostSeconds"] / 1e6
+
+    print("%5d %12.1f %12.1f %12.2f %12.2f %8.2f" %
+          (num_cpus, serial["hostSeconds"], parallel["hostSeconds"],
+           mips(serial), mips(parallel),
+           serial["hostSeconds"] / parallel["hostSeconds"]))
+    sys.stdout.flush()
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 The TLBCoat Authors
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Reader for the time series written by the Telemetry SimObject. Both
+# the binary format and HDF5 tables (.h5, requires h5py) are supported.
+#
+# As a script, it prints one line per sampling interval with the tick,
+# the instructions retired in the interval and the per-interval delta
+# of every counter. For every TLB that registered accesses and misses,
+# the interval miss rate is added. Use --csv for machine readable
+# output.
+
+import argparse
+import array
+import struct
+import sys
+
+MAGIC = b"G5TELEM\0"
+VERSION = 1
+
+class Telemetry(object):
+    """Columns and rows of a telemetry file. Each row is a list of
+    integer values, one per column; rows[i][0] is the tick and
+    rows[i][1] the number of instructions retired so far."""
+
+    def __init__(self, columns, rows, tick_freq):
+        self.columns = columns
+        self.rows = rows
+        self.tick_freq = tick_freq
+
+    def column(self, name):
+        idx = self.columns.index(name)
+        return [row[idx] for row in self.rows]
+
+    def deltas(self):
+        """Per-interval differences of all columns except the tick."""
+        prev = [0] * len(self.columns)
+        out = []
+        for row in self.rows:
+            out.append([row[0]] +
+                       [row[i] - prev[i] for i in range(1, len(row))])
+            prev = row
+        return out
+
+    def tlbs(self):
+        """Names of the objects that registered accesses and misses."""
+        names = []
+        for c in self.columns:
+            if c.endswith(".accesses"):
+                prefix = c[:-len(".accesses")]
+                if prefix + ".misses" in self.columns:
+                    names.append(prefix)
+        return names
+
+def _read_binary(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("%s is not a telemetry file" % path)
+    pos = len(MAGIC)
+    version, tick_freq, ncols = struct.unpack_from("=IQI", data, pos)
+    if version != VERSION:
+        raise ValueError("%s has unsupported version %d" % (path, version))
+    pos += struct.calcsize("=IQI")
+
+    columns = []
+    for _ in range(ncols):
+        (length,) = struct.unpack_from("=I", data, pos)
+        pos += 4
+        columns.append(data[pos:pos + length].decode())
+        pos += length
+
+    values = array.array("Q")
+    row_bytes = ncols * values.itemsize
+    # Drop a partially written row at the end of the file
+    end = pos + (len(data) - pos) // row_bytes * row_bytes
+    values.frombytes(data[pos:end])
+    rows = [values[i:i + ncols].tolist()
+            for i in range(0, len(values), ncols)]
+    return Telemetry(columns, rows, tick_freq)
+
+def _read_hdf5(path):
+    import h5py
+
+    with h5py.File(path, "r") as f:
+        table = f["telemetry"]
+        columns = [c.decode() if isinstance(c, bytes) else c
+                   for c in table.attrs["columns"]]
+        tick_freq = int(table.attrs["tick_freq"])
+        rows = table[()].tolist()
+    return Telemetry(columns, rows, tick_freq)
+
+def read(path):
+    """Read a telemetry file written by gem5."""
+    if path.endswith(".h5"):
+        return _read_hdf5(path)
+    return _read_binary(path)
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Print the per-interval deltas of a telemetry file")
+    parser.add_argument("file", help="telemetry.bin or telemetry.h5")
+    parser.add_argument("--csv", action="store_true",
+                        help="Print comma separated values")
+    parser.add_argument("--columns", default=None,
+                        help="Comma separated list of counters to print "
+                             "(default: all)")
+    args = parser.parse_args()
+
+    tm = read(args.file)
+    counters = tm.columns[1:]
+    if args.columns:
+        counters = ["insts"] + args.columns.split(",")
+        for c in counters:
+            if c not in tm.columns:
+                sys.exit("Unknown column %s" % c)
+    idx = [tm.columns.index(c) for c in counters]
+    tlbs = tm.tlbs()
+    acc = [tm.columns.index(t + ".accesses") for t in tlbs]
+    miss = [tm.columns.index(t + ".misses") for t in tlbs]
+
+    header = ["tick"] + counters + [t + ".missRate" for t in tlbs]
+    sep = "," if args.csv else " "
+    print(sep.join(header))
+    for row in tm.deltas():
+        out = [str(row[0])] + [str(row[i]) for i in idx]
+        for a, m in zip(acc, miss):
+            out.append("%.6f" % (row[m] / row[a]) if row[a] else "nan")
+        print(sep.join(out))
+
+if __name__ == "__main__":
+    main()